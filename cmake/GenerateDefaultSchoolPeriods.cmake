@@ -0,0 +1,261 @@
+# Compiles the bundled SchoolPeriods.json into constexpr C++ tables.
+#
+# Usage: cmake -DINPUT=<SchoolPeriods.json> -DOUTPUT=<header> -P GenerateDefaultSchoolPeriods.cmake
+
+if(NOT INPUT OR NOT OUTPUT)
+    message(FATAL_ERROR "INPUT and OUTPUT must be set")
+endif()
+
+file(READ "${INPUT}" _json)
+file(SHA256 "${INPUT}" _sha256)
+
+# The runtime uses these tables verbatim, so the bundled file must spell out the
+# sections JsonManager would otherwise infer.
+foreach(_key subjects period_times schedule rotation days year_levels template_overrides)
+    string(JSON _type ERROR_VARIABLE _error TYPE "${_json}" ${_key})
+    if(_error)
+        message(FATAL_ERROR "${INPUT}: missing \"${_key}\"")
+    endif()
+endforeach()
+
+function(_c_string out value)
+    string(REPLACE "\\" "\\\\" value "${value}")
+    string(REPLACE "\"" "\\\"" value "${value}")
+    set(${out} "\"${value}\"" PARENT_SCOPE)
+endfunction()
+
+function(_json_get out default)
+    string(JSON _value ERROR_VARIABLE _error GET "${_json}" ${ARGN})
+    if(_error OR _value STREQUAL "")
+        set(_value "${default}")
+    endif()
+    set(${out} "${_value}" PARENT_SCOPE)
+endfunction()
+
+function(_json_keys out)
+    set(_keys)
+    string(JSON _type ERROR_VARIABLE _error TYPE "${_json}" ${ARGN})
+    if(NOT _error AND _type STREQUAL "OBJECT")
+        string(JSON _count LENGTH "${_json}" ${ARGN})
+        if(_count GREATER 0)
+            math(EXPR _last "${_count} - 1")
+            foreach(_i RANGE ${_last})
+                string(JSON _key MEMBER "${_json}" ${ARGN} ${_i})
+                list(APPEND _keys "${_key}")
+            endforeach()
+        endif()
+    endif()
+    set(${out} "${_keys}" PARENT_SCOPE)
+endfunction()
+
+function(_json_array out)
+    set(_items)
+    string(JSON _type ERROR_VARIABLE _error TYPE "${_json}" ${ARGN})
+    if(NOT _error AND _type STREQUAL "ARRAY")
+        string(JSON _count LENGTH "${_json}" ${ARGN})
+        if(_count GREATER 0)
+            math(EXPR _last "${_count} - 1")
+            foreach(_i RANGE ${_last})
+                string(JSON _item GET "${_json}" ${ARGN} ${_i})
+                list(APPEND _items "${_item}")
+            endforeach()
+        endif()
+    endif()
+    set(${out} "${_items}" PARENT_SCOPE)
+endfunction()
+
+function(_minutes out time)
+    if(time MATCHES "^([0-9][0-9]):([0-9][0-9])$")
+        math(EXPR _value "${CMAKE_MATCH_1} * 60 + ${CMAKE_MATCH_2}")
+    else()
+        set(_value 0)
+    endif()
+    set(${out} ${_value} PARENT_SCOPE)
+endfunction()
+
+set(_subjects "")
+_json_keys(_subject_names subjects)
+foreach(_name IN LISTS _subject_names)
+    _json_get(_teacher "" subjects "${_name}" teacher)
+    _json_get(_color "#E0E0E0" subjects "${_name}" color)
+    _c_string(_name_c "${_name}")
+    _c_string(_teacher_c "${_teacher}")
+    _c_string(_color_c "${_color}")
+    string(APPEND _subjects "    {${_name_c}, ${_teacher_c}, ${_color_c}},\n")
+endforeach()
+
+# Periods are emitted already ordered the way parseSchoolPeriods sorts them
+# (start time, then label), so the runtime never has to sort.
+set(_periods "")
+_json_keys(_template_names period_times)
+foreach(_template IN LISTS _template_names)
+    set(_entries)
+    _json_keys(_labels period_times "${_template}")
+    foreach(_label IN LISTS _labels)
+        _json_get(_start "" period_times "${_template}" "${_label}" start_time)
+        _json_get(_end "" period_times "${_template}" "${_label}" end_time)
+        _minutes(_start_minutes "${_start}")
+        _minutes(_end_minutes "${_end}")
+        string(LENGTH "0000${_start_minutes}" _padded_length)
+        math(EXPR _pad_begin "${_padded_length} - 4")
+        string(SUBSTRING "0000${_start_minutes}" ${_pad_begin} 4 _sort_key)
+        list(APPEND _entries "${_sort_key}|${_label}|${_start_minutes}|${_end_minutes}")
+    endforeach()
+    list(SORT _entries)
+    _c_string(_template_c "${_template}")
+    foreach(_entry IN LISTS _entries)
+        string(REPLACE "|" ";" _fields "${_entry}")
+        list(GET _fields 1 _label)
+        list(GET _fields 2 _start_minutes)
+        list(GET _fields 3 _end_minutes)
+        _c_string(_label_c "${_label}")
+        string(APPEND _periods "    {${_template_c}, ${_label_c}, ${_start_minutes}, ${_end_minutes}},\n")
+    endforeach()
+endforeach()
+
+set(_days "")
+set(_slots "")
+_json_keys(_week_names schedule)
+foreach(_week IN LISTS _week_names)
+    string(TOUPPER "${_week}" _week_upper)
+    _c_string(_week_c "${_week_upper}")
+    _json_keys(_day_names schedule "${_week}")
+    foreach(_day IN LISTS _day_names)
+        _c_string(_day_c "${_day}")
+        _json_get(_template "" schedule "${_week}" "${_day}" period_template)
+        _c_string(_template_c "${_template}")
+        string(APPEND _days "    {${_week_c}, ${_day_c}, ${_template_c}},\n")
+
+        _json_keys(_period_keys schedule "${_week}" "${_day}" subjects)
+        foreach(_key IN LISTS _period_keys)
+            _json_get(_subject "" schedule "${_week}" "${_day}" subjects "${_key}" subject)
+            _json_get(_room "" schedule "${_week}" "${_day}" subjects "${_key}" room)
+            _c_string(_key_c "${_key}")
+            _c_string(_subject_c "${_subject}")
+            _c_string(_room_c "${_room}")
+            string(APPEND _slots "    {${_week_c}, ${_day_c}, ${_key_c}, ${_subject_c}, ${_room_c}},\n")
+        endforeach()
+    endforeach()
+endforeach()
+
+set(_rotation "")
+_json_array(_rotation_items rotation)
+foreach(_item IN LISTS _rotation_items)
+    string(TOUPPER "${_item}" _item)
+    _c_string(_item_c "${_item}")
+    string(APPEND _rotation "    ${_item_c},\n")
+endforeach()
+
+set(_day_list "")
+_json_array(_day_items days)
+foreach(_item IN LISTS _day_items)
+    _c_string(_item_c "${_item}")
+    string(APPEND _day_list "    ${_item_c},\n")
+endforeach()
+
+set(_year_levels "")
+_json_array(_year_items year_levels)
+foreach(_item IN LISTS _year_items)
+    string(APPEND _year_levels "    ${_item},\n")
+endforeach()
+
+set(_overrides "")
+_json_keys(_override_templates template_overrides)
+foreach(_template IN LISTS _override_templates)
+    _c_string(_template_c "${_template}")
+    _json_keys(_override_years template_overrides "${_template}")
+    foreach(_year IN LISTS _override_years)
+        _json_get(_replacement "" template_overrides "${_template}" "${_year}")
+        _c_string(_replacement_c "${_replacement}")
+        string(APPEND _overrides "    {${_template_c}, ${_year}, ${_replacement_c}},\n")
+    endforeach()
+endforeach()
+
+set(_content "// Generated from SchoolPeriods.json by GenerateDefaultSchoolPeriods.cmake. Do not edit.
+#pragma once
+
+namespace DefaultSchoolPeriodsTables
+{
+struct Subject
+{
+    const char *name;
+    const char *teacher;
+    const char *color;
+};
+
+struct Period
+{
+    const char *templateName;
+    const char *label;
+    int startMinute;
+    int endMinute;
+};
+
+struct Day
+{
+    const char *week;
+    const char *day;
+    const char *templateName;
+};
+
+struct Slot
+{
+    const char *week;
+    const char *day;
+    const char *periodKey;
+    const char *subject;
+    const char *room;
+};
+
+struct TemplateOverride
+{
+    const char *templateName;
+    int yearLevel;
+    const char *replacement;
+};
+
+// Every table is terminated by a null/zero sentinel so empty sections still compile.
+constexpr char kSha256[] = \"${_sha256}\";
+
+constexpr Subject kSubjects[] = {
+${_subjects}    {nullptr, nullptr, nullptr},
+};
+
+constexpr Period kPeriods[] = {
+${_periods}    {nullptr, nullptr, 0, 0},
+};
+
+constexpr Day kDays[] = {
+${_days}    {nullptr, nullptr, nullptr},
+};
+
+constexpr Slot kSlots[] = {
+${_slots}    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+constexpr const char *kRotation[] = {
+${_rotation}    nullptr,
+};
+
+constexpr const char *kDayNames[] = {
+${_day_list}    nullptr,
+};
+
+constexpr int kYearLevels[] = {
+${_year_levels}    0,
+};
+
+constexpr TemplateOverride kTemplateOverrides[] = {
+${_overrides}    {nullptr, 0, nullptr},
+};
+}
+")
+
+# Only touch the output when it changes so dependants are not rebuilt needlessly.
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" _existing)
+    if(_existing STREQUAL _content)
+        return()
+    endif()
+endif()
+file(WRITE "${OUTPUT}" "${_content}")
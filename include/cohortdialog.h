@@ -0,0 +1,39 @@
+#pragma once
+
+#include "jsonmanager.h"
+#include "models.h"
+
+#include <QDateEdit>
+#include <QDialog>
+#include <QLabel>
+#include <QListWidget>
+#include <QSet>
+#include <QSpinBox>
+#include <QTimeEdit>
+#include <QVector>
+
+// Read-only view over many students' data directories: loads their profiles and
+// lists the meeting times with the fewest conflicts in a chosen week.
+class CohortDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit CohortDialog(const JsonManager *manager, QWidget *parent = nullptr);
+
+private:
+    void addFolder(const QString &path);
+    void clearProfiles();
+    void updateProfileLabel();
+    void findTimes();
+
+    const JsonManager *mManager = nullptr;
+    QVector<ProfileData> mProfiles;
+    QSet<QString> mProfileDirectories; // canonical paths of the loaded profiles
+    QLabel *mProfileLabel = nullptr;
+    QListWidget *mProfileList = nullptr;
+    QDateEdit *mWeekEdit = nullptr;
+    QSpinBox *mLengthEdit = nullptr;
+    QTimeEdit *mFromEdit = nullptr;
+    QTimeEdit *mToEdit = nullptr;
+    QListWidget *mResults = nullptr;
+};
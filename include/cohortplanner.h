@@ -0,0 +1,45 @@
+#pragma once
+
+#include "freetimemap.h"
+#include "jsonmanager.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QStringList>
+#include <QVector>
+
+// Finds meeting times across many profiles. Each profile is rasterised once
+// into a FreeTimeMap over the searched days, with hours outside the meeting
+// window marked busy. For a meeting length L every busy bitmap is dilated with
+// shift-or passes, so bit i means "busy somewhere in [i, i + L)", and the
+// dilated words are summed into bit-sliced counters: plane k holds bit k of the
+// per-slot count of conflicting profiles. One pass per profile therefore
+// counts conflicts for every start slot 64 slots at a time, and common free
+// starts are the slots whose count is zero.
+class CohortPlanner
+{
+public:
+    struct Candidate
+    {
+        QDateTime start;
+        QDateTime end;
+        int conflictCount = 0;
+        QStringList conflicting;
+    };
+
+    CohortPlanner(const QDate &firstDay, int dayCount, int windowStartMinute, int windowEndMinute);
+
+    void setProfiles(const QVector<ProfileData> &profiles);
+    int profileCount() const;
+
+    // Up to limit non-overlapping meeting starts, fewest conflicts first, then earliest.
+    QVector<Candidate> bestTimes(int lengthMinutes, int limit) const;
+
+private:
+    QDate mFirstDay;
+    int mDayCount = 0;
+    int mWindowStartMinute = 0;
+    int mWindowEndMinute = 0;
+    QStringList mNames;
+    QVector<FreeTimeMap> mMaps;
+};
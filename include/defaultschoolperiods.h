@@ -0,0 +1,11 @@
+#pragma once
+
+#include "models.h"
+
+#include <QByteArray>
+
+// The bundled SchoolPeriods.json, compiled into static tables at build time.
+// JsonManager uses these instead of parsing when the on-disk file hashes to
+// defaultSchoolPeriodsHash().
+QByteArray defaultSchoolPeriodsHash(); // hex SHA-256 of the bundled file
+SchoolPeriodsData defaultSchoolPeriods();
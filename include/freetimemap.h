@@ -0,0 +1,65 @@
+#pragma once
+
+#include "models.h"
+#include "scheduleindex.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QVector>
+
+#include <array>
+
+// Busy/free raster over a run of days at five-minute resolution: 288 slots per
+// day packed into five 64-bit words, one set bit per busy slot. Timetable
+// periods and activities are rasterised once; free-run queries then work a
+// word at a time (shift-and to find runs of a given length, count-trailing-
+// zeros to jump between run boundaries). Slots are numbered from the first day
+// as day * kSlotsPerDay + slot of day. Runs never cross midnight.
+class FreeTimeMap
+{
+public:
+    static constexpr int kSlotMinutes = 5;
+    static constexpr int kSlotsPerDay = 24 * 60 / kSlotMinutes;
+    static constexpr int kWordsPerDay = (kSlotsPerDay + 63) / 64;
+
+    using DayWords = std::array<quint64, kWordsPerDay>;
+
+    struct Run
+    {
+        int firstSlot = 0;
+        int slotCount = 0;
+    };
+
+    FreeTimeMap() = default;
+    FreeTimeMap(const QDate &firstDay, int dayCount);
+
+    const QDate &firstDay() const;
+    int dayCount() const;
+    int slotCount() const;
+
+    void markBusy(int day, int startMinute, int endMinute);
+    void markBusy(const QDateTime &start, const QDateTime &end);
+    void markOutsideHours(int dayStartMinute, int dayEndMinute);
+    void markSchedule(const ScheduleIndex &schedule, const SettingsData &settings);
+    void markActivities(const QVector<Activity> &activities);
+
+    bool isBusy(int slot) const;
+    const DayWords &day(int day) const;
+    int freeSlotCount(int fromSlot, int toSlot) const;
+
+    // Start of the first free run of at least length slots within [fromSlot, toSlot), or -1.
+    int findFree(int length, int fromSlot, int toSlot) const;
+    // Maximal free runs of at least minLength slots within [fromSlot, toSlot), earliest first.
+    QVector<Run> freeRuns(int fromSlot, int toSlot, int minLength) const;
+
+    // Slot containing time, clamped to [0, slotCount()]; roundUp selects the next
+    // boundary for times inside a slot.
+    int slotAt(const QDateTime &time, bool roundUp = false) const;
+    QDateTime timeAt(int slot) const;
+
+private:
+    static DayWords rangeMask(int fromSlot, int toSlot);
+
+    QDate mFirstDay;
+    QVector<DayWords> mDays;
+};
@@ -2,6 +2,10 @@
 
 #include "jsonmanager.h"
 #include "models.h"
+#include "scheduleindex.h"
+#include "searchfield.h"
+#include "urgencyranker.h"
+#include "widgetpool.h"
 
 #include <QColor>
 #include <QComboBox>
@@ -10,8 +14,10 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QMouseEvent>
+#include <QPainterPath>
 #include <QPropertyAnimation>
 #include <QPushButton>
+#include <QSet>
 #include <QStackedWidget>
 #include <QTextEdit>
 #include <QTimeEdit>
@@ -21,6 +27,7 @@
 
 class ActivitiesWidget;
 class DonutChartWidget;
+class FocusPanel;
 
 class HomePage : public QWidget
 {
@@ -29,22 +36,33 @@ public:
     explicit HomePage(QWidget *parent = nullptr);
 
     void setJsonManager(JsonManager *manager);
+    void setSearch(const SearchIndex *index, TaskScheduler *scheduler);
     void setActivities(const QVector<Activity> &activities);
-    void setSchoolPeriods(const SchoolPeriodsData &data);
+    void refreshSearch();
+    // Schedule and settings are only stored; refreshPeriods() recomputes the
+    // timetable arcs from them.
+    void setSchedule(const ScheduleIndex &schedule);
     void setSettings(const SettingsData &settings);
+    void refreshPeriods();
+    // Most urgent open tasks, best first, as ranked by UrgencyRanker.
+    void setFocusTasks(const QVector<UrgencyRanker::Entry> &entries);
 
 signals:
     void activitiesChanged(const QVector<Activity> &activities);
+    void focusTaskRequested(const QString &taskId);
+    // The donut's window has moved past the periods fetched by refreshPeriods().
+    void periodsExpired();
 
 private:
     void createLayout();
-    void refreshDonut();
 
     JsonManager *mJsonManager = nullptr;
+    SearchField *mSearchField = nullptr;
+    FocusPanel *mFocusPanel = nullptr;
     ActivitiesWidget *mActivitiesWidget = nullptr;
     DonutChartWidget *mDonutChart = nullptr;
     QVector<Activity> mActivities;
-    SchoolPeriodsData mSchoolPeriods;
+    ScheduleIndex mSchedule;
     SettingsData mSettings;
 };
 
@@ -82,6 +100,48 @@ private:
     QPropertyAnimation *mDetailAnimation = nullptr;
 };
 
+class FocusRowWidget : public QFrame
+{
+    Q_OBJECT
+public:
+    explicit FocusRowWidget(QWidget *parent = nullptr);
+
+    void setEntry(const UrgencyRanker::Entry &entry);
+    // Re-formats the "Due"/"Overdue" line against the current time.
+    void refreshDetail();
+
+signals:
+    void clicked(const QString &taskId);
+
+protected:
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    UrgencyRanker::Entry mEntry;
+    QLabel *mTitleLabel = nullptr;
+    QLabel *mDetailLabel = nullptr;
+};
+
+// Fixed set of rows for the top-ranked tasks; rows are rebound, never recreated.
+class FocusPanel : public QFrame
+{
+    Q_OBJECT
+public:
+    static constexpr int kRowCount = 5;
+
+    explicit FocusPanel(QWidget *parent = nullptr);
+
+    void setEntries(const QVector<UrgencyRanker::Entry> &entries);
+
+signals:
+    void taskRequested(const QString &taskId);
+
+private:
+    QVector<FocusRowWidget *> mRows;
+    QLabel *mEmptyLabel = nullptr;
+    QTimer *mMinuteTimer = nullptr;
+};
+
 class ActivitiesWidget : public QFrame
 {
     Q_OBJECT
@@ -89,6 +149,9 @@ public:
     explicit ActivitiesWidget(QWidget *parent = nullptr);
 
     void setActivities(const QVector<Activity> &activities);
+    // Shows only the given activities until clearFilter() is called.
+    void setFilter(const QSet<QString> &activityIds);
+    void clearFilter();
 
 signals:
     void activityCreated(const Activity &activity);
@@ -103,6 +166,8 @@ private:
     void updateColorButton();
 
     QVector<Activity> mActivities;
+    QSet<QString> mFilter;
+    bool mFiltered = false;
     QStackedWidget *mStack = nullptr;
     QWidget *mListPage = nullptr;
     QWidget *mCreationPage = nullptr;
@@ -115,6 +180,8 @@ private:
     QTimeEdit *mEndTimeEdit = nullptr;
     QPushButton *mColorButton = nullptr;
     QColor mSelectedColor = QColor("#4ECDC4");
+    QLabel *mEmptyLabel = nullptr;
+    WidgetPool<ActivityRowWidget> mRowPool;
 };
 
 class DonutChartWidget : public QWidget
@@ -128,29 +195,52 @@ public:
         Combined
     };
 
+    // Selectable spans of the dial, starting now.
+    static constexpr int kWindowMinutes[] = {6 * 60, 12 * 60, 24 * 60, 7 * 24 * 60};
+
     explicit DonutChartWidget(QWidget *parent = nullptr);
 
     void setActivities(const QVector<Activity> &activities);
-    void setPeriods(const QVector<TimetablePeriod> &periods);
+    // Periods covering [now, until); periodsExpired() is emitted once the window
+    // reaches until, and not again before the next setPeriods().
+    void setPeriods(const QVector<TimetablePeriod> &periods, const QDateTime &until);
     void setMode(Mode mode);
+    void setWindowMinutes(int minutes);
+    int windowMinutes() const;
+
+signals:
+    void periodsExpired();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
 
 private:
+    // All arcs of one color as a single path, stroked once.
+    struct ArcBatch
+    {
+        QColor color;
+        QPainterPath path;
+    };
+
     void updateClock();
-    void rebuildArcs();
+    void rebuildActivityArcs();
+    void rebuildPeriodArcs();
     void drawBaseDonut(QPainter &painter, const QRectF &outerRect, const QRectF &innerRect) const;
     void drawArcs(QPainter &painter, const QRectF &outerRect, const QRectF &innerRect);
     void drawHand(QPainter &painter, const QRectF &outerRect, const QRectF &innerRect) const;
     void drawLabels(QPainter &painter, const QRectF &outerRect) const;
+    QVector<ArcBatch> batchArcs(const QVector<DonutArc> &arcs, const QRectF &arcRect) const;
     double minutesToAngle(double minutes) const;
 
-    QVector<Activity> mActivities;
+    QVector<Activity> mActivities; // sorted by start
+    QVector<qint64> mActivityMaxEnd; // latest end among mActivities[0..i], msecs since epoch
     QVector<TimetablePeriod> mPeriods;
+    QDateTime mPeriodsUntil;
+    bool mPeriodsExpired = false;
     QVector<DonutArc> mActivityArcs;
     QVector<DonutArc> mPeriodArcs;
     Mode mMode = Mode::Activities;
+    int mWindowMinutes = 12 * 60;
     QTimer *mTimer = nullptr;
     QDateTime mNow;
 };
@@ -1,8 +1,20 @@
 #pragma once
 
 #include "models.h"
+#include "scheduleindex.h"
 
 #include <QObject>
+#include <QStringList>
+
+// Timetable, settings and activities of another data directory, loaded read-only.
+struct ProfileData
+{
+    QString name;
+    QString directory;
+    SettingsData settings;
+    ScheduleIndex schedule;
+    QVector<Activity> activities;
+};
 
 class JsonManager : public QObject
 {
@@ -22,10 +34,18 @@ public:
     void saveSettings(const SettingsData &settings) const;
 
     SchoolPeriodsData loadSchoolPeriods() const;
+    ScheduleIndex loadScheduleIndex() const;
 
     QVector<TimetablePeriod> upcomingPeriods(const SettingsData &settings, const QDateTime &from, const QDateTime &to) const;
 
     QString dataDirectory() const;
+    // True when the directory holds this app's settings or school periods file.
+    static bool isDataDirectory(const QString &directory);
+
+    // Loads other data directories without creating, writing or caching anything
+    // in them. Profiles sharing an identical SchoolPeriods.json share one compiled
+    // ScheduleIndex.
+    QVector<ProfileData> loadProfiles(const QStringList &directories) const;
 
 signals:
     void dataDirectoryChanged(const QString &path);
@@ -35,9 +55,14 @@ private:
     QString ensureFile(const QString &fileName, const QString &defaultResource) const;
     Activity activityFromJson(const QJsonObject &obj) const;
     QJsonObject activityToJson(const Activity &activity) const;
+    QVector<Activity> parseActivities(const QByteArray &contents) const;
+    SettingsData parseSettings(const QByteArray &contents) const;
     Subtask subtaskFromJson(const QJsonObject &obj) const;
     QJsonObject subtaskToJson(const Subtask &subtask) const;
     Task taskFromJson(const QJsonObject &obj) const;
     QJsonObject taskToJson(const Task &task) const;
     SchoolPeriodsData parseSchoolPeriods(const QJsonDocument &doc) const;
+    SchoolPeriodsData schoolPeriodsFrom(const QByteArray &contents, const QByteArray &sourceHash) const;
+    bool readScheduleCache(const QByteArray &sourceHash, ScheduleIndex &index) const;
+    void writeScheduleCache(const QByteArray &sourceHash, const ScheduleIndex &index) const;
 };
@@ -2,13 +2,22 @@
 
 #include "homepage.h"
 #include "jsonmanager.h"
+#include "refreshgraph.h"
+#include "reminderengine.h"
+#include "searchindex.h"
 #include "settingspage.h"
 #include "sidebar.h"
+#include "statestore.h"
+#include "studyplanner.h"
+#include "taskscheduler.h"
 #include "taskspage.h"
+#include "timelinepage.h"
 #include "timetablepage.h"
+#include "urgencyranker.h"
 
 #include <QMainWindow>
 #include <QStackedWidget>
+#include <QSystemTrayIcon>
 
 class MainWindow : public QMainWindow
 {
@@ -17,20 +26,39 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
 
 protected:
-    bool eventFilter(QObject *watched, QEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private:
     void createLayout();
+    void createRefreshGraph();
     void connectSignals();
-    void updateSidebarWidth();
+    void applySettings(const SettingsData &settings);
+    void updateSidebarGeometry();
     void navigateTo(int index);
+    void syncSearchIndex();
+    void commitActivities(const QVector<Activity> &activities);
+    void planStudyTime(const Task &task, int minutes);
+    void showReminders(const QVector<ReminderEngine::Reminder> &reminders);
 
     JsonManager mJsonManager;
+    StateStore mStateStore;
+    // Declared before the scheduler so it outlives any queued sync job.
+    SearchIndex mSearchIndex;
+    TaskScheduler mScheduler;
+    ReminderEngine mReminders;
+    UrgencyRanker mUrgency;
+    QSystemTrayIcon *mTrayIcon = nullptr;
     Sidebar *mSidebar = nullptr;
+    SidebarHotZone *mHotZone = nullptr;
     QStackedWidget *mStack = nullptr;
     HomePage *mHomePage = nullptr;
     TimetablePage *mTimetablePage = nullptr;
+    TimelinePage *mTimelinePage = nullptr;
     TasksPage *mTasksPage = nullptr;
     SettingsPage *mSettingsPage = nullptr;
+
+    RefreshGraph *mRefreshGraph = nullptr;
+    int mScheduleSource = -1;
+    int mSettingsSource = -1;
+    int mClockSource = -1; // the home dial has run past its fetched periods
 };
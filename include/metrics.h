@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// Process-wide, thread-safe registry of named counters, gauges and timings.
+// Counters accumulate, gauges remember their current and peak values, and
+// timings keep count/total/max in microseconds. report() renders everything
+// as one line per metric.
+class Metrics
+{
+public:
+    static Metrics &instance();
+
+    void increment(const QString &name, qint64 delta = 1);
+    void setGauge(const QString &name, qint64 value);
+    void recordDuration(const QString &name, qint64 micros);
+
+    qint64 counter(const QString &name) const;
+    qint64 gauge(const QString &name) const;
+    qint64 gaugePeak(const QString &name) const;
+
+    QStringList report() const;
+
+private:
+    struct Gauge
+    {
+        qint64 value = 0;
+        qint64 peak = 0;
+    };
+
+    struct Timing
+    {
+        qint64 count = 0;
+        qint64 totalMicros = 0;
+        qint64 maxMicros = 0;
+    };
+
+    Metrics() = default;
+
+    mutable QMutex mMutex;
+    QMap<QString, qint64> mCounters;
+    QMap<QString, Gauge> mGauges;
+    QMap<QString, Timing> mTimings;
+};
@@ -3,39 +3,113 @@
 #include <QColor>
 #include <QDateTime>
 #include <QMap>
+#include <QSharedDataPointer>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
-struct Activity
+class ActivityData;
+class SubtaskData;
+class TaskData;
+
+// Task, Subtask and Activity are implicitly shared: copies (views, signal
+// arguments, lambda captures) share one payload until a setter detaches it.
+// id() is the entity's stable identity; isSharedWith() tells whether two
+// handles still point at the same payload.
+class Activity
 {
-    QString id;
-    QString title;
-    QString description;
-    QDateTime startTime;
-    QDateTime endTime;
-    QColor color;
+public:
+    Activity();
+    Activity(const Activity &other);
+    Activity(Activity &&other) noexcept;
+    Activity &operator=(const Activity &other);
+    Activity &operator=(Activity &&other) noexcept;
+    ~Activity();
+
+    const QString &id() const;
+    void setId(const QString &id);
+    const QString &title() const;
+    void setTitle(const QString &title);
+    const QString &description() const;
+    void setDescription(const QString &description);
+    const QDateTime &startTime() const;
+    void setStartTime(const QDateTime &startTime);
+    const QDateTime &endTime() const;
+    void setEndTime(const QDateTime &endTime);
+    const QColor &color() const;
+    void setColor(const QColor &color);
+
+    bool isSharedWith(const Activity &other) const;
+    void swap(Activity &other) noexcept { d.swap(other.d); }
+
+private:
+    QSharedDataPointer<ActivityData> d;
 };
 
-struct Subtask
+class Subtask
 {
-    QString id;
-    QString title;
-    QString description;
-    QDateTime dueTime;
-    double weighting = 1.0;
-    bool completed = false;
+public:
+    Subtask();
+    Subtask(const Subtask &other);
+    Subtask(Subtask &&other) noexcept;
+    Subtask &operator=(const Subtask &other);
+    Subtask &operator=(Subtask &&other) noexcept;
+    ~Subtask();
+
+    const QString &id() const;
+    void setId(const QString &id);
+    const QString &title() const;
+    void setTitle(const QString &title);
+    const QString &description() const;
+    void setDescription(const QString &description);
+    const QDateTime &dueTime() const;
+    void setDueTime(const QDateTime &dueTime);
+    double weighting() const;
+    void setWeighting(double weighting);
+    bool isCompleted() const;
+    void setCompleted(bool completed);
+
+    bool isSharedWith(const Subtask &other) const;
+    void swap(Subtask &other) noexcept { d.swap(other.d); }
+
+private:
+    QSharedDataPointer<SubtaskData> d;
 };
 
-struct Task
+class Task
 {
-    QString id;
-    QString title;
-    QString description;
-    QDateTime startTime;
-    QDateTime endTime;
-    QVector<Subtask> subtasks;
+public:
+    Task();
+    Task(const Task &other);
+    Task(Task &&other) noexcept;
+    Task &operator=(const Task &other);
+    Task &operator=(Task &&other) noexcept;
+    ~Task();
+
+    const QString &id() const;
+    void setId(const QString &id);
+    const QString &title() const;
+    void setTitle(const QString &title);
+    const QString &description() const;
+    void setDescription(const QString &description);
+    const QDateTime &startTime() const;
+    void setStartTime(const QDateTime &startTime);
+    const QDateTime &endTime() const;
+    void setEndTime(const QDateTime &endTime);
+    const QVector<Subtask> &subtasks() const;
+    void setSubtasks(const QVector<Subtask> &subtasks);
+
+    bool isSharedWith(const Task &other) const;
+    void swap(Task &other) noexcept { d.swap(other.d); }
+
+private:
+    QSharedDataPointer<TaskData> d;
 };
 
+Q_DECLARE_SHARED(Activity)
+Q_DECLARE_SHARED(Subtask)
+Q_DECLARE_SHARED(Task)
+
 struct SettingsData
 {
     QString currentWeek = "A";
@@ -91,14 +165,18 @@ struct DaySchedule
 struct WeekSchedule
 {
     QString name;
-    QMap<QString, DaySchedule> days; // Monday-Friday
+    QMap<QString, DaySchedule> days; // keyed by English weekday name
 };
 
 struct SchoolPeriodsData
 {
     QMap<QString, SubjectDefinition> subjects;
     QMap<QString, TimetableTemplate> templates;
-    QMap<QString, WeekSchedule> weeks; // A/B
+    QMap<QString, WeekSchedule> weeks;
+    QStringList rotation;                                 // week keys in rotation order
+    QVector<int> days;                                    // Qt day-of-week numbers shown in the timetable
+    QVector<int> yearLevels;                              // ascending
+    QMap<QString, QMap<int, QString>> templateOverrides;  // template -> year level -> template
 };
 
 struct DonutArc
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QStackedWidget>
+#include <QVector>
+
+#include <functional>
+
+// Small dependency graph between data sources and the views derived from them.
+// Invalidating a node marks every transitive dependent dirty; dirty views are
+// refreshed at most once per event-loop turn, and views that live on a page not
+// currently shown in the stack stay dirty until that page becomes current.
+class RefreshGraph : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RefreshGraph(QStackedWidget *stack, QObject *parent = nullptr);
+
+    int addSource();
+    // A null page means the view is always considered visible.
+    int addView(QWidget *page, std::function<void()> refresh);
+    void addDependency(int node, int dependsOn);
+
+    void invalidate(int node);
+    bool isDirty(int node) const;
+    void flush();
+
+private:
+    struct Node
+    {
+        QPointer<QWidget> page;
+        std::function<void()> refresh;
+        QVector<int> dependents;
+        bool dirty = false;
+    };
+
+    void scheduleFlush();
+    bool isShown(const Node &node) const;
+
+    QStackedWidget *mStack = nullptr;
+    QVector<Node> mNodes;
+    bool mFlushScheduled = false;
+};
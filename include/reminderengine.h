@@ -0,0 +1,87 @@
+#pragma once
+
+#include "models.h"
+#include "statestore.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <vector>
+
+// Reminders for subtask due times, task end times and activity start times.
+// Upcoming deadlines sit in a min-heap ordered by fire time and a single QTimer
+// is armed for the earliest one, so idle cost does not grow with the number of
+// deadlines. Edits replace entries lazily: the live table holds the current
+// generation of each reminder and stale heap entries are skipped when popped.
+//
+// Deadlines are wall-clock instants while QTimer measures monotonic time, so the
+// timer is never armed for longer than kMaxArmMs; after sleep or a clock change
+// the heap is re-checked against the wall clock within that bound.
+class ReminderEngine : public QObject
+{
+    Q_OBJECT
+public:
+    enum Kind
+    {
+        SubtaskDue,
+        TaskEnd,
+        ActivityStart
+    };
+
+    struct Reminder
+    {
+        Kind kind = SubtaskDue;
+        QString id;
+        QString title;
+        QDateTime due;
+    };
+
+    explicit ReminderEngine(QObject *parent = nullptr);
+
+    // Applies a snapshot incrementally; only entities whose payload changed are rescheduled.
+    void sync(const AppSnapshot &snapshot);
+    int pendingCount() const;
+
+signals:
+    // Everything that became due since the last wake-up, in deadline order.
+    void remindersDue(const QVector<ReminderEngine::Reminder> &reminders);
+
+private:
+    struct Entry
+    {
+        qint64 fireMsecs = 0;
+        quint64 generation = 0;
+        QString key;
+    };
+
+    struct Live
+    {
+        Reminder reminder;
+        qint64 fireMsecs = 0;
+        quint64 generation = 0;
+    };
+
+    void syncTasks(const QVector<Task> &tasks);
+    void syncActivities(const QVector<Activity> &activities);
+    void scheduleTask(const Task &task);
+    void schedule(const QString &key, const Reminder &reminder);
+    void unschedule(const QString &key);
+    void fireDue();
+    void arm();
+    void compact();
+
+    std::vector<Entry> mHeap;
+    QHash<QString, Live> mLive;
+    QHash<QString, qint64> mFired; // key -> due instant already announced
+    QHash<QString, QStringList> mTaskKeys;
+    // The last synced snapshot order, diffed against the next one.
+    QVector<Task> mTasks;
+    QVector<Activity> mActivities;
+    quint64 mGeneration = 0;
+    quint64 mVersion = 0;
+    QTimer mTimer;
+};
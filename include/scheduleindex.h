@@ -0,0 +1,124 @@
+#pragma once
+
+#include "models.h"
+
+#include <QDataStream>
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+struct ScheduledPeriod
+{
+    QString label;
+    qint16 startMinute = 0;
+    qint16 endMinute = 0;
+    qint32 subject = -1; // index into ScheduleIndex::subject(), -1 for breaks/specials
+    qint32 room = -1;    // index into ScheduleIndex::room()
+};
+
+// SchoolPeriodsData compiled into dense lookup tables. Every (rotation week, weekday,
+// year level) triple maps straight to a contiguous, start-sorted range of periods, so
+// resolving a day never touches template names or string maps.
+class ScheduleIndex
+{
+public:
+    struct DayRange
+    {
+        qint32 first = 0;
+        qint32 count = 0;
+    };
+
+    // Keys of the reverse indexes. Teachers come from the subject definitions.
+    enum class Facet
+    {
+        Subject,
+        Room,
+        Teacher
+    };
+
+    // Bumped whenever the streamed layout below changes.
+    static constexpr quint32 kStreamVersion = 1;
+
+    static ScheduleIndex compile(const SchoolPeriodsData &data);
+    static QString dayName(int dayOfWeek);
+    static int dayOfWeek(const QString &dayName);
+
+    bool isEmpty() const;
+
+    int weekCount() const;
+    const QStringList &weekNames() const;
+    int weekIndex(const QString &weekName) const;
+    int rotationWeekFor(const QDate &date, const QString &currentWeek, const QDate &today = QDate::currentDate()) const;
+
+    const QVector<int> &days() const;
+    const QVector<int> &yearLevels() const;
+    int yearIndex(int yearLevel) const;
+
+    int subjectCount() const;
+    const SubjectDefinition &subject(int index) const;
+    int roomCount() const;
+    const QString &room(int index) const;
+
+    DayRange dayRange(int week, int dayOfWeek, int yearIndex) const;
+    const ScheduledPeriod &period(int index) const;
+    TimetablePeriod toTimetablePeriod(const ScheduledPeriod &period, const QDate &date) const;
+
+    QVector<TimetablePeriod> periodsOn(const QDate &date, int week, int yearIndex) const;
+    QVector<TimetablePeriod> periodsBetween(const QDateTime &from, const QDateTime &to, const SettingsData &settings) const;
+
+    // Reverse indexes: for every year level and facet value, the periods of one
+    // rotation cycle sorted by their minute within the cycle.
+    int facetCount(Facet facet) const;
+    QString facetName(Facet facet, int id) const;
+    int facetIndex(Facet facet, const QString &name) const;
+    // Period indices for the facet value on one rotation day, in start order.
+    QVector<int> occurrencesOn(Facet facet, int id, int week, int dayOfWeek, int yearIndex) const;
+    // First period for the facet value starting at or after from, wrapping into the
+    // following cycles; the result has an invalid startTime when there is none.
+    TimetablePeriod nextOccurrence(Facet facet, int id, const QDateTime &from, const SettingsData &settings) const;
+    // Scheduled minutes of a subject over one full rotation cycle.
+    int cycleMinutes(int subject, int yearIndex) const;
+
+    friend QDataStream &operator<<(QDataStream &out, const ScheduleIndex &index);
+    friend QDataStream &operator>>(QDataStream &in, ScheduleIndex &index);
+
+private:
+    struct Posting
+    {
+        qint32 cycleMinute = 0;
+        qint32 period = 0;
+    };
+
+    // Postings bucketed per (year level, facet value); offsets has one extra end entry.
+    // ids maps a lower-cased facet name to its first id.
+    struct ReverseIndex
+    {
+        QVector<qint32> offsets;
+        QVector<Posting> postings;
+        QHash<QString, qint32> ids;
+    };
+
+    int cell(int week, int dayOfWeek, int yearIndex) const;
+    bool isConsistent() const;
+    void buildReverseIndexes();
+    const ReverseIndex &reverseIndex(Facet facet) const;
+    int facetOf(Facet facet, const ScheduledPeriod &period) const;
+
+    QStringList mWeekNames;
+    QVector<int> mDays;
+    QVector<int> mYearLevels;
+    QVector<SubjectDefinition> mSubjects;
+    QStringList mRooms;
+    QVector<ScheduledPeriod> mPeriods;
+    QVector<DayRange> mDayTable; // weeks x 7 weekdays x year levels
+
+    // Derived from the tables above; rebuilt after compile and after streaming in.
+    QStringList mTeachers;
+    QVector<qint32> mSubjectTeacher;
+    QVector<qint32> mSubjectMinutes; // year levels x subjects
+    ReverseIndex mBySubject;
+    ReverseIndex mByRoom;
+    ReverseIndex mByTeacher;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "searchindex.h"
+#include "taskscheduler.h"
+
+#include <QLineEdit>
+
+// Search-as-you-type box over a SearchIndex. Every edit cancels the query
+// still in flight and runs the new one on the scheduler's interactive lane;
+// results arrive through resultsReady(), an emptied box emits cleared().
+class SearchField : public QLineEdit
+{
+    Q_OBJECT
+public:
+    explicit SearchField(QWidget *parent = nullptr);
+
+    void setSearch(const SearchIndex *index, TaskScheduler *scheduler, SearchIndex::Kinds kinds, int limit);
+    bool isActive() const;
+    // Re-runs the current query, e.g. after the index was synced.
+    void refresh();
+
+signals:
+    void resultsReady(const QVector<SearchIndex::Hit> &hits);
+    void cleared();
+
+private:
+    void runQuery(const QString &text);
+
+    const SearchIndex *mIndex = nullptr;
+    TaskScheduler *mScheduler = nullptr;
+    SearchIndex::Kinds mKinds;
+    int mLimit = 0;
+    CancellationToken mToken;
+};
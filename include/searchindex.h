@@ -0,0 +1,105 @@
+#pragma once
+
+#include "models.h"
+#include "statestore.h"
+#include "taskscheduler.h"
+
+#include <QFlags>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+#include <vector>
+
+// Inverted index over task, subtask and activity titles and descriptions.
+// Terms are lower-cased word tokens; a query matches a document when every
+// query token matches one of its terms exactly, as a prefix, or within one
+// edit (tokens of three characters or more). Fuzzy candidates come from a
+// table of single-deletion variants, so no term list is scanned.
+//
+// sync() applies a state snapshot incrementally: only entities whose shared
+// payload changed since the last sync are re-tokenised. Terms left without
+// postings are dropped at the end of each sync and their ids reused, so
+// re-indexing half-typed words does not grow the term tables. It takes the
+// write lock; search() takes the read lock and may run on any thread.
+class SearchIndex
+{
+public:
+    enum Kind
+    {
+        TaskKind = 0x1,
+        SubtaskKind = 0x2,
+        ActivityKind = 0x4
+    };
+    Q_DECLARE_FLAGS(Kinds, Kind)
+
+    struct Hit
+    {
+        Kind kind = TaskKind;
+        QString id;
+        QString taskId; // owning task for subtasks, the task itself for tasks
+        double score = 0.0;
+    };
+
+    void sync(const AppSnapshot &snapshot);
+
+    QVector<Hit> search(const QString &query, Kinds kinds, int limit, const CancellationToken &token) const;
+    int documentCount() const;
+
+    static QStringList tokenize(const QString &text);
+
+private:
+    struct Posting
+    {
+        int document = 0;
+        bool inTitle = false;
+    };
+
+    struct Term
+    {
+        QString text;
+        QVector<Posting> postings;
+    };
+
+    struct Document
+    {
+        Kind kind = TaskKind;
+        QString id;
+        QString taskId;
+        QVector<int> terms;
+        bool alive = false;
+    };
+
+    void syncTasks(const QVector<Task> &tasks);
+    void syncActivities(const QVector<Activity> &activities);
+    void indexDocument(Kind kind, const QString &id, const QString &taskId, const QString &title, const QString &description);
+    void removeDocument(Kind kind, const QString &id);
+    int termId(const QString &text);
+    void reclaimTerms();
+    void rebuildSortedTerms();
+    QVector<QPair<int, int>> matchingTerms(const QString &token) const;
+
+    mutable QReadWriteLock mLock;
+    quint64 mVersion = 0;
+
+    std::vector<Document> mDocuments;
+    QVector<int> mFreeDocuments;
+    QHash<QString, int> mDocumentIds; // kind-prefixed entity id -> document
+    int mLiveDocuments = 0;
+
+    QVector<Term> mTerms; // free slots have empty text
+    QVector<int> mFreeTerms;
+    QVector<int> mEmptyTerms; // lost their last posting during this sync
+    QHash<QString, int> mTermIds;
+    QVector<int> mSortedTerms; // term ids ordered by text, for prefix ranges
+    bool mSortedTermsDirty = false;
+    QHash<QString, QVector<int>> mDeletions; // single-deletion variant -> term ids
+
+    QHash<QString, Task> mIndexedTasks;
+    QHash<QString, Subtask> mIndexedSubtasks;
+    QHash<QString, Activity> mIndexedActivities;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(SearchIndex::Kinds)
+
@@ -2,7 +2,9 @@
 
 #include "jsonmanager.h"
 #include "models.h"
+#include "scheduleindex.h"
 
+#include <QBoxLayout>
 #include <QButtonGroup>
 #include <QWidget>
 
@@ -13,6 +15,7 @@ public:
     explicit SettingsPage(QWidget *parent = nullptr);
 
     void setJsonManager(JsonManager *manager);
+    void setSchedule(const ScheduleIndex &schedule);
     void setSettings(const SettingsData &settings);
 
 signals:
@@ -20,11 +23,15 @@ signals:
 
 private:
     void createLayout();
+    void rebuildChoices(QButtonGroup *group, QHBoxLayout *layout, const QStringList &labels, const QVector<int> &ids);
     void updateControls();
 
     JsonManager *mJsonManager = nullptr;
+    ScheduleIndex mSchedule;
     SettingsData mSettings;
 
     QButtonGroup *mWeekGroup = nullptr;
     QButtonGroup *mYearGroup = nullptr;
+    QHBoxLayout *mWeekButtons = nullptr;
+    QHBoxLayout *mYearButtons = nullptr;
 };
@@ -6,32 +6,54 @@
 #include <QToolButton>
 #include <QVector>
 
+class QEnterEvent;
+
+// Floats above the page stack and slides in by animating its position, so the
+// pages underneath never change geometry.
 class Sidebar : public QFrame
 {
     Q_OBJECT
 public:
     explicit Sidebar(QWidget *parent = nullptr);
 
-    void setExpandedWidth(int width);
+    void setOverlayGeometry(int expandedWidth, int height);
     int expandedWidth() const;
 
     void expand();
     void collapse();
     bool isExpanded() const;
+    // Reflects programmatic navigation without emitting pageRequested.
+    void setCurrentIndex(int index);
 
 signals:
     void pageRequested(int index);
 
 protected:
-    void enterEvent(QEvent *event) override;
+    void enterEvent(QEnterEvent *event) override;
     void leaveEvent(QEvent *event) override;
 
 private:
     void rebuildUi();
-    void animateToWidth(int width);
+    void animateToX(int x);
+    bool containsCursor() const;
 
     QVector<QToolButton *> mButtons;
     QPropertyAnimation *mAnimation = nullptr;
     int mExpandedWidth = 260;
-    bool mExplicitHover = false;
+    bool mExpanded = false;
+};
+
+// Thin invisible strip along the window edge that reveals the sidebar when the
+// pointer enters it.
+class SidebarHotZone : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SidebarHotZone(QWidget *parent = nullptr);
+
+signals:
+    void entered();
+
+protected:
+    void enterEvent(QEnterEvent *event) override;
 };
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "models.h"
+#include "scheduleindex.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+// One immutable, consistent version of the application data. Entities and
+// containers are implicitly shared, so a snapshot costs a handful of reference
+// counts and may be read from any thread.
+struct AppSnapshot
+{
+    quint64 version = 0;
+    QVector<Activity> activities;
+    QVector<Task> tasks;
+    SettingsData settings;
+    ScheduleIndex schedule;
+};
+
+using AppSnapshotPtr = std::shared_ptr<const AppSnapshot>;
+
+// Holds the current AppSnapshot behind an atomically swapped shared_ptr.
+// Readers on any thread call snapshot() without taking the writer lock and keep
+// their version alive for as long as they hold it. Writers (the GUI thread)
+// copy the current snapshot, apply their change and publish the result as the
+// next version.
+class StateStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StateStore(QObject *parent = nullptr);
+
+    AppSnapshotPtr snapshot() const;
+
+    void publishActivities(const QVector<Activity> &activities);
+    void publishTasks(const QVector<Task> &tasks);
+    void publishSettings(const SettingsData &settings);
+    void publishSchedule(const ScheduleIndex &schedule);
+
+signals:
+    void published(quint64 version);
+
+private:
+    void publish(const std::function<void(AppSnapshot &)> &change);
+
+    QMutex mWriteMutex;
+    AppSnapshotPtr mCurrent;
+};
+
+// Compares two versions of an entity list in snapshot order. changed() is called
+// for every entity that is new or no longer shares its payload with the previous
+// version, removed() with the id of every entity that is gone. The common prefix
+// and suffix are matched by position at one pointer comparison per entity, and
+// only the differing middle is looked up by id, so one edit hashes only the
+// entities it touched.
+template <typename Entity, typename Changed, typename Removed>
+void diffEntities(const QVector<Entity> &previous, const QVector<Entity> &next, Changed changed, Removed removed)
+{
+    qsizetype first = 0;
+    const qsizetype common = std::min(previous.size(), next.size());
+    while (first < common && previous.at(first).isSharedWith(next.at(first)))
+    {
+        ++first;
+    }
+    qsizetype previousEnd = previous.size();
+    qsizetype nextEnd = next.size();
+    while (previousEnd > first && nextEnd > first && previous.at(previousEnd - 1).isSharedWith(next.at(nextEnd - 1)))
+    {
+        --previousEnd;
+        --nextEnd;
+    }
+
+    QHash<QString, qsizetype> previousIds;
+    previousIds.reserve(previousEnd - first);
+    for (qsizetype i = first; i < previousEnd; ++i)
+    {
+        previousIds.insert(previous.at(i).id(), i);
+    }
+    for (qsizetype i = first; i < nextEnd; ++i)
+    {
+        const Entity &entity = next.at(i);
+        const auto match = previousIds.find(entity.id());
+        if (match != previousIds.end())
+        {
+            const bool unchanged = previous.at(*match).isSharedWith(entity);
+            previousIds.erase(match);
+            if (unchanged)
+            {
+                continue;
+            }
+        }
+        changed(entity);
+    }
+    for (auto it = previousIds.cbegin(); it != previousIds.cend(); ++it)
+    {
+        removed(it.key());
+    }
+}
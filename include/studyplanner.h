@@ -0,0 +1,45 @@
+#pragma once
+
+#include "freetimemap.h"
+#include "models.h"
+#include "statestore.h"
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+// Places study sessions for a task's open subtasks into free time. The
+// requested time is split across subtasks by weighting, in whole slots that
+// add up to no more than the request; subtasks are then placed earliest due
+// first, each into the earliest free runs before its due time (or the task's
+// end), in sessions of 30 minutes to 2 hours. A share too small for a session
+// is added to the next subtask's. Placed sessions are marked busy so later
+// subtasks never overlap them.
+class StudyPlanner
+{
+public:
+    struct Session
+    {
+        QString subtaskId; // empty when the task has no subtasks
+        QString title;
+        QDateTime start;
+        QDateTime end;
+    };
+
+    struct Plan
+    {
+        QVector<Session> sessions;
+        int requestedMinutes = 0;
+        int plannedMinutes = 0;
+        bool nothingLeft = false; // every subtask is already completed
+    };
+
+    static constexpr int kHorizonDays = 120;
+
+    // Free time from the start of from's day over kHorizonDays, excluding the
+    // timetable, activities and hours outside the study day.
+    static FreeTimeMap availability(const AppSnapshot &snapshot, const QDateTime &from);
+
+    static Plan plan(const Task &task, int minutes, FreeTimeMap &map, const QDateTime &notBefore);
+    static QVector<Activity> toActivities(const Plan &plan, const Task &task);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "models.h"
+
+#include <QVector>
+
+#include <limits>
+
+// Columnar store for every subtask of a task list. The numeric fields used by the
+// progress/overdue kernels live in parallel contiguous arrays, grouped per task so a
+// task's subtasks form one contiguous range.
+class SubtaskStore
+{
+public:
+    static constexpr qint64 kNoDueTime = std::numeric_limits<qint64>::max();
+
+    void rebuild(const QVector<Task> &tasks);
+    void replaceTask(int taskIndex, const Task &task);
+    void clear();
+
+    int size() const;
+    int taskCount() const;
+    int firstSubtask(int taskIndex) const;
+    int subtaskCount(int taskIndex) const;
+
+    double weighting(int index) const;
+    bool isCompleted(int index) const;
+    qint64 dueSecs(int index) const;
+
+    double progress(int taskIndex) const;
+    QVector<double> progressAll() const;
+    int overdueCount(qint64 nowSecs) const;
+    int dueBetweenCount(qint64 fromSecs, qint64 toSecs) const;
+    // Due times of the task's open subtasks, ascending; subtasks without one are skipped.
+    QVector<qint64> openDueTimes(int taskIndex) const;
+
+private:
+    void appendSubtasks(const Task &task);
+
+    QVector<double> mWeightings;
+    QVector<quint8> mCompleted;
+    QVector<qint64> mDueSecs;
+    QVector<qint32> mTaskOffsets;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "models.h"
+
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <QVector>
+
+// Table model over the subtasks of the task open in TaskDetailView. Rows are
+// painted by the view; editors exist only while a cell is being edited.
+// Structural changes go through insertSubtask/removeSubtask/moveSubtask so the
+// view updates incrementally instead of being reset.
+class SubtaskTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column
+    {
+        DoneColumn,
+        TitleColumn,
+        DescriptionColumn,
+        DueColumn,
+        WeightColumn,
+        ColumnCount
+    };
+
+    explicit SubtaskTableModel(QObject *parent = nullptr);
+
+    void setSubtasks(const QVector<Subtask> &subtasks);
+    const Subtask &subtaskAt(int row) const;
+
+    void insertSubtask(int row, const Subtask &subtask);
+    void removeSubtask(int row);
+    bool moveSubtask(int from, int to);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+signals:
+    void subtaskEdited(int row, const Subtask &subtask);
+
+private:
+    QVector<Subtask> mSubtasks;
+};
+
+// Configures the due-time and weighting editors to match the rest of the UI.
+class SubtaskItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    void updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
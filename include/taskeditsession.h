@@ -0,0 +1,37 @@
+#pragma once
+
+#include "models.h"
+
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+
+// Buffers edits to the task open in TaskDetailView. Editors apply changes to the
+// local copy through update(); the accumulated task is only published through
+// committed() once typing pauses, or when the owner commits on focus loss or
+// navigation. The time update() takes to apply one edit and notify listeners
+// is recorded as "taskEdit.update".
+class TaskEditSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TaskEditSession(QObject *parent = nullptr);
+
+    void begin(const Task &task);
+    const Task &task() const;
+    bool isDirty() const;
+
+    void update(const std::function<void(Task &)> &change);
+    void commit();
+    void discard();
+
+signals:
+    void edited(const Task &task);
+    void committed(const Task &task);
+
+private:
+    Task mTask;
+    bool mDirty = false;
+    QTimer *mIdleTimer = nullptr;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QObject>
+#include <QPointer>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Shared cancellation flag. Copies observe the same flag; a job checks
+// isCancelled() at convenient points and its completion is dropped once the
+// token has been cancelled.
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic_bool> mCancelled;
+};
+
+// Application-wide work-stealing thread pool with three priority lanes. Each
+// worker owns one deque per lane; jobs posted from a worker go to its own
+// deques, other jobs are spread round-robin. An idle worker takes the highest
+// priority job available, first from the back of its own deques and then from
+// the front of other workers'. Queue depth per lane and wait/run times are
+// published to Metrics under "scheduler.*".
+class TaskScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority
+    {
+        Interactive,
+        Background,
+        Idle,
+        PriorityCount
+    };
+
+    explicit TaskScheduler(int threadCount = 0, QObject *parent = nullptr);
+    ~TaskScheduler() override;
+
+    void post(Priority priority, std::function<void()> job, const CancellationToken &token = CancellationToken());
+
+    // Runs work on a worker and hands its result to done on the GUI thread,
+    // unless the token was cancelled or context destroyed in the meantime.
+    template <typename Result>
+    void run(Priority priority, const CancellationToken &token, std::function<Result(const CancellationToken &)> work,
+             QObject *context, std::function<void(Result)> done)
+    {
+        const QPointer<QObject> guard(context);
+        post(priority, [token, work = std::move(work), guard, done = std::move(done)]() {
+            Result result = work(token);
+            if (token.isCancelled())
+            {
+                return;
+            }
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [token, result = std::move(result), guard, done]() {
+                if (guard && !token.isCancelled())
+                {
+                    done(result);
+                }
+            }, Qt::QueuedConnection);
+        }, token);
+    }
+
+    int threadCount() const;
+
+private:
+    struct Job
+    {
+        std::function<void()> run;
+        CancellationToken token;
+        qint64 enqueuedNs = 0;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> lanes[PriorityCount];
+        std::thread thread;
+    };
+
+    void workerLoop(int index);
+    bool takeJob(int index, Job &job, Priority &priority);
+    void updateDepth(Priority priority, int delta);
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    std::atomic_int mPending{0};
+    std::atomic_int mDepth[PriorityCount] = {};
+    std::atomic_uint mNextWorker{0};
+    std::atomic_bool mStopping{false};
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "models.h"
+#include "subtaskstore.h"
+
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// Sort and filter keys for every task, held in arrays parallel to the task
+// list. Keys are absolute (seconds since epoch, progress percent), so the
+// current time only enters a query as a bound: re-ranking compares stored keys
+// and never walks subtasks. rebuild() derives all keys from a SubtaskStore;
+// updateTask() refreshes the keys of one task after an edit.
+class TaskSortKeys
+{
+public:
+    static constexpr qint64 kNoTime = SubtaskStore::kNoDueTime;
+
+    enum class Order
+    {
+        Manual,
+        EndTime,
+        NextDue,
+        Progress
+    };
+
+    enum class Filter
+    {
+        All,
+        DueSoon,
+        Overdue,
+        DateRange
+    };
+
+    struct Query
+    {
+        Order order = Order::Manual;
+        Filter filter = Filter::All;
+        qint64 nowSecs = 0;
+        qint64 soonSecs = 7 * 24 * 3600; // DueSoon window length
+        qint64 fromSecs = 0;             // DateRange bounds, inclusive
+        qint64 toSecs = 0;
+        const QSet<QString> *ids = nullptr; // optional restriction, e.g. search matches
+    };
+
+    void rebuild(const QVector<Task> &tasks, const SubtaskStore &store);
+    void updateTask(int taskIndex, const Task &task, const SubtaskStore &store);
+    void clear();
+
+    int size() const;
+    double progress(int taskIndex) const;
+    qint64 nextDueSecs(int taskIndex) const;
+
+    // Task indices passing the filter, in the requested order. Ties keep list order.
+    QVector<int> rank(const Query &query) const;
+
+private:
+    bool accepts(int taskIndex, const Query &query) const;
+
+    QVector<QString> mIds;
+    QVector<qint64> mStartSecs;
+    QVector<qint64> mEndSecs;
+    QVector<qint64> mNextDueSecs;
+    QVector<QVector<qint64>> mOpenDueSecs; // per task, ascending
+    QVector<double> mProgress;
+};
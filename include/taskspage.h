@@ -1,20 +1,30 @@
 #pragma once
 
 #include "models.h"
-
-#include <QCheckBox>
+#include "searchfield.h"
+#include "subtaskstore.h"
+#include "subtasktablemodel.h"
+#include "taskeditsession.h"
+#include "tasksortkeys.h"
+#include "widgetpool.h"
+
+#include <QButtonGroup>
+#include <QComboBox>
+#include <QDateEdit>
 #include <QDateTimeEdit>
-#include <QDoubleSpinBox>
 #include <QFrame>
 #include <QLineEdit>
 #include <QMouseEvent>
 #include <QProgressBar>
 #include <QPushButton>
+#include <QSet>
 #include <QStackedWidget>
+#include <QTableView>
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QWidget>
 
+class QHideEvent;
 class QShowEvent;
 
 class TaskCardWidget : public QFrame
@@ -38,30 +48,6 @@ private:
     QProgressBar *mProgress = nullptr;
 };
 
-class SubtaskRowWidget : public QFrame
-{
-    Q_OBJECT
-public:
-    explicit SubtaskRowWidget(QWidget *parent = nullptr);
-    void setSubtask(const Subtask &subtask);
-    Subtask subtask() const;
-
-signals:
-    void subtaskChanged(const Subtask &subtask);
-    void deleteRequested(const QString &subtaskId);
-
-private:
-    void updateUi();
-
-    Subtask mSubtask;
-    QCheckBox *mCheck = nullptr;
-    QLineEdit *mTitleEdit = nullptr;
-    QTextEdit *mDescriptionEdit = nullptr;
-    QDateTimeEdit *mDueEdit = nullptr;
-    QDoubleSpinBox *mWeightSpin = nullptr;
-    QPushButton *mDeleteButton = nullptr;
-};
-
 class TaskDetailView : public QWidget
 {
     Q_OBJECT
@@ -73,19 +59,30 @@ public:
 signals:
     void taskUpdated(const Task &task);
     void taskDeleted(const QString &taskId);
+    void backRequested();
+    void studyPlanRequested(const Task &task);
+
+protected:
+    void hideEvent(QHideEvent *event) override;
 
 private:
-    void rebuildSubtasks();
+    void moveCurrentSubtask(int offset);
+    void updateSubtaskActions();
     void recalculateProgress();
 
-    Task mTask;
+    TaskEditSession *mSession = nullptr;
     QLineEdit *mTitleEdit = nullptr;
     QTextEdit *mDescriptionEdit = nullptr;
     QDateTimeEdit *mStartEdit = nullptr;
     QDateTimeEdit *mEndEdit = nullptr;
     QProgressBar *mProgressBar = nullptr;
     QPushButton *mDeleteButton = nullptr;
-    QVBoxLayout *mSubtaskLayout = nullptr;
+    SubtaskTableModel *mSubtaskModel = nullptr;
+    QTableView *mSubtaskTable = nullptr;
+    QPushButton *mMoveUpButton = nullptr;
+    QPushButton *mMoveDownButton = nullptr;
+    QPushButton *mDeleteSubtaskButton = nullptr;
+    QLabel *mEmptyLabel = nullptr;
 };
 
 class TasksPage : public QWidget
@@ -95,18 +92,27 @@ public:
     explicit TasksPage(QWidget *parent = nullptr);
 
     void setJsonManager(JsonManager *manager);
+    void setSearch(const SearchIndex *index, TaskScheduler *scheduler);
     void setTasks(const QVector<Task> &tasks);
+    void refreshSearch();
     void refreshFromHome(const QVector<Activity> &activities);
+    void showTask(const QString &taskId);
 
 signals:
     void tasksChanged(const QVector<Task> &tasks);
+    void studyPlanRequested(const Task &task, int minutes);
 
 protected:
     void showEvent(QShowEvent *event) override;
 
 private:
     void createLayout();
+    QWidget *createFilterBar(QWidget *parent);
     void rebuildList();
+    void rebuildKeys();
+    void showList();
+    void applySearch(const QVector<SearchIndex::Hit> &hits);
+    void updateSummary();
     void openTaskDetail(const QString &taskId);
     void saveTask(const Task &task);
     void deleteTask(const QString &taskId);
@@ -114,9 +120,25 @@ private:
 
     JsonManager *mJsonManager = nullptr;
     QVector<Task> mTasks;
-
+    SubtaskStore mSubtaskStore;
+    TaskSortKeys mSortKeys;
+    TaskSortKeys::Order mOrder = TaskSortKeys::Order::Manual;
+    TaskSortKeys::Filter mFilter = TaskSortKeys::Filter::All;
+    bool mListStale = true;
+    bool mSearchActive = false;
+    QSet<QString> mSearchMatches;
+
+    QLabel *mSummaryLabel = nullptr;
+    SearchField *mSearchField = nullptr;
     QStackedWidget *mStack = nullptr;
     QWidget *mListPage = nullptr;
+    QButtonGroup *mFilterGroup = nullptr;
+    QComboBox *mSortCombo = nullptr;
+    QWidget *mRangeControls = nullptr;
+    QDateEdit *mRangeFromEdit = nullptr;
+    QDateEdit *mRangeToEdit = nullptr;
     TaskDetailView *mDetailPage = nullptr;
     QVBoxLayout *mListLayout = nullptr;
+    QLabel *mEmptyLabel = nullptr;
+    WidgetPool<TaskCardWidget> mCardPool;
 };
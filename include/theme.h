@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QColor>
+#include <QIcon>
+
+class QApplication;
+class QWidget;
+
+// All static styling lives in :/styles/app.qss and is parsed once at startup.
+// Widgets opt into a style through their objectName or the "role" dynamic
+// property; per-item colors go through icons, palettes or custom painting so
+// rebuilding a page never parses a stylesheet.
+class Theme
+{
+public:
+    static void apply(QApplication &app);
+    // Must be called before the widget is first polished (i.e. before it is shown).
+    static void setRole(QWidget *widget, const char *role);
+    static QIcon swatch(const QColor &color);
+};
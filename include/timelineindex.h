@@ -0,0 +1,58 @@
+#pragma once
+
+#include "models.h"
+#include "scheduleindex.h"
+#include "statestore.h"
+
+#include <QColor>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+// Viewport queries for the timeline. Activities are kept sorted by start and
+// read as an implicit balanced tree (each range's midpoint is its root) that
+// records the latest end in every subtree. An overlap query for [from, to)
+// prunes subtrees that end too early or start too late, so its cost follows
+// the number of matches, not the length of the longest activity. Deadlines are
+// sorted points. Timetable periods are never expanded
+// ahead of time: the schedule is walked one visible day at a time, so a query
+// costs the same whether the data spans a week or years. Times are msecs since
+// the epoch.
+class TimelineIndex
+{
+public:
+    struct Span
+    {
+        qint64 start = 0;
+        qint64 end = 0;
+        QColor color;
+        QString title;
+    };
+
+    struct Mark
+    {
+        qint64 time = 0;
+        QString title;
+    };
+
+    void rebuild(const AppSnapshot &snapshot);
+    quint64 version() const;
+
+    // Earliest and latest time touched by any activity or deadline; both are 0 when empty.
+    qint64 firstTime() const;
+    qint64 lastTime() const;
+
+    // Items overlapping [from, to), in start order.
+    void forEachActivity(qint64 from, qint64 to, const std::function<void(const Span &)> &visit) const;
+    void forEachPeriod(qint64 from, qint64 to, const std::function<void(const Span &)> &visit) const;
+    void forEachDeadline(qint64 from, qint64 to, const std::function<void(const Mark &)> &visit) const;
+
+private:
+    QVector<Span> mActivities;
+    QVector<qint64> mSubtreeEnd; // latest end in the subtree rooted at each activity
+    QVector<Mark> mDeadlines;
+    ScheduleIndex mSchedule;
+    SettingsData mSettings;
+    quint64 mVersion = 0;
+};
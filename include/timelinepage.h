@@ -0,0 +1,96 @@
+#pragma once
+
+#include "statestore.h"
+#include "timelineindex.h"
+#include "workloadheatmap.h"
+#include "workloadindex.h"
+
+#include <QButtonGroup>
+#include <QLabel>
+#include <QScrollBar>
+#include <QWidget>
+
+// Paints classes, activities and deadlines for the visible time range only,
+// querying the TimelineIndex on every paint. Items wide enough to read are drawn
+// as bars; narrower ones are binned per pixel column into a density strip, and
+// deadlines closer than a few pixels are drawn as one counted marker, so paint
+// cost follows the widget's width rather than the number of items in view.
+class TimelineWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit TimelineWidget(QWidget *parent = nullptr);
+
+    void setIndex(const TimelineIndex *index);
+    void setView(qint64 start, qint64 span);
+    qint64 viewStart() const;
+    qint64 viewSpan() const;
+
+signals:
+    void viewChanged(qint64 start, qint64 span);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    void drawTicks(QPainter &painter) const;
+    void drawSpanLane(QPainter &painter, const QRectF &lane, const QString &title, bool periods) const;
+    void drawDeadlineLane(QPainter &painter, const QRectF &lane) const;
+    qreal xFor(qint64 time) const;
+    qint64 timeAt(qreal x) const;
+
+    const TimelineIndex *mIndex = nullptr;
+    qint64 mViewStart = 0;
+    qint64 mViewSpan = 0;
+    QFont mLabelFont;
+    QFont mItemFont;
+    bool mDragging = false;
+    qreal mDragX = 0.0;
+    qint64 mDragStart = 0;
+};
+
+class TimelinePage : public QWidget
+{
+    Q_OBJECT
+public:
+    enum Zoom
+    {
+        Day,
+        Week,
+        Month
+    };
+
+    explicit TimelinePage(QWidget *parent = nullptr);
+
+    // Only stored; the index is rebuilt when the page is shown.
+    void setSnapshot(const AppSnapshotPtr &snapshot);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void createLayout();
+    void rebuildIndex();
+    void setZoom(Zoom zoom);
+    void showToday();
+    void updateScrollBar();
+    void updateRangeLabel();
+    void updateWorkloadSummary();
+
+    AppSnapshotPtr mSnapshot;
+    TimelineIndex mIndex;
+    WorkloadIndex mWorkload;
+    Zoom mZoom = Week;
+    qint64 mScrollOrigin = 0;
+
+    TimelineWidget *mTimeline = nullptr;
+    QScrollBar *mScrollBar = nullptr;
+    QButtonGroup *mZoomGroup = nullptr;
+    QLabel *mRangeLabel = nullptr;
+    WorkloadHeatmap *mHeatmap = nullptr;
+    QLabel *mWorkloadLabel = nullptr;
+};
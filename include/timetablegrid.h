@@ -0,0 +1,97 @@
+#pragma once
+
+#include "models.h"
+
+#include <QCache>
+#include <QColor>
+#include <QFont>
+#include <QRectF>
+#include <QSizeF>
+#include <QStaticText>
+#include <QVector>
+#include <QWidget>
+
+struct TimetableGridColumn
+{
+    QString title;
+    QVector<TimetablePeriod> periods;
+};
+
+// Paints the whole weekly grid in one widget. Cells are laid out once per data or
+// width change and their text is cached as QStaticText, so a week switch is a
+// relayout of plain structs followed by a repaint. Prepared models can be parked
+// under a key and swapped back in without re-shaping any text. Building and
+// laying out a model only reads a copied Style, so prefetched weeks are shaped
+// on a worker thread and handed to cacheModel() ready to paint.
+class TimetableGridWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    struct Cell
+    {
+        int column = 0;
+        int row = 0;
+        bool placeholder = false;
+        TimetablePeriod period;
+        QColor background;
+        QRectF rect;
+        QStaticText title;
+        QStaticText subtitle;
+    };
+
+    struct Model
+    {
+        QVector<Cell> cells;
+        QVector<QStaticText> headers;
+        QVector<QRectF> headerRects;
+        int columnCount = 0;
+        int rowCount = 0;
+    };
+
+    // The fonts and size a model is built and laid out for.
+    struct Style
+    {
+        QFont headerFont;
+        QFont titleFont;
+        QFont specialTitleFont;
+        QFont subtitleFont;
+        QSizeF size;
+    };
+
+    explicit TimetableGridWidget(QWidget *parent = nullptr);
+
+    Style gridStyle() const;
+    static Model buildModel(const QVector<TimetableGridColumn> &columns, const Style &style);
+
+    void setColumns(const QVector<TimetableGridColumn> &columns, const QString &cacheKey = QString());
+    void cacheModel(const QString &cacheKey, Model model);
+    bool hasCachedModel(const QString &cacheKey) const;
+    bool showCachedModel(const QString &cacheKey);
+    void clearCache();
+    int cellAt(const QPointF &pos) const;
+
+signals:
+    void periodActivated(const TimetablePeriod &period);
+
+protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
+private:
+    static void layoutModel(Model &model, const Style &style);
+    void installModel(Model model, const QString &cacheKey);
+    void setHoverIndex(int index);
+
+    Model mModel;
+    QString mModelKey;
+    QCache<QString, Model> mCache;
+    QFont mHeaderFont;
+    QFont mTitleFont;
+    QFont mSpecialTitleFont;
+    QFont mSubtitleFont;
+    int mHoverIndex = -1;
+};
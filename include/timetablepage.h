@@ -2,27 +2,21 @@
 
 #include "jsonmanager.h"
 #include "models.h"
+#include "scheduleindex.h"
+#include "taskscheduler.h"
+#include "timetablegrid.h"
 
+#include <QBoxLayout>
 #include <QButtonGroup>
-#include <QFrame>
-#include <QGridLayout>
+#include <QCompleter>
+#include <QDate>
 #include <QLabel>
+#include <QLineEdit>
+#include <QSet>
+#include <QTimer>
 #include <QVector>
 #include <QWidget>
 
-class TimetableCard : public QFrame
-{
-    Q_OBJECT
-public:
-    explicit TimetableCard(QWidget *parent = nullptr);
-    void setPeriod(const TimetablePeriod &period);
-    void setEmptyLabel(const QString &label);
-
-private:
-    QLabel *mTitle = nullptr;
-    QLabel *mSubtitle = nullptr;
-};
-
 class TimetablePage : public QWidget
 {
     Q_OBJECT
@@ -30,19 +24,58 @@ public:
     explicit TimetablePage(QWidget *parent = nullptr);
 
     void setJsonManager(JsonManager *manager);
-    void setSchoolPeriods(const SchoolPeriodsData &data);
+    void setScheduler(TaskScheduler *scheduler);
+    // Setters only store; refreshSchedule() rebuilds the week buttons and variants,
+    // refreshWeek() re-renders the shown week for the current settings.
+    void setSchedule(const ScheduleIndex &schedule);
     void setSettings(const SettingsData &settings);
+    void refreshSchedule();
+    void refreshWeek();
+
+signals:
+    void settingsChanged(const SettingsData &settings);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 
 private:
     void createLayout();
+    void rebuildWeekButtons();
+    void rebuildVariants();
     void rebuildTimetable();
-    QVector<TimetablePeriod> buildDay(const QString &weekKey, const QString &dayName) const;
+    void rebuildSubjectSummary();
+    void rebuildFacetCompleter();
+    void updateFacetLookup();
+    void showWeek(int offset);
+    void prefetchWeek(int offset);
+    int weekForOffset(int offset) const;
+    QDate mondayForOffset(int offset) const;
+    QString modelKey(int offset) const;
+    QVector<TimetableGridColumn> variant(int week, int yearIndex) const;
+    static QVector<TimetableGridColumn> datedColumns(const QVector<TimetableGridColumn> &variant, const QVector<int> &days, const QDate &monday);
 
     JsonManager *mJsonManager = nullptr;
-    SchoolPeriodsData mData;
+    TaskScheduler *mScheduler = nullptr;
+    ScheduleIndex mSchedule;
     SettingsData mSettings;
 
+    // Every (week, year level) combination, materialised once per schedule and
+    // indexed densely by week * yearLevels().size() + yearIndex.
+    QVector<QVector<TimetableGridColumn>> mVariants;
+    QSet<QString> mPendingPrefetch;
+    CancellationToken mPrefetchToken;
+    int mWeekOffset = 0;
+
     QButtonGroup *mWeekGroup = nullptr;
-    QGridLayout *mGridLayout = nullptr;
+    QHBoxLayout *mWeekButtonLayout = nullptr;
+    TimetableGridWidget *mGrid = nullptr;
     QLabel *mWeekLabel = nullptr;
+    QLabel *mRangeLabel = nullptr;
+    QLabel *mSubjectSummary = nullptr;
+    QLineEdit *mFacetEdit = nullptr;
+    QCompleter *mFacetCompleter = nullptr;
+    QLabel *mFacetResult = nullptr;
+    QTimer *mSaveTimer = nullptr;
+    QTimer *mMinuteTimer = nullptr;
 };
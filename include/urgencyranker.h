@@ -0,0 +1,53 @@
+#pragma once
+
+#include "models.h"
+#include "statestore.h"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <limits>
+#include <vector>
+
+// Ranks open tasks by urgency in an indexed binary min-heap. A task's key is
+// its effective deadline (the earlier of its next open subtask due time and
+// its end time) pulled forward by the share of weighted work still remaining.
+// Keys are absolute times, so the order never changes just because time
+// passes; only edits move a task, and each edit re-keys one heap node in
+// O(log n). top() walks the heap best-first and touches O(count log count)
+// nodes regardless of how many tasks are ranked.
+class UrgencyRanker
+{
+public:
+    struct Entry
+    {
+        QString taskId;
+        QString title;
+        qint64 deadlineSecs = 0; // kNoDeadline when the task has none
+        double progress = 0.0;
+        qint64 key = 0;
+    };
+
+    static constexpr qint64 kNoDeadline = std::numeric_limits<qint64>::max();
+
+    void sync(const AppSnapshot &snapshot);
+    QVector<Entry> top(int count) const;
+    int size() const;
+
+private:
+    void update(const Task &task);
+    void remove(const QString &taskId);
+    void siftUp(int position);
+    void siftDown(int position);
+    void swapNodes(int a, int b);
+    bool less(int a, int b) const;
+
+    std::vector<Entry> mEntries;  // slot -> entry
+    std::vector<int> mPositions;  // slot -> heap position, -1 when free
+    std::vector<int> mHeap;       // heap position -> slot
+    QVector<int> mFreeSlots;
+    QHash<QString, int> mSlots;
+    QVector<Task> mTasks; // the last synced snapshot order
+    quint64 mVersion = 0;
+};
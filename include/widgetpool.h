@@ -0,0 +1,89 @@
+#pragma once
+
+#include "metrics.h"
+
+#include <QString>
+#include <QVector>
+#include <QWidget>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+// Recycles widgets of one type instead of deleting and re-creating them on every
+// rebuild. The factory runs only on a pool miss, so signal connections made there
+// are set up once per widget; callers rebind acquired widgets to new data.
+// Widgets stay owned by their Qt parent; released ones are merely hidden. The
+// idle list keeps at most as many widgets as the last rebuild used (and never
+// fewer than kMinIdle), so one very long list does not pin its widgets forever.
+template <typename T>
+class WidgetPool
+{
+public:
+    static constexpr int kMinIdle = 16;
+
+    WidgetPool(const QString &name, std::function<T *()> factory)
+        : mName(name)
+        , mFactory(std::move(factory))
+    {
+    }
+
+    T *acquire()
+    {
+        T *widget = nullptr;
+        if (!mIdle.isEmpty())
+        {
+            widget = mIdle.takeLast();
+            widget->show();
+            Metrics::instance().increment(mName + QStringLiteral(".hits"));
+        }
+        else
+        {
+            widget = mFactory();
+            Metrics::instance().increment(mName + QStringLiteral(".misses"));
+        }
+        mLive.append(widget);
+        Metrics::instance().setGauge(mName + QStringLiteral(".live"), mLive.size());
+        return widget;
+    }
+
+    void releaseAll()
+    {
+        const int keep = std::max<int>(kMinIdle, mLive.size());
+        for (T *widget : std::as_const(mLive))
+        {
+            widget->hide();
+            mIdle.append(widget);
+        }
+        mLive.clear();
+
+        // acquire() takes from the back, so the longest-idle widgets go first.
+        const int excess = mIdle.size() - keep;
+        if (excess > 0)
+        {
+            for (int i = 0; i < excess; ++i)
+            {
+                mIdle.at(i)->deleteLater();
+            }
+            mIdle.remove(0, excess);
+        }
+        Metrics::instance().setGauge(mName + QStringLiteral(".live"), 0);
+        Metrics::instance().setGauge(mName + QStringLiteral(".idle"), mIdle.size());
+    }
+
+    int liveCount() const
+    {
+        return mLive.size();
+    }
+
+    int idleCount() const
+    {
+        return mIdle.size();
+    }
+
+private:
+    QString mName;
+    std::function<T *()> mFactory;
+    QVector<T *> mLive;
+    QVector<T *> mIdle;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "workloadindex.h"
+
+#include <QDate>
+#include <QFont>
+#include <QRectF>
+#include <QWidget>
+
+// Calendar heatmap of daily workload: one column per week, one row per weekday.
+// A day's shade combines the subtask weighting due and the activity hours on it,
+// each relative to the busiest day in view. Every cell reads two array entries
+// from the WorkloadIndex and week totals in tooltips are prefix-sum differences,
+// so a repaint costs the same however many tasks there are.
+class WorkloadHeatmap : public QWidget
+{
+    Q_OBJECT
+public:
+    static constexpr int kWeeks = 53;
+
+    explicit WorkloadHeatmap(QWidget *parent = nullptr);
+
+    void setIndex(const WorkloadIndex *index);
+    // The heatmap covers kWeeks weeks with the week of day in the middle.
+    void setCenter(const QDate &day);
+    QSize sizeHint() const override;
+
+signals:
+    void dayActivated(const QDate &day);
+
+protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    QDate dayAt(const QPointF &pos) const;
+    QRectF cellRect(int week, int dayOfWeek) const;
+    qreal cellSize() const;
+
+    const WorkloadIndex *mIndex = nullptr;
+    QDate mFirstMonday;
+    QFont mLabelFont;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "models.h"
+#include "statestore.h"
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Per-day workload totals: the weighting of open subtasks due on each day and
+// the activity minutes scheduled on it. Every task and activity remembers the
+// per-day amounts it contributed, so sync() only subtracts and re-adds the
+// entities whose payload changed since the last snapshot. Prefix sums over the
+// day arrays are rebuilt lazily on the first range query after a change, after
+// which any range total is a difference of two prefix entries.
+class WorkloadIndex
+{
+public:
+    void sync(const AppSnapshot &snapshot);
+
+    QDate firstDay() const;
+    QDate lastDay() const;
+
+    double dueWeighting(const QDate &day) const;
+    int activityMinutes(const QDate &day) const;
+    // Totals over [from, to], both inclusive.
+    double dueWeighting(const QDate &from, const QDate &to) const;
+    int activityMinutes(const QDate &from, const QDate &to) const;
+
+private:
+    struct Contribution
+    {
+        qint64 julianDay = 0;
+        double amount = 0.0;
+    };
+
+    static QVector<Contribution> contributionsOf(const Task &task);
+    static QVector<Contribution> contributionsOf(const Activity &activity);
+    void apply(const QVector<Contribution> &contributions, QVector<double> &days, double sign);
+    void ensureDays(qint64 firstJulian, qint64 lastJulian);
+    void ensurePrefix() const;
+    int dayIndex(const QDate &day) const;
+
+    qint64 mFirstJulian = 0;
+    QVector<double> mDue;
+    QVector<double> mMinutes;
+    // The last synced snapshot order, and what each entity added to the day arrays.
+    QVector<Task> mTasks;
+    QVector<Activity> mActivities;
+    QHash<QString, QVector<Contribution>> mTaskContributions;
+    QHash<QString, QVector<Contribution>> mActivityContributions;
+    quint64 mVersion = 0;
+
+    // mDuePrefix[i] is the total over days [0, i); both rebuilt when mPrefixDirty.
+    mutable QVector<double> mDuePrefix;
+    mutable QVector<double> mMinutesPrefix;
+    mutable bool mPrefixDirty = true;
+};
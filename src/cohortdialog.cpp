@@ -0,0 +1,172 @@
+#include "cohortdialog.h"
+#include "cohortplanner.h"
+#include "theme.h"
+
+#include <QApplication>
+#include <QBoxLayout>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QPushButton>
+
+namespace
+{
+constexpr int kCohortDays = 7;
+constexpr int kCohortResults = 12;
+}
+
+CohortDialog::CohortDialog(const JsonManager *manager, QWidget *parent)
+    : QDialog(parent)
+    , mManager(manager)
+{
+    setWindowTitle(tr("Common Free Time"));
+    resize(640, 560);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->setSpacing(12);
+
+    auto *profileHeader = new QHBoxLayout();
+    mProfileLabel = new QLabel(this);
+    Theme::setRole(mProfileLabel, "secondary");
+    auto *addButton = new QPushButton(tr("Add Folder..."), this);
+    Theme::setRole(addButton, "secondary");
+    auto *clearButton = new QPushButton(tr("Clear"), this);
+    Theme::setRole(clearButton, "chip");
+    profileHeader->addWidget(mProfileLabel, 1);
+    profileHeader->addWidget(addButton);
+    profileHeader->addWidget(clearButton);
+    layout->addLayout(profileHeader);
+
+    mProfileList = new QListWidget(this);
+    mProfileList->setMaximumHeight(140);
+    layout->addWidget(mProfileList);
+
+    auto *form = new QFormLayout();
+    const QDate today = QDate::currentDate();
+    mWeekEdit = new QDateEdit(today.addDays(1 - today.dayOfWeek()), this);
+    mWeekEdit->setCalendarPopup(true);
+    mWeekEdit->setDisplayFormat(QStringLiteral("yyyy-MM-dd"));
+    mLengthEdit = new QSpinBox(this);
+    mLengthEdit->setRange(FreeTimeMap::kSlotMinutes, 240);
+    mLengthEdit->setSingleStep(FreeTimeMap::kSlotMinutes);
+    mLengthEdit->setValue(60);
+    mLengthEdit->setSuffix(tr(" min"));
+    mFromEdit = new QTimeEdit(QTime(8, 0), this);
+    mToEdit = new QTimeEdit(QTime(18, 0), this);
+    auto *hours = new QHBoxLayout();
+    hours->addWidget(mFromEdit);
+    hours->addWidget(new QLabel(tr("to"), this));
+    hours->addWidget(mToEdit);
+    form->addRow(tr("Week starting"), mWeekEdit);
+    form->addRow(tr("Meeting length"), mLengthEdit);
+    form->addRow(tr("Between"), hours);
+    layout->addLayout(form);
+
+    auto *findButton = new QPushButton(tr("Find Times"), this);
+    Theme::setRole(findButton, "primary");
+    layout->addWidget(findButton, 0, Qt::AlignRight);
+
+    mResults = new QListWidget(this);
+    layout->addWidget(mResults, 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    layout->addWidget(buttons);
+
+    connect(addButton, &QPushButton::clicked, this, [this]() {
+        addFolder(QFileDialog::getExistingDirectory(this, tr("Choose a data directory or a folder of them")));
+    });
+    connect(clearButton, &QPushButton::clicked, this, &CohortDialog::clearProfiles);
+    connect(findButton, &QPushButton::clicked, this, &CohortDialog::findTimes);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    updateProfileLabel();
+}
+
+void CohortDialog::addFolder(const QString &path)
+{
+    if (path.isEmpty())
+    {
+        return;
+    }
+
+    // A folder is either one student's data directory or a parent of several.
+    // Symlinks and re-added folders resolve to the same canonical path.
+    QStringList directories;
+    const auto consider = [&](const QString &directory) {
+        const QString canonical = QFileInfo(directory).canonicalFilePath();
+        if (!canonical.isEmpty() && JsonManager::isDataDirectory(canonical) && !mProfileDirectories.contains(canonical))
+        {
+            mProfileDirectories.insert(canonical);
+            directories.append(canonical);
+        }
+    };
+
+    const QDir dir(path);
+    if (JsonManager::isDataDirectory(dir.absolutePath()))
+    {
+        consider(dir.absolutePath());
+    }
+    else
+    {
+        for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+        {
+            consider(dir.filePath(name));
+        }
+    }
+    if (directories.isEmpty())
+    {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const QVector<ProfileData> loaded = mManager->loadProfiles(directories);
+    QApplication::restoreOverrideCursor();
+    for (const ProfileData &profile : loaded)
+    {
+        mProfiles.append(profile);
+        mProfileList->addItem(profile.name);
+    }
+    updateProfileLabel();
+}
+
+void CohortDialog::clearProfiles()
+{
+    mProfiles.clear();
+    mProfileDirectories.clear();
+    mProfileList->clear();
+    mResults->clear();
+    updateProfileLabel();
+}
+
+void CohortDialog::updateProfileLabel()
+{
+    mProfileLabel->setText(tr("%n profile(s) loaded", nullptr, mProfiles.size()));
+}
+
+void CohortDialog::findTimes()
+{
+    mResults->clear();
+    const QTime from = mFromEdit->time();
+    const QTime to = mToEdit->time();
+    CohortPlanner planner(mWeekEdit->date(), kCohortDays, from.hour() * 60 + from.minute(), to.hour() * 60 + to.minute());
+    planner.setProfiles(mProfiles);
+
+    const auto candidates = planner.bestTimes(mLengthEdit->value(), kCohortResults);
+    if (candidates.isEmpty())
+    {
+        mResults->addItem(tr("No meeting time fits between these hours."));
+        return;
+    }
+    for (const auto &candidate : candidates)
+    {
+        const QString when = tr("%1, %2 - %3").arg(candidate.start.toString(QStringLiteral("ddd d MMM")),
+                                                    candidate.start.toString(QStringLiteral("HH:mm")),
+                                                    candidate.end.toString(QStringLiteral("HH:mm")));
+        const QString who = candidate.conflictCount == 0
+                                ? tr("everyone free")
+                                : tr("%n busy: %1", nullptr, candidate.conflictCount).arg(candidate.conflicting.join(QStringLiteral(", ")));
+        mResults->addItem(QStringLiteral("%1  ·  %2").arg(when, who));
+    }
+}
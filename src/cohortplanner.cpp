@@ -0,0 +1,192 @@
+#include "cohortplanner.h"
+
+#include "metrics.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+using DayWords = FreeTimeMap::DayWords;
+constexpr int kWords = FreeTimeMap::kWordsPerDay;
+
+// Bit i of the result is set when any of bits i .. i + length - 1 is set.
+// Bits past the end of the day are treated as busy, so a window never runs
+// over midnight.
+DayWords dilated(DayWords busy, int length)
+{
+    const int dayBits = FreeTimeMap::kSlotsPerDay;
+    for (int bit = dayBits; bit < kWords * 64; ++bit)
+    {
+        busy[bit / 64] |= quint64(1) << (bit % 64);
+    }
+
+    int covered = 1;
+    while (covered < length)
+    {
+        const int step = std::min(covered, length - covered);
+        const int wordShift = step / 64;
+        const int bitShift = step % 64;
+        DayWords shifted;
+        for (int w = 0; w < kWords; ++w)
+        {
+            const int source = w + wordShift;
+            // Shifting in from past the last word brings in busy bits.
+            quint64 value = source < kWords ? busy[source] >> bitShift : ~quint64(0);
+            if (bitShift != 0)
+            {
+                value |= (source + 1 < kWords ? busy[source + 1] : ~quint64(0)) << (64 - bitShift);
+            }
+            shifted[w] = value;
+        }
+        for (int w = 0; w < kWords; ++w)
+        {
+            busy[w] |= shifted[w];
+        }
+        covered += step;
+    }
+    return busy;
+}
+}
+
+CohortPlanner::CohortPlanner(const QDate &firstDay, int dayCount, int windowStartMinute, int windowEndMinute)
+    : mFirstDay(firstDay)
+    , mDayCount(dayCount)
+    , mWindowStartMinute(windowStartMinute)
+    , mWindowEndMinute(windowEndMinute)
+{
+}
+
+void CohortPlanner::setProfiles(const QVector<ProfileData> &profiles)
+{
+    mNames.clear();
+    mMaps.clear();
+    mMaps.reserve(profiles.size());
+    for (const ProfileData &profile : profiles)
+    {
+        FreeTimeMap map(mFirstDay, mDayCount);
+        map.markOutsideHours(mWindowStartMinute, mWindowEndMinute);
+        map.markSchedule(profile.schedule, profile.settings);
+        map.markActivities(profile.activities);
+        mMaps.append(map);
+        mNames.append(profile.name);
+    }
+}
+
+int CohortPlanner::profileCount() const
+{
+    return mMaps.size();
+}
+
+QVector<CohortPlanner::Candidate> CohortPlanner::bestTimes(int lengthMinutes, int limit) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<Candidate> result;
+    const int length = (lengthMinutes + FreeTimeMap::kSlotMinutes - 1) / FreeTimeMap::kSlotMinutes;
+    if (length <= 0 || length > FreeTimeMap::kSlotsPerDay || mDayCount <= 0)
+    {
+        return result;
+    }
+
+    int planes = 1;
+    while ((1 << planes) <= mMaps.size())
+    {
+        ++planes;
+    }
+
+    // counters[(day * planes + plane) * kWords + word]
+    QVector<quint64> counters(mDayCount * planes * kWords, 0);
+    QVector<QVector<DayWords>> conflicts(mMaps.size());
+    for (int p = 0; p < mMaps.size(); ++p)
+    {
+        conflicts[p].reserve(mDayCount);
+        for (int day = 0; day < mDayCount; ++day)
+        {
+            const DayWords busy = dilated(mMaps.at(p).day(day), length);
+            conflicts[p].append(busy);
+            // Ripple-carry add of one bit per slot into the bit-sliced counters.
+            quint64 *dayCounters = counters.data() + day * planes * kWords;
+            for (int w = 0; w < kWords; ++w)
+            {
+                quint64 carry = busy[w];
+                for (int plane = 0; plane < planes && carry != 0; ++plane)
+                {
+                    quint64 &bits = dayCounters[plane * kWords + w];
+                    const quint64 next = bits & carry;
+                    bits ^= carry;
+                    carry = next;
+                }
+            }
+        }
+    }
+
+    struct Start
+    {
+        int slot;
+        int count;
+    };
+    QVector<Start> starts;
+    const int lastStart = FreeTimeMap::kSlotsPerDay - length;
+    for (int day = 0; day < mDayCount; ++day)
+    {
+        const quint64 *dayCounters = counters.constData() + day * planes * kWords;
+        for (int slot = 0; slot <= lastStart; ++slot)
+        {
+            // Starts outside the meeting window are never offered, even with no profiles loaded.
+            const int minute = slot * FreeTimeMap::kSlotMinutes;
+            if (minute < mWindowStartMinute || minute + length * FreeTimeMap::kSlotMinutes > mWindowEndMinute)
+            {
+                continue;
+            }
+            int count = 0;
+            for (int plane = 0; plane < planes; ++plane)
+            {
+                count |= int((dayCounters[plane * kWords + slot / 64] >> (slot % 64)) & 1) << plane;
+            }
+            starts.append({day * FreeTimeMap::kSlotsPerDay + slot, count});
+        }
+    }
+    std::stable_sort(starts.begin(), starts.end(), [](const Start &a, const Start &b) {
+        return a.count < b.count;
+    });
+
+    const FreeTimeMap clock(mFirstDay, mDayCount);
+    QVector<int> taken;
+    for (const Start &start : starts)
+    {
+        if (result.size() >= limit)
+        {
+            break;
+        }
+        const bool overlaps = std::any_of(taken.cbegin(), taken.cend(), [&](int other) {
+            return std::abs(other - start.slot) < length;
+        });
+        if (overlaps)
+        {
+            continue;
+        }
+        taken.append(start.slot);
+
+        Candidate candidate;
+        candidate.start = clock.timeAt(start.slot);
+        candidate.end = clock.timeAt(start.slot + length);
+        candidate.conflictCount = start.count;
+        const int day = start.slot / FreeTimeMap::kSlotsPerDay;
+        const int bit = start.slot % FreeTimeMap::kSlotsPerDay;
+        for (int p = 0; p < conflicts.size() && start.count > 0; ++p)
+        {
+            if ((conflicts.at(p).at(day)[bit / 64] >> (bit % 64)) & 1)
+            {
+                candidate.conflicting.append(mNames.at(p));
+            }
+        }
+        result.append(candidate);
+    }
+
+    Metrics::instance().recordDuration(QStringLiteral("cohort.bestTimes"), timer.nsecsElapsed() / 1000);
+    return result;
+}
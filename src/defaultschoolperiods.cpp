@@ -0,0 +1,100 @@
+#include "defaultschoolperiods.h"
+#include "defaultschoolperiods_data.h"
+#include "scheduleindex.h"
+
+#include <algorithm>
+
+namespace
+{
+QTime minuteToTime(int minute)
+{
+    return QTime(minute / 60, minute % 60);
+}
+}
+
+QByteArray defaultSchoolPeriodsHash()
+{
+    return QByteArray(DefaultSchoolPeriodsTables::kSha256);
+}
+
+SchoolPeriodsData defaultSchoolPeriods()
+{
+    using namespace DefaultSchoolPeriodsTables;
+
+    SchoolPeriodsData data;
+
+    for (const Subject *subject = kSubjects; subject->name; ++subject)
+    {
+        SubjectDefinition definition;
+        definition.name = QString::fromUtf8(subject->name);
+        definition.teacher = QString::fromUtf8(subject->teacher);
+        definition.color = QColor(QString::fromLatin1(subject->color));
+        data.subjects.insert(definition.name, definition);
+    }
+
+    // Periods are emitted grouped by template and already sorted.
+    for (const Period *period = kPeriods; period->templateName; ++period)
+    {
+        TimetableTemplate &templ = data.templates[QString::fromUtf8(period->templateName)];
+        templ.name = QString::fromUtf8(period->templateName);
+
+        PeriodTime time;
+        time.label = QString::fromUtf8(period->label);
+        time.start = minuteToTime(period->startMinute);
+        time.end = minuteToTime(period->endMinute);
+        templ.periods.append(time);
+    }
+
+    for (const Day *day = kDays; day->week; ++day)
+    {
+        WeekSchedule &week = data.weeks[QString::fromUtf8(day->week)];
+        week.name = QString::fromUtf8(day->week);
+
+        DaySchedule &schedule = week.days[QString::fromUtf8(day->day)];
+        schedule.name = QString::fromUtf8(day->day);
+        schedule.templateName = QString::fromUtf8(day->templateName);
+    }
+
+    for (const Slot *slot = kSlots; slot->week; ++slot)
+    {
+        TimetableSubjectSlot subjectSlot;
+        subjectSlot.periodKey = QString::fromUtf8(slot->periodKey);
+        subjectSlot.subjectName = QString::fromUtf8(slot->subject);
+        subjectSlot.room = QString::fromUtf8(slot->room);
+        data.weeks[QString::fromUtf8(slot->week)].days[QString::fromUtf8(slot->day)].slots.append(subjectSlot);
+    }
+
+    for (const char *const *week = kRotation; *week; ++week)
+    {
+        const QString name = QString::fromUtf8(*week);
+        if (data.weeks.contains(name) && !data.rotation.contains(name))
+        {
+            data.rotation.append(name);
+        }
+    }
+
+    for (const char *const *day = kDayNames; *day; ++day)
+    {
+        const int dayOfWeek = ScheduleIndex::dayOfWeek(QString::fromUtf8(*day));
+        if (dayOfWeek > 0 && !data.days.contains(dayOfWeek))
+        {
+            data.days.append(dayOfWeek);
+        }
+    }
+
+    for (const TemplateOverride *entry = kTemplateOverrides; entry->templateName; ++entry)
+    {
+        data.templateOverrides[QString::fromUtf8(entry->templateName)].insert(entry->yearLevel, QString::fromUtf8(entry->replacement));
+    }
+
+    for (const int *yearLevel = kYearLevels; *yearLevel; ++yearLevel)
+    {
+        if (*yearLevel > 0 && !data.yearLevels.contains(*yearLevel))
+        {
+            data.yearLevels.append(*yearLevel);
+        }
+    }
+    std::sort(data.yearLevels.begin(), data.yearLevels.end());
+
+    return data;
+}
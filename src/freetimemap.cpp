@@ -0,0 +1,299 @@
+#include "freetimemap.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+namespace
+{
+constexpr qint64 kSlotMsecs = qint64(FreeTimeMap::kSlotMinutes) * 60 * 1000;
+constexpr int kMinutesPerDay = 24 * 60;
+
+// Bit i of the result is bit i + shift of words.
+FreeTimeMap::DayWords shiftedDown(const FreeTimeMap::DayWords &words, int shift)
+{
+    FreeTimeMap::DayWords result{};
+    const int wordShift = shift / 64;
+    const int bitShift = shift % 64;
+    for (int w = 0; w + wordShift < FreeTimeMap::kWordsPerDay; ++w)
+    {
+        const int source = w + wordShift;
+        quint64 value = words[source] >> bitShift;
+        if (bitShift != 0 && source + 1 < FreeTimeMap::kWordsPerDay)
+        {
+            value |= words[source + 1] << (64 - bitShift);
+        }
+        result[w] = value;
+    }
+    return result;
+}
+
+int nextSet(const FreeTimeMap::DayWords &words, int from)
+{
+    for (int w = from / 64; w < FreeTimeMap::kWordsPerDay; ++w)
+    {
+        quint64 value = words[w];
+        if (w == from / 64)
+        {
+            value &= ~quint64(0) << (from % 64);
+        }
+        if (value != 0)
+        {
+            return w * 64 + qCountTrailingZeroBits(value);
+        }
+    }
+    return -1;
+}
+
+FreeTimeMap::DayWords inverted(const FreeTimeMap::DayWords &words)
+{
+    FreeTimeMap::DayWords result;
+    for (int w = 0; w < FreeTimeMap::kWordsPerDay; ++w)
+    {
+        result[w] = ~words[w];
+    }
+    return result;
+}
+}
+
+FreeTimeMap::FreeTimeMap(const QDate &firstDay, int dayCount)
+    : mFirstDay(firstDay)
+    , mDays(std::max(0, dayCount), DayWords{})
+{
+}
+
+const QDate &FreeTimeMap::firstDay() const
+{
+    return mFirstDay;
+}
+
+int FreeTimeMap::dayCount() const
+{
+    return mDays.size();
+}
+
+int FreeTimeMap::slotCount() const
+{
+    return dayCount() * kSlotsPerDay;
+}
+
+void FreeTimeMap::markBusy(int day, int startMinute, int endMinute)
+{
+    if (day < 0 || day >= dayCount())
+    {
+        return;
+    }
+    const int first = std::clamp(startMinute, 0, kMinutesPerDay) / kSlotMinutes;
+    const int last = (std::clamp(endMinute, 0, kMinutesPerDay) + kSlotMinutes - 1) / kSlotMinutes;
+    const DayWords mask = rangeMask(first, last);
+    DayWords &words = mDays[day];
+    for (int w = 0; w < kWordsPerDay; ++w)
+    {
+        words[w] |= mask[w];
+    }
+}
+
+void FreeTimeMap::markBusy(const QDateTime &start, const QDateTime &end)
+{
+    if (!start.isValid() || !end.isValid() || end <= start)
+    {
+        return;
+    }
+    for (QDate date = std::max(start.date(), mFirstDay); date <= end.date(); date = date.addDays(1))
+    {
+        const int day = mFirstDay.daysTo(date);
+        if (day >= dayCount())
+        {
+            break;
+        }
+        const int startMinute = date == start.date() ? start.time().msecsSinceStartOfDay() / 60000 : 0;
+        const int endMinute = date == end.date() ? (end.time().msecsSinceStartOfDay() + 59999) / 60000 : kMinutesPerDay;
+        markBusy(day, startMinute, endMinute);
+    }
+}
+
+void FreeTimeMap::markOutsideHours(int dayStartMinute, int dayEndMinute)
+{
+    for (int day = 0; day < dayCount(); ++day)
+    {
+        markBusy(day, 0, dayStartMinute);
+        markBusy(day, dayEndMinute, kMinutesPerDay);
+    }
+}
+
+void FreeTimeMap::markSchedule(const ScheduleIndex &schedule, const SettingsData &settings)
+{
+    if (schedule.isEmpty())
+    {
+        return;
+    }
+    const int year = schedule.yearIndex(settings.yearLevel);
+    for (int day = 0; day < dayCount(); ++day)
+    {
+        const QDate date = mFirstDay.addDays(day);
+        const int week = schedule.rotationWeekFor(date, settings.currentWeek);
+        const ScheduleIndex::DayRange range = schedule.dayRange(week, date.dayOfWeek(), year);
+        for (int i = range.first; i < range.first + range.count; ++i)
+        {
+            const ScheduledPeriod &period = schedule.period(i);
+            markBusy(day, period.startMinute, period.endMinute);
+        }
+    }
+}
+
+void FreeTimeMap::markActivities(const QVector<Activity> &activities)
+{
+    for (const Activity &activity : activities)
+    {
+        markBusy(activity.startTime(), activity.endTime());
+    }
+}
+
+bool FreeTimeMap::isBusy(int slot) const
+{
+    if (slot < 0 || slot >= slotCount())
+    {
+        return true;
+    }
+    const int bit = slot % kSlotsPerDay;
+    return (mDays.at(slot / kSlotsPerDay)[bit / 64] >> (bit % 64)) & 1;
+}
+
+const FreeTimeMap::DayWords &FreeTimeMap::day(int day) const
+{
+    return mDays.at(day);
+}
+
+int FreeTimeMap::freeSlotCount(int fromSlot, int toSlot) const
+{
+    fromSlot = std::max(fromSlot, 0);
+    toSlot = std::min(toSlot, slotCount());
+    int count = 0;
+    for (int day = fromSlot / kSlotsPerDay; day * kSlotsPerDay < toSlot; ++day)
+    {
+        const int base = day * kSlotsPerDay;
+        const DayWords mask = rangeMask(std::max(fromSlot - base, 0), std::min(toSlot - base, kSlotsPerDay));
+        const DayWords &busy = mDays.at(day);
+        for (int w = 0; w < kWordsPerDay; ++w)
+        {
+            count += qPopulationCount(~busy[w] & mask[w]);
+        }
+    }
+    return count;
+}
+
+int FreeTimeMap::findFree(int length, int fromSlot, int toSlot) const
+{
+    if (length <= 0 || length > kSlotsPerDay)
+    {
+        return -1;
+    }
+    fromSlot = std::max(fromSlot, 0);
+    toSlot = std::min(toSlot, slotCount());
+    for (int day = fromSlot / kSlotsPerDay; day * kSlotsPerDay < toSlot; ++day)
+    {
+        const int base = day * kSlotsPerDay;
+        const DayWords mask = rangeMask(std::max(fromSlot - base, 0), std::min(toSlot - base, kSlotsPerDay));
+        DayWords starts;
+        const DayWords &busy = mDays.at(day);
+        for (int w = 0; w < kWordsPerDay; ++w)
+        {
+            starts[w] = ~busy[w] & mask[w];
+        }
+
+        // After the loop bit i is set only if slots i .. i + covered - 1 are all
+        // free; covered doubles each step, so this takes O(log length) passes.
+        int covered = 1;
+        while (covered < length)
+        {
+            const int step = std::min(covered, length - covered);
+            const DayWords shifted = shiftedDown(starts, step);
+            for (int w = 0; w < kWordsPerDay; ++w)
+            {
+                starts[w] &= shifted[w];
+            }
+            covered += step;
+        }
+
+        const int first = nextSet(starts, 0);
+        if (first >= 0)
+        {
+            return base + first;
+        }
+    }
+    return -1;
+}
+
+QVector<FreeTimeMap::Run> FreeTimeMap::freeRuns(int fromSlot, int toSlot, int minLength) const
+{
+    QVector<Run> runs;
+    fromSlot = std::max(fromSlot, 0);
+    toSlot = std::min(toSlot, slotCount());
+    for (int day = fromSlot / kSlotsPerDay; day * kSlotsPerDay < toSlot; ++day)
+    {
+        const int base = day * kSlotsPerDay;
+        const DayWords mask = rangeMask(std::max(fromSlot - base, 0), std::min(toSlot - base, kSlotsPerDay));
+        DayWords free;
+        const DayWords &busy = mDays.at(day);
+        for (int w = 0; w < kWordsPerDay; ++w)
+        {
+            free[w] = ~busy[w] & mask[w];
+        }
+        const DayWords notFree = inverted(free);
+
+        int start = nextSet(free, 0);
+        while (start >= 0)
+        {
+            // Bits past the day are never free, so a run always ends inside the words.
+            const int end = nextSet(notFree, start);
+            if (end - start >= minLength)
+            {
+                runs.append({base + start, end - start});
+            }
+            start = end < kWordsPerDay * 64 ? nextSet(free, end) : -1;
+        }
+    }
+    return runs;
+}
+
+int FreeTimeMap::slotAt(const QDateTime &time, bool roundUp) const
+{
+    const qint64 day = mFirstDay.daysTo(time.date());
+    if (day < 0)
+    {
+        return 0;
+    }
+    if (day >= dayCount())
+    {
+        return slotCount();
+    }
+    const qint64 msecs = time.time().msecsSinceStartOfDay();
+    int slot = static_cast<int>(msecs / kSlotMsecs);
+    if (roundUp && msecs % kSlotMsecs != 0)
+    {
+        ++slot;
+    }
+    return static_cast<int>(day) * kSlotsPerDay + slot;
+}
+
+QDateTime FreeTimeMap::timeAt(int slot) const
+{
+    return mFirstDay.addDays(slot / kSlotsPerDay).startOfDay().addMSecs((slot % kSlotsPerDay) * kSlotMsecs);
+}
+
+FreeTimeMap::DayWords FreeTimeMap::rangeMask(int fromSlot, int toSlot)
+{
+    DayWords mask{};
+    for (int w = 0; w < kWordsPerDay; ++w)
+    {
+        const int low = std::max(fromSlot - w * 64, 0);
+        const int high = std::min(toSlot - w * 64, 64);
+        if (low >= high)
+        {
+            continue;
+        }
+        const quint64 upper = high == 64 ? ~quint64(0) : (quint64(1) << high) - 1;
+        mask[w] = upper & (~quint64(0) << low);
+    }
+    return mask;
+}
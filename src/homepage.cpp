@@ -1,6 +1,7 @@
 #include "homepage.h"
 
 #include "jsonmanager.h"
+#include "theme.h"
 
 #include <QBoxLayout>
 #include <QButtonGroup>
@@ -12,6 +13,7 @@
 #include <QFormLayout>
 #include <QGraphicsDropShadowEffect>
 #include <QGroupBox>
+#include <QHash>
 #include <QInputDialog>
 #include <QLineEdit>
 #include <QMessageBox>
@@ -28,12 +30,19 @@
 #include <QPropertyAnimation>
 
 #include <algorithm>
+#include <iterator>
 #include <QtMath>
 #include <limits>
 
 namespace
 {
 constexpr int kStandardPadding = 24;
+// Arcs shorter than this, or closer than this to the next arc of the same
+// color, are merged so the dial never strokes sub-pixel segments.
+constexpr double kMinArcPixels = 1.5;
+// Timetable periods are fetched this far past the end of the dial's window.
+constexpr int kPeriodMarginMinutes = 60;
+const QColor kSpecialPeriodColor(224, 224, 224);
 
 bool validateActivityRange(const QDateTime &start, const QDateTime &end)
 {
@@ -65,6 +74,7 @@ public:
         mEndEdit = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(3600), this);
         mEndEdit->setDisplayFormat("yyyy-MM-dd HH:mm");
         mColorButton = new QPushButton(tr("Choose Color"), this);
+        Theme::setRole(mColorButton, "swatch");
 
         form->addRow(tr("Title"), mTitleEdit);
         form->addRow(tr("Description"), mDescriptionEdit);
@@ -101,24 +111,24 @@ public:
 
     void setActivity(const Activity &activity)
     {
-        mActivityId = activity.id;
-        mTitleEdit->setText(activity.title);
-        mDescriptionEdit->setPlainText(activity.description);
-        mStartEdit->setDateTime(activity.startTime);
-        mEndEdit->setDateTime(activity.endTime);
-        mColor = activity.color;
+        mActivityId = activity.id();
+        mTitleEdit->setText(activity.title());
+        mDescriptionEdit->setPlainText(activity.description());
+        mStartEdit->setDateTime(activity.startTime());
+        mEndEdit->setDateTime(activity.endTime());
+        mColor = activity.color();
         updateColorSwatch();
     }
 
     Activity activity() const
     {
         Activity activity;
-        activity.id = mActivityId;
-        activity.title = mTitleEdit->text();
-        activity.description = mDescriptionEdit->toPlainText();
-        activity.startTime = mStartEdit->dateTime();
-        activity.endTime = mEndEdit->dateTime();
-        activity.color = mColor;
+        activity.setId(mActivityId);
+        activity.setTitle(mTitleEdit->text());
+        activity.setDescription(mDescriptionEdit->toPlainText());
+        activity.setStartTime(mStartEdit->dateTime());
+        activity.setEndTime(mEndEdit->dateTime());
+        activity.setColor(mColor);
         return activity;
     }
 
@@ -129,9 +139,7 @@ private:
         {
             mColor = QColor("#4ECDC4");
         }
-        const QString style = QStringLiteral("QPushButton { background-color: %1; border-radius: 6px; padding: 8px; color: %2; }")
-                                  .arg(mColor.name(QColor::HexRgb), mColor.lightness() < 140 ? QStringLiteral("white") : QStringLiteral("black"));
-        mColorButton->setStyleSheet(style);
+        mColorButton->setIcon(Theme::swatch(mColor));
     }
 
     QString mActivityId;
@@ -147,7 +155,7 @@ QVector<Activity> sortActivities(const QVector<Activity> &activities)
 {
     QVector<Activity> sorted = activities;
     std::sort(sorted.begin(), sorted.end(), [](const Activity &a, const Activity &b) {
-        return a.startTime < b.startTime;
+        return a.startTime() < b.startTime();
     });
     return sorted;
 }
@@ -164,23 +172,44 @@ void HomePage::setJsonManager(JsonManager *manager)
     mJsonManager = manager;
 }
 
+void HomePage::setSearch(const SearchIndex *index, TaskScheduler *scheduler)
+{
+    mSearchField->setSearch(index, scheduler, SearchIndex::ActivityKind, 0);
+}
+
+void HomePage::refreshSearch()
+{
+    mSearchField->refresh();
+}
+
+void HomePage::setFocusTasks(const QVector<UrgencyRanker::Entry> &entries)
+{
+    mFocusPanel->setEntries(entries);
+}
+
 void HomePage::setActivities(const QVector<Activity> &activities)
 {
     mActivities = sortActivities(activities);
     mActivitiesWidget->setActivities(mActivities);
-    refreshDonut();
+    mDonutChart->setActivities(mActivities);
 }
 
-void HomePage::setSchoolPeriods(const SchoolPeriodsData &data)
+void HomePage::setSchedule(const ScheduleIndex &schedule)
 {
-    mSchoolPeriods = data;
-    refreshDonut();
+    mSchedule = schedule;
 }
 
 void HomePage::setSettings(const SettingsData &settings)
 {
     mSettings = settings;
-    refreshDonut();
+}
+
+void HomePage::refreshPeriods()
+{
+    // Fetch a margin past the window so the dial can advance before refetching.
+    const QDateTime from = QDateTime::currentDateTime();
+    const QDateTime to = from.addSecs((mDonutChart->windowMinutes() + kPeriodMarginMinutes) * 60);
+    mDonutChart->setPeriods(mSchedule.periodsBetween(from, to, mSettings), to);
 }
 
 void HomePage::createLayout()
@@ -192,13 +221,19 @@ void HomePage::createLayout()
     auto *leftColumn = new QVBoxLayout();
     leftColumn->setSpacing(16);
 
+    mFocusPanel = new FocusPanel(this);
+    leftColumn->addWidget(mFocusPanel);
+
+    mSearchField = new SearchField(this);
+    mSearchField->setPlaceholderText(tr("Search activities"));
+    leftColumn->addWidget(mSearchField);
+
     mActivitiesWidget = new ActivitiesWidget(this);
     leftColumn->addWidget(mActivitiesWidget);
     leftColumn->addStretch(1);
 
     auto *donutContainer = new QFrame(this);
     donutContainer->setObjectName(QStringLiteral("DonutContainer"));
-    donutContainer->setStyleSheet(QStringLiteral("#DonutContainer { background: #FFFFFF; border: 1px solid #E0E0E0; border-radius: 16px; }") );
 
     auto *donutLayout = new QVBoxLayout(donutContainer);
     donutLayout->setContentsMargins(24, 24, 24, 24);
@@ -228,8 +263,7 @@ void HomePage::createLayout()
         auto *button = new QPushButton(mode.label, donutContainer);
         button->setCheckable(true);
         button->setCursor(Qt::PointingHandCursor);
-        button->setStyleSheet(QStringLiteral("QPushButton { padding: 8px 16px; border-radius: 16px; border: 1px solid #E0E0E0; background: #FFFFFF; }"
-                                            "QPushButton:checked { background: #000000; color: #FFFFFF; }"));
+        Theme::setRole(button, "toggle");
         modeGroup->addButton(button, index);
         modeLayout->addWidget(button);
         if (index == 0)
@@ -242,6 +276,28 @@ void HomePage::createLayout()
     modeLayout->addStretch(1);
     donutLayout->addLayout(modeLayout);
 
+    auto *windowGroup = new QButtonGroup(this);
+    windowGroup->setExclusive(true);
+
+    auto *windowLayout = new QHBoxLayout();
+    windowLayout->setSpacing(8);
+    windowLayout->addStretch(1);
+
+    const QString windowLabels[] = {tr("6 h"), tr("12 h"), tr("24 h"), tr("7 days")};
+    for (int i = 0; i < int(std::size(DonutChartWidget::kWindowMinutes)); ++i)
+    {
+        auto *button = new QPushButton(windowLabels[i], donutContainer);
+        button->setCheckable(true);
+        button->setCursor(Qt::PointingHandCursor);
+        button->setChecked(DonutChartWidget::kWindowMinutes[i] == mDonutChart->windowMinutes());
+        Theme::setRole(button, "toggle");
+        windowGroup->addButton(button, i);
+        windowLayout->addWidget(button);
+    }
+
+    windowLayout->addStretch(1);
+    donutLayout->addLayout(windowLayout);
+
     mainLayout->addLayout(leftColumn, 2);
     mainLayout->addWidget(donutContainer, 3);
 
@@ -252,12 +308,33 @@ void HomePage::createLayout()
         }
         mDonutChart->setMode(modes[id].mode);
     });
+    connect(windowGroup, &QButtonGroup::idToggled, this, [this](int id, bool checked) {
+        if (!checked)
+        {
+            return;
+        }
+        mDonutChart->setWindowMinutes(DonutChartWidget::kWindowMinutes[id]);
+        refreshPeriods();
+    });
+
+    connect(mFocusPanel, &FocusPanel::taskRequested, this, &HomePage::focusTaskRequested);
+    connect(mDonutChart, &DonutChartWidget::periodsExpired, this, &HomePage::periodsExpired);
+
+    connect(mSearchField, &SearchField::resultsReady, this, [this](const QVector<SearchIndex::Hit> &hits) {
+        QSet<QString> ids;
+        for (const auto &hit : hits)
+        {
+            ids.insert(hit.id);
+        }
+        mActivitiesWidget->setFilter(ids);
+    });
+    connect(mSearchField, &SearchField::cleared, mActivitiesWidget, &ActivitiesWidget::clearFilter);
 
     connect(mActivitiesWidget, &ActivitiesWidget::activityCreated, this, [this](const Activity &activity) {
         Activity withId = activity;
-        if (withId.id.isEmpty())
+        if (withId.id().isEmpty())
         {
-            withId.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+            withId.setId(QUuid::createUuid().toString(QUuid::WithoutBraces));
         }
         mActivities.append(withId);
         setActivities(mActivities);
@@ -272,7 +349,7 @@ void HomePage::createLayout()
             Activity updated = dialog.activity();
             for (auto &item : mActivities)
             {
-                if (item.id == updated.id)
+                if (item.id() == updated.id())
                 {
                     item = updated;
                     break;
@@ -287,7 +364,7 @@ void HomePage::createLayout()
         if (QMessageBox::question(this, tr("Delete Activity"), tr("Are you sure you want to delete this activity?")) == QMessageBox::Yes)
         {
             mActivities.erase(std::remove_if(mActivities.begin(), mActivities.end(), [&](const Activity &activity) {
-                                  return activity.id == activityId;
+                                  return activity.id() == activityId;
                               }),
                               mActivities.end());
             setActivities(mActivities);
@@ -296,24 +373,6 @@ void HomePage::createLayout()
     });
 }
 
-void HomePage::refreshDonut()
-{
-    if (!mDonutChart)
-    {
-        return;
-    }
-
-    mDonutChart->setActivities(mActivities);
-
-    if (mJsonManager)
-    {
-        const QDateTime from = QDateTime::currentDateTime();
-        const QDateTime to = from.addSecs(12 * 3600);
-        const auto periods = mJsonManager->upcomingPeriods(mSettings, from, to);
-        mDonutChart->setPeriods(periods);
-    }
-}
-
 ActivityRowWidget::ActivityRowWidget(const Activity &activity, QWidget *parent)
     : QFrame(parent)
     , mActivity(activity)
@@ -321,7 +380,6 @@ ActivityRowWidget::ActivityRowWidget(const Activity &activity, QWidget *parent)
     setObjectName(QStringLiteral("ActivityRow"));
     setFrameShape(QFrame::NoFrame);
     setCursor(Qt::PointingHandCursor);
-    setStyleSheet(QStringLiteral("#ActivityRow { background: #FFFFFF; border: 1px solid #E0E0E0; border-radius: 12px; }") );
 
     auto *shadow = new QGraphicsDropShadowEffect(this);
     shadow->setBlurRadius(12.0);
@@ -361,6 +419,26 @@ ActivityRowWidget::ActivityRowWidget(const Activity &activity, QWidget *parent)
 
 void ActivityRowWidget::setActivity(const Activity &activity)
 {
+    // Rebinding the same unchanged activity leaves the labels as they are.
+    if (activity.isSharedWith(mActivity))
+    {
+        return;
+    }
+
+    // A pooled row rebound to a different activity starts collapsed.
+    if (activity.id() != mActivity.id() && mExpanded)
+    {
+        mExpanded = false;
+        if (mDetailAnimation)
+        {
+            mDetailAnimation->stop();
+        }
+        if (mDetailContainer)
+        {
+            mDetailContainer->setVisible(false);
+            mDetailContainer->setMaximumHeight(0);
+        }
+    }
     mActivity = activity;
     updateUi();
 }
@@ -411,10 +489,10 @@ void ActivityRowWidget::buildUi()
     headerLayout->setSpacing(8);
 
     mTitleLabel = new QLabel(this);
-    mTitleLabel->setStyleSheet(QStringLiteral("font-weight: bold; font-size: 16px;"));
+    Theme::setRole(mTitleLabel, "rowTitle");
 
     mTimeLabel = new QLabel(this);
-    mTimeLabel->setStyleSheet(QStringLiteral("color: #666666;"));
+    Theme::setRole(mTimeLabel, "secondary");
 
     headerLayout->addWidget(mTitleLabel);
     headerLayout->addStretch(1);
@@ -430,7 +508,7 @@ void ActivityRowWidget::buildUi()
 
     mDescriptionLabel = new QLabel(mDetailContainer);
     mDescriptionLabel->setWordWrap(true);
-    mDescriptionLabel->setStyleSheet(QStringLiteral("color: #888888;"));
+    Theme::setRole(mDescriptionLabel, "muted");
     detailLayout->addWidget(mDescriptionLabel);
 
     auto *buttonLayout = new QHBoxLayout();
@@ -449,16 +527,16 @@ void ActivityRowWidget::buildUi()
         emit editRequested(mActivity);
     });
     connect(mDeleteButton, &QPushButton::clicked, this, [this]() {
-        emit deleteRequested(mActivity.id);
+        emit deleteRequested(mActivity.id());
     });
 }
 
 void ActivityRowWidget::updateUi()
 {
-    mTitleLabel->setText(mActivity.title);
+    mTitleLabel->setText(mActivity.title());
     mTimeLabel->setText(QStringLiteral("%1 - %2")
-                            .arg(mActivity.startTime.toString("HH:mm"), mActivity.endTime.toString("HH:mm")));
-    mDescriptionLabel->setText(mActivity.description);
+                            .arg(mActivity.startTime().toString("HH:mm"), mActivity.endTime().toString("HH:mm")));
+    mDescriptionLabel->setText(mActivity.description());
 }
 
 void ActivityRowWidget::mousePressEvent(QMouseEvent *event)
@@ -477,38 +555,146 @@ void ActivitiesWidget::rebuildUi()
     QLayoutItem *item = nullptr;
     while ((item = mListLayout->takeAt(0)) != nullptr)
     {
-        if (item->widget())
-        {
-            item->widget()->deleteLater();
-        }
         delete item;
     }
+    mRowPool.releaseAll();
 
+    int shown = 0;
     for (const auto &activity : mActivities)
     {
-        auto *row = new ActivityRowWidget(activity, this);
-        connect(row, &ActivityRowWidget::editRequested, this, &ActivitiesWidget::editActivityRequested);
-        connect(row, &ActivityRowWidget::deleteRequested, this, &ActivitiesWidget::deleteActivityRequested);
+        if (mFiltered && !mFilter.contains(activity.id()))
+        {
+            continue;
+        }
+        auto *row = mRowPool.acquire();
+        row->setActivity(activity);
         mListLayout->addWidget(row);
+        ++shown;
     }
 
-    if (mActivities.isEmpty())
+    mEmptyLabel->setText(mFiltered ? tr("No activities match your search.") : tr("No upcoming activities. Click + New Activity to add one."));
+    mEmptyLabel->setVisible(shown == 0);
+    mListLayout->addWidget(mEmptyLabel);
+
+    mListLayout->addStretch(1);
+}
+
+FocusRowWidget::FocusRowWidget(QWidget *parent)
+    : QFrame(parent)
+{
+    setObjectName(QStringLiteral("FocusRow"));
+    setCursor(Qt::PointingHandCursor);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(16, 10, 16, 10);
+    layout->setSpacing(2);
+
+    mTitleLabel = new QLabel(this);
+    Theme::setRole(mTitleLabel, "rowTitle");
+    mDetailLabel = new QLabel(this);
+    Theme::setRole(mDetailLabel, "secondary");
+
+    layout->addWidget(mTitleLabel);
+    layout->addWidget(mDetailLabel);
+}
+
+void FocusRowWidget::setEntry(const UrgencyRanker::Entry &entry)
+{
+    mEntry = entry;
+    mTitleLabel->setText(entry.title);
+    refreshDetail();
+}
+
+void FocusRowWidget::refreshDetail()
+{
+    const QString progress = tr("%1% done").arg(qRound(mEntry.progress));
+    if (mEntry.deadlineSecs == UrgencyRanker::kNoDeadline)
+    {
+        mDetailLabel->setText(tr("No deadline · %1").arg(progress));
+        return;
+    }
+    const QDateTime deadline = QDateTime::fromSecsSinceEpoch(mEntry.deadlineSecs);
+    const QString when = deadline.toString(QStringLiteral("ddd d MMM, HH:mm"));
+    if (deadline < QDateTime::currentDateTime())
     {
-        auto *placeholder = new QLabel(tr("No upcoming activities. Click + New Activity to add one."), this);
-        placeholder->setStyleSheet(QStringLiteral("color: #888888;"));
-        placeholder->setAlignment(Qt::AlignCenter);
-        placeholder->setWordWrap(true);
-        mListLayout->addWidget(placeholder);
+        mDetailLabel->setText(tr("Overdue since %1 · %2").arg(when, progress));
     }
+    else
+    {
+        mDetailLabel->setText(tr("Due %1 · %2").arg(when, progress));
+    }
+}
 
-    mListLayout->addStretch(1);
+void FocusRowWidget::mousePressEvent(QMouseEvent *event)
+{
+    emit clicked(mEntry.taskId);
+    QFrame::mousePressEvent(event);
+}
+
+FocusPanel::FocusPanel(QWidget *parent)
+    : QFrame(parent)
+{
+    setObjectName(QStringLiteral("FocusPanel"));
+
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(24, 24, 24, 24);
+    layout->setSpacing(12);
+
+    auto *title = new QLabel(tr("Focus"), this);
+    Theme::setRole(title, "panelTitle");
+    layout->addWidget(title);
+
+    mEmptyLabel = new QLabel(tr("Nothing urgent. All caught up."), this);
+    Theme::setRole(mEmptyLabel, "muted");
+    layout->addWidget(mEmptyLabel);
+
+    for (int i = 0; i < kRowCount; ++i)
+    {
+        auto *row = new FocusRowWidget(this);
+        row->hide();
+        connect(row, &FocusRowWidget::clicked, this, &FocusPanel::taskRequested);
+        layout->addWidget(row);
+        mRows.append(row);
+    }
+
+    // Rows are only rebound on publish; a deadline passing needs no publish.
+    mMinuteTimer = new QTimer(this);
+    mMinuteTimer->setInterval(60 * 1000);
+    connect(mMinuteTimer, &QTimer::timeout, this, [this]() {
+        for (FocusRowWidget *row : std::as_const(mRows))
+        {
+            if (!row->isHidden())
+            {
+                row->refreshDetail();
+            }
+        }
+    });
+    mMinuteTimer->start();
+}
+
+void FocusPanel::setEntries(const QVector<UrgencyRanker::Entry> &entries)
+{
+    for (int i = 0; i < mRows.size(); ++i)
+    {
+        if (i < entries.size())
+        {
+            mRows.at(i)->setEntry(entries.at(i));
+        }
+        mRows.at(i)->setVisible(i < entries.size());
+    }
+    mEmptyLabel->setVisible(entries.isEmpty());
 }
 
 ActivitiesWidget::ActivitiesWidget(QWidget *parent)
     : QFrame(parent)
+    , mRowPool(QStringLiteral("pool.activityRow"), [this]() {
+        auto *row = new ActivityRowWidget(Activity{}, this);
+        connect(row, &ActivityRowWidget::editRequested, this, &ActivitiesWidget::editActivityRequested);
+        connect(row, &ActivityRowWidget::deleteRequested, this, &ActivitiesWidget::deleteActivityRequested);
+        return row;
+    })
 {
     setObjectName(QStringLiteral("ActivitiesWidget"));
-    setStyleSheet(QStringLiteral("#ActivitiesWidget { background: #FFFFFF; border: 1px solid #E0E0E0; border-radius: 16px; }"));
 
     auto *layout = new QVBoxLayout(this);
     layout->setContentsMargins(24, 24, 24, 24);
@@ -518,11 +704,11 @@ ActivitiesWidget::ActivitiesWidget(QWidget *parent)
     headerLayout->setSpacing(8);
 
     auto *title = new QLabel(tr("Activities"), this);
-    title->setStyleSheet(QStringLiteral("font-size: 20px; font-weight: bold;"));
+    Theme::setRole(title, "panelTitle");
 
     mNewButton = new QPushButton(tr("+ New Activity"), this);
     mNewButton->setCursor(Qt::PointingHandCursor);
-    mNewButton->setStyleSheet(QStringLiteral("QPushButton { background: #000000; color: #FFFFFF; padding: 8px 16px; border-radius: 18px; }"));
+    Theme::setRole(mNewButton, "primary");
 
     headerLayout->addWidget(title);
     headerLayout->addStretch(1);
@@ -539,6 +725,12 @@ ActivitiesWidget::ActivitiesWidget(QWidget *parent)
     listPageLayout->setSpacing(12);
     mListLayout = new QVBoxLayout();
     mListLayout->setSpacing(12);
+
+    mEmptyLabel = new QLabel(tr("No upcoming activities. Click + New Activity to add one."), mListPage);
+    Theme::setRole(mEmptyLabel, "muted");
+    mEmptyLabel->setAlignment(Qt::AlignCenter);
+    mEmptyLabel->setWordWrap(true);
+
     listPageLayout->addLayout(mListLayout);
     listPageLayout->addStretch(1);
     mStack->addWidget(mListPage);
@@ -564,6 +756,7 @@ ActivitiesWidget::ActivitiesWidget(QWidget *parent)
     mEndTimeEdit->setDisplayFormat(QStringLiteral("HH:mm"));
     mColorButton = new QPushButton(tr("Choose Color"), mCreationPage);
     mColorButton->setCursor(Qt::PointingHandCursor);
+    Theme::setRole(mColorButton, "swatch");
 
     form->addRow(tr("Title"), mTitleEdit);
     form->addRow(tr("Description"), mDescriptionEdit);
@@ -578,10 +771,10 @@ ActivitiesWidget::ActivitiesWidget(QWidget *parent)
     buttonRow->addStretch(1);
     auto *saveButton = new QPushButton(tr("Save"), mCreationPage);
     saveButton->setCursor(Qt::PointingHandCursor);
-    saveButton->setStyleSheet(QStringLiteral("QPushButton { background: #000000; color: #FFFFFF; padding: 8px 20px; border-radius: 18px; }"));
+    Theme::setRole(saveButton, "primary");
     auto *cancelButton = new QPushButton(tr("Cancel"), mCreationPage);
     cancelButton->setCursor(Qt::PointingHandCursor);
-    cancelButton->setStyleSheet(QStringLiteral("QPushButton { background: #FFFFFF; border: 1px solid #E0E0E0; padding: 8px 20px; border-radius: 18px; }"));
+    Theme::setRole(cancelButton, "secondary");
     buttonRow->addWidget(cancelButton);
     buttonRow->addWidget(saveButton);
     creationLayout->addLayout(buttonRow);
@@ -630,12 +823,12 @@ ActivitiesWidget::ActivitiesWidget(QWidget *parent)
         }
 
         Activity activity;
-        activity.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        activity.title = title;
-        activity.description = mDescriptionEdit->toPlainText().trimmed();
-        activity.startTime = start;
-        activity.endTime = end;
-        activity.color = mSelectedColor;
+        activity.setId(QUuid::createUuid().toString(QUuid::WithoutBraces));
+        activity.setTitle(title);
+        activity.setDescription(mDescriptionEdit->toPlainText().trimmed());
+        activity.setStartTime(start);
+        activity.setEndTime(end);
+        activity.setColor(mSelectedColor);
 
         emit activityCreated(activity);
         exitCreationMode();
@@ -648,6 +841,20 @@ void ActivitiesWidget::setActivities(const QVector<Activity> &activities)
     rebuildUi();
 }
 
+void ActivitiesWidget::setFilter(const QSet<QString> &activityIds)
+{
+    mFilter = activityIds;
+    mFiltered = true;
+    rebuildUi();
+}
+
+void ActivitiesWidget::clearFilter()
+{
+    mFilter.clear();
+    mFiltered = false;
+    rebuildUi();
+}
+
 void ActivitiesWidget::enterCreationMode()
 {
     resetCreationForm();
@@ -701,11 +908,7 @@ void ActivitiesWidget::updateColorButton()
         return;
     }
 
-    const QString style = QStringLiteral(
-        "QPushButton { padding: 8px 16px; border-radius: 12px; border: 1px solid #E0E0E0; background: %1; color: %2; }")
-                            .arg(mSelectedColor.name(QColor::HexRgb),
-                                 mSelectedColor.lightness() < 140 ? QStringLiteral("#FFFFFF") : QStringLiteral("#000000"));
-    mColorButton->setStyleSheet(style);
+    mColorButton->setIcon(Theme::swatch(mSelectedColor));
 }
 
 DonutChartWidget::DonutChartWidget(QWidget *parent)
@@ -722,14 +925,26 @@ DonutChartWidget::DonutChartWidget(QWidget *parent)
 void DonutChartWidget::setActivities(const QVector<Activity> &activities)
 {
     mActivities = activities;
-    rebuildArcs();
+    std::stable_sort(mActivities.begin(), mActivities.end(), [](const Activity &a, const Activity &b) {
+        return a.startTime() < b.startTime();
+    });
+    mActivityMaxEnd.resize(mActivities.size());
+    qint64 maxEnd = std::numeric_limits<qint64>::min();
+    for (int i = 0; i < mActivities.size(); ++i)
+    {
+        maxEnd = std::max(maxEnd, mActivities.at(i).endTime().toMSecsSinceEpoch());
+        mActivityMaxEnd[i] = maxEnd;
+    }
+    rebuildActivityArcs();
     update();
 }
 
-void DonutChartWidget::setPeriods(const QVector<TimetablePeriod> &periods)
+void DonutChartWidget::setPeriods(const QVector<TimetablePeriod> &periods, const QDateTime &until)
 {
     mPeriods = periods;
-    rebuildArcs();
+    mPeriodsUntil = until;
+    mPeriodsExpired = false;
+    rebuildPeriodArcs();
     update();
 }
 
@@ -743,6 +958,23 @@ void DonutChartWidget::setMode(Mode mode)
     update();
 }
 
+void DonutChartWidget::setWindowMinutes(int minutes)
+{
+    if (mWindowMinutes == minutes || minutes <= 0)
+    {
+        return;
+    }
+    mWindowMinutes = minutes;
+    rebuildActivityArcs();
+    rebuildPeriodArcs();
+    update();
+}
+
+int DonutChartWidget::windowMinutes() const
+{
+    return mWindowMinutes;
+}
+
 void DonutChartWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
@@ -764,23 +996,33 @@ void DonutChartWidget::paintEvent(QPaintEvent *event)
 void DonutChartWidget::updateClock()
 {
     mNow = QDateTime::currentDateTime();
-    rebuildArcs();
+    rebuildActivityArcs();
+    rebuildPeriodArcs();
     update();
+
+    if (!mPeriodsExpired && mPeriodsUntil.isValid() && mNow.addSecs(mWindowMinutes * 60) >= mPeriodsUntil)
+    {
+        mPeriodsExpired = true;
+        emit periodsExpired();
+    }
 }
 
-void DonutChartWidget::rebuildArcs()
+void DonutChartWidget::rebuildActivityArcs()
 {
     if (!mNow.isValid())
     {
         mNow = QDateTime::currentDateTime();
     }
-    const QDateTime windowEnd = mNow.addSecs(12 * 3600);
+    const QDateTime windowEnd = mNow.addSecs(mWindowMinutes * 60);
 
     mActivityArcs.clear();
-    for (const auto &activity : mActivities)
+    // Everything before first has ended; scanning stops at the first start past the window.
+    const int first = std::upper_bound(mActivityMaxEnd.cbegin(), mActivityMaxEnd.cend(), mNow.toMSecsSinceEpoch()) - mActivityMaxEnd.cbegin();
+    for (int i = first; i < mActivities.size() && mActivities.at(i).startTime() < windowEnd; ++i)
     {
-        const auto start = std::max(activity.startTime, mNow);
-        const auto end = std::min(activity.endTime, windowEnd);
+        const auto &activity = mActivities.at(i);
+        const auto start = std::max(activity.startTime(), mNow);
+        const auto end = std::min(activity.endTime(), windowEnd);
         if (end <= start)
         {
             continue;
@@ -788,11 +1030,20 @@ void DonutChartWidget::rebuildArcs()
         DonutArc arc;
         arc.startTime = start;
         arc.endTime = end;
-        arc.color = activity.color;
-        arc.label = activity.title;
+        arc.color = activity.color();
+        arc.label = activity.title();
         arc.category = QStringLiteral("Activity");
         mActivityArcs.append(arc);
     }
+}
+
+void DonutChartWidget::rebuildPeriodArcs()
+{
+    if (!mNow.isValid())
+    {
+        mNow = QDateTime::currentDateTime();
+    }
+    const QDateTime windowEnd = mNow.addSecs(mWindowMinutes * 60);
 
     mPeriodArcs.clear();
     for (const auto &period : mPeriods)
@@ -806,8 +1057,16 @@ void DonutChartWidget::rebuildArcs()
         DonutArc arc;
         arc.startTime = start;
         arc.endTime = end;
-        arc.color = period.color.isValid() ? period.color : QColor("#E0E0E0");
-        arc.label = period.subjectName;
+        if (period.isSpecial)
+        {
+            arc.color = kSpecialPeriodColor;
+            arc.label = period.subjectName.toUpper();
+        }
+        else
+        {
+            arc.color = period.color.isValid() ? period.color : QColor("#E0E0E0");
+            arc.label = period.subjectName;
+        }
         arc.category = QStringLiteral("Timetable");
         mPeriodArcs.append(arc);
     }
@@ -831,16 +1090,13 @@ void DonutChartWidget::drawArcs(QPainter &painter, const QRectF &outerRect, cons
         QPen pen;
         pen.setCapStyle(Qt::FlatCap);
         pen.setWidthF(bandThickness * widthFactor);
-        for (const auto &arc : arcs)
+        painter.setBrush(Qt::NoBrush);
+        const QRectF arcRect = outerRect.adjusted(inset, inset, -inset, -inset);
+        for (const ArcBatch &batch : batchArcs(arcs, arcRect))
         {
-            pen.setColor(arc.color);
+            pen.setColor(batch.color);
             painter.setPen(pen);
-            const QRectF arcRect = outerRect.adjusted(inset, inset, -inset, -inset);
-            const double startMinutes = mNow.secsTo(arc.startTime) / 60.0;
-            const double spanMinutes = arc.startTime.secsTo(arc.endTime) / 60.0;
-            const double startAngle = minutesToAngle(startMinutes);
-            const double spanAngle = spanMinutes / 720.0 * 360.0;
-            painter.drawArc(arcRect, static_cast<int>(startAngle * 16), static_cast<int>(-spanAngle * 16));
+            painter.drawPath(batch.path);
         }
     };
 
@@ -917,18 +1173,83 @@ void DonutChartWidget::drawLabels(QPainter &painter, const QRectF &outerRect) co
     const QPointF center = outerRect.center();
     const double radius = outerRect.width() / 2.0 + 24;
 
-    for (int i = 0; i <= 12; ++i)
+    // Hourly labels up to 12 h, every two hours for a day, daily beyond that.
+    const bool days = mWindowMinutes > 24 * 60;
+    const int stepMinutes = days ? 24 * 60 : (mWindowMinutes > 12 * 60 ? 120 : 60);
+    for (int minutes = 0; minutes <= mWindowMinutes; minutes += stepMinutes)
     {
-        const double minutes = i * 60.0;
         const double angle = minutesToAngle(minutes);
         const double radians = qDegreesToRadians(angle);
         const QPointF pos(center.x() + radius * std::cos(radians), center.y() + radius * std::sin(radians));
-        const QDateTime labelTime = mNow.addSecs(static_cast<qint64>(minutes * 60));
-        painter.drawText(QRectF(pos.x() - 20, pos.y() - 10, 40, 20), Qt::AlignCenter, labelTime.toString("HH"));
+        const QDateTime labelTime = mNow.addSecs(static_cast<qint64>(minutes) * 60);
+        painter.drawText(QRectF(pos.x() - 20, pos.y() - 10, 40, 20), Qt::AlignCenter, labelTime.toString(days ? "ddd" : "HH"));
+    }
+}
+
+QVector<DonutChartWidget::ArcBatch> DonutChartWidget::batchArcs(const QVector<DonutArc> &arcs, const QRectF &arcRect) const
+{
+    struct Span
+    {
+        double start;
+        double end;
+    };
+
+    // Group by color, keeping the order in which colors first appear.
+    QVector<QColor> colors;
+    QHash<QRgb, QVector<Span>> spans;
+    for (const auto &arc : arcs)
+    {
+        auto it = spans.find(arc.color.rgba());
+        if (it == spans.end())
+        {
+            colors.append(arc.color);
+            it = spans.insert(arc.color.rgba(), {});
+        }
+        it->append({mNow.msecsTo(arc.startTime) / 60000.0, mNow.msecsTo(arc.endTime) / 60000.0});
+    }
+
+    const double pixelsPerMinute = M_PI * arcRect.width() / mWindowMinutes;
+    const double threshold = pixelsPerMinute > 0.0 ? kMinArcPixels / pixelsPerMinute : 0.0;
+
+    QVector<ArcBatch> batches;
+    batches.reserve(colors.size());
+    for (const QColor &color : colors)
+    {
+        QVector<Span> &list = spans[color.rgba()];
+        std::sort(list.begin(), list.end(), [](const Span &a, const Span &b) {
+            return a.start < b.start;
+        });
+
+        ArcBatch batch{color, QPainterPath()};
+        const auto addArc = [&](const Span &span) {
+            const double startAngle = minutesToAngle(span.start);
+            batch.path.arcMoveTo(arcRect, startAngle);
+            batch.path.arcTo(arcRect, startAngle, -(span.end - span.start) / mWindowMinutes * 360.0);
+        };
+
+        // Sub-pixel arcs are widened to the threshold, and arcs touching or
+        // within the threshold of each other become one.
+        Span current = list.first();
+        current.end = std::max(current.end, current.start + threshold);
+        for (int i = 1; i < list.size(); ++i)
+        {
+            Span next = list.at(i);
+            next.end = std::max(next.end, next.start + threshold);
+            if (next.start - current.end <= threshold)
+            {
+                current.end = std::max(current.end, next.end);
+                continue;
+            }
+            addArc(current);
+            current = next;
+        }
+        addArc(current);
+        batches.append(batch);
     }
+    return batches;
 }
 
 double DonutChartWidget::minutesToAngle(double minutes) const
 {
-    return -90.0 + (minutes / 720.0) * 360.0;
+    return -90.0 + (minutes / mWindowMinutes) * 360.0;
 }
@@ -1,26 +1,42 @@
 #include "jsonmanager.h"
+#include "defaultschoolperiods.h"
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QUuid>
 
+#include <algorithm>
+
 namespace
 {
 constexpr char kActivitiesFile[] = "activities.json";
 constexpr char kTasksFile[] = "tasks.json";
 constexpr char kSettingsFile[] = "settings.json";
 constexpr char kSchoolPeriodsFile[] = "SchoolPeriods.json";
+constexpr char kScheduleCacheFile[] = "schedule.cache";
 
 constexpr char kActivitiesDefault[] = ":/defaults/activities.json";
 constexpr char kTasksDefault[] = ":/defaults/tasks.json";
 constexpr char kSettingsDefault[] = ":/defaults/settings.json";
 constexpr char kSchoolPeriodsDefault[] = ":/defaults/SchoolPeriods.json";
 
+constexpr quint32 kScheduleCacheMagic = 0x54434943; // "TCIC"
+constexpr quint32 kScheduleCacheVersion = 1;
+
+QByteArray sha256Hex(const QByteArray &contents)
+{
+    return QCryptographicHash::hash(contents, QCryptographicHash::Sha256).toHex();
+}
+
 QDateTime parseIsoDateTime(const QString &value)
 {
     return QDateTime::fromString(value, Qt::ISODate);
@@ -98,20 +114,11 @@ QVector<Activity> JsonManager::loadActivities() const
 {
     const QString path = ensureFile(kActivitiesFile, kActivitiesDefault);
     QFile file(path);
-    QVector<Activity> items;
     if (!file.open(QIODevice::ReadOnly))
     {
-        return items;
+        return {};
     }
-
-    const auto doc = QJsonDocument::fromJson(file.readAll());
-    const auto root = doc.object();
-    const auto array = root.value("activities").toArray();
-    for (const QJsonValue &value : array)
-    {
-        items.append(activityFromJson(value.toObject()));
-    }
-    return items;
+    return parseActivities(file.readAll());
 }
 
 void JsonManager::saveActivities(const QVector<Activity> &activities) const
@@ -178,17 +185,11 @@ SettingsData JsonManager::loadSettings() const
 {
     const QString path = ensureFile(kSettingsFile, kSettingsDefault);
     QFile file(path);
-    SettingsData settings;
     if (!file.open(QIODevice::ReadOnly))
     {
-        return settings;
+        return SettingsData{};
     }
-
-    const auto doc = QJsonDocument::fromJson(file.readAll());
-    const auto root = doc.object();
-    settings.currentWeek = root.value("current_week").toString(settings.currentWeek);
-    settings.yearLevel = root.value("year_level").toInt(settings.yearLevel);
-    return settings;
+    return parseSettings(file.readAll());
 }
 
 void JsonManager::saveSettings(const SettingsData &settings) const
@@ -215,167 +216,188 @@ SchoolPeriodsData JsonManager::loadSchoolPeriods() const
         return SchoolPeriodsData{};
     }
 
-    const auto doc = QJsonDocument::fromJson(file.readAll());
-    return parseSchoolPeriods(doc);
+    const QByteArray contents = file.readAll();
+    return schoolPeriodsFrom(contents, sha256Hex(contents));
 }
 
-QVector<TimetablePeriod> JsonManager::upcomingPeriods(const SettingsData &settings, const QDateTime &from, const QDateTime &to) const
+ScheduleIndex JsonManager::loadScheduleIndex() const
 {
-    QVector<TimetablePeriod> result;
-    const auto data = loadSchoolPeriods();
-
-    QDateTime cursor = from;
-    while (cursor < to)
+    const QString path = ensureFile(kSchoolPeriodsFile, kSchoolPeriodsDefault);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
     {
-        const QString weekKey = settings.currentWeek.toUpper();
-        if (!data.weeks.contains(weekKey))
-        {
-            break;
-        }
-
-        const WeekSchedule &week = data.weeks.value(weekKey);
-        const QString dayName = cursor.date().toString("dddd");
-        if (!week.days.contains(dayName))
-        {
-            cursor = cursor.addDays(1).setTime(QTime(0, 0));
-            continue;
-        }
+        return ScheduleIndex::compile(SchoolPeriodsData{});
+    }
 
-        const DaySchedule &day = week.days.value(dayName);
-        if (!data.templates.contains(day.templateName))
-        {
-            cursor = cursor.addDays(1).setTime(QTime(0, 0));
-            continue;
-        }
+    const QByteArray contents = file.readAll();
+    const QByteArray sourceHash = sha256Hex(contents);
 
-        const TimetableTemplate &templ = data.templates.value(day.templateName);
-        QMap<QString, TimetableSubjectSlot> slotLookup;
-        for (const auto &slot : day.slots)
-        {
-            slotLookup.insert(slot.periodKey, slot);
-        }
+    ScheduleIndex index;
+    if (readScheduleCache(sourceHash, index))
+    {
+        return index;
+    }
 
-        for (const auto &period : templ.periods)
-        {
-            const QDateTime start(cursor.date(), period.start);
-            const QDateTime end(cursor.date(), period.end);
-            if (end <= from || start >= to)
-            {
-                continue;
-            }
+    index = ScheduleIndex::compile(schoolPeriodsFrom(contents, sourceHash));
+    writeScheduleCache(sourceHash, index);
+    return index;
+}
 
-            TimetablePeriod ttPeriod;
-            ttPeriod.startTime = start;
-            ttPeriod.endTime = end;
-            ttPeriod.periodKey = period.label;
-            ttPeriod.isSpecial = !slotLookup.contains(period.label);
+bool JsonManager::isDataDirectory(const QString &directory)
+{
+    const QDir dir(directory);
+    return dir.exists(kSettingsFile) || dir.exists(kSchoolPeriodsFile);
+}
 
-            if (slotLookup.contains(period.label))
-            {
-                const auto slot = slotLookup.value(period.label);
-                ttPeriod.subjectName = slot.subjectName;
-                ttPeriod.room = slot.room;
-                const auto subject = data.subjects.value(slot.subjectName);
-                ttPeriod.teacher = subject.teacher;
-                ttPeriod.color = subject.color;
-            }
-            else
+QVector<ProfileData> JsonManager::loadProfiles(const QStringList &directories) const
+{
+    const auto readFile = [](const QString &path) {
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+
+    QByteArray defaultPeriods;
+    QHash<QByteArray, ScheduleIndex> compiled;
+    QVector<ProfileData> profiles;
+    profiles.reserve(directories.size());
+    for (const QString &directory : directories)
+    {
+        const QDir dir(directory);
+        ProfileData profile;
+        profile.name = dir.dirName();
+        profile.directory = dir.absolutePath();
+        profile.settings = parseSettings(readFile(dir.filePath(kSettingsFile)));
+        profile.activities = parseActivities(readFile(dir.filePath(kActivitiesFile)));
+
+        // A directory without its own SchoolPeriods.json follows the bundled default.
+        QByteArray periods = readFile(dir.filePath(kSchoolPeriodsFile));
+        if (periods.isEmpty())
+        {
+            if (defaultPeriods.isEmpty())
             {
-                ttPeriod.subjectName = period.label.toUpper();
-                ttPeriod.room = {};
-                ttPeriod.teacher = {};
-                ttPeriod.color = QColor(224, 224, 224);
+                defaultPeriods = readFile(kSchoolPeriodsDefault);
             }
-
-            result.append(ttPeriod);
+            periods = defaultPeriods;
         }
-
-        cursor = cursor.addDays(1).setTime(QTime(0, 0));
+        const QByteArray hash = sha256Hex(periods);
+        auto it = compiled.find(hash);
+        if (it == compiled.end())
+        {
+            it = compiled.insert(hash, ScheduleIndex::compile(schoolPeriodsFrom(periods, hash)));
+        }
+        profile.schedule = *it;
+        profiles.append(profile);
     }
+    return profiles;
+}
 
-    std::sort(result.begin(), result.end(), [](const TimetablePeriod &a, const TimetablePeriod &b) {
-        return a.startTime < b.startTime;
-    });
-
-    return result;
+QVector<TimetablePeriod> JsonManager::upcomingPeriods(const SettingsData &settings, const QDateTime &from, const QDateTime &to) const
+{
+    return loadScheduleIndex().periodsBetween(from, to, settings);
 }
 
 Activity JsonManager::activityFromJson(const QJsonObject &obj) const
 {
     Activity activity;
-    activity.id = obj.value("id").toString(QUuid::createUuid().toString(QUuid::WithoutBraces));
-    activity.title = obj.value("title").toString();
-    activity.description = obj.value("description").toString();
-    activity.startTime = parseIsoDateTime(obj.value("start_time").toString());
-    activity.endTime = parseIsoDateTime(obj.value("end_time").toString());
-    activity.color = QColor(obj.value("color").toString("#4ECDC4"));
+    activity.setId(obj.value("id").toString(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    activity.setTitle(obj.value("title").toString());
+    activity.setDescription(obj.value("description").toString());
+    activity.setStartTime(parseIsoDateTime(obj.value("start_time").toString()));
+    activity.setEndTime(parseIsoDateTime(obj.value("end_time").toString()));
+    activity.setColor(QColor(obj.value("color").toString("#4ECDC4")));
     return activity;
 }
 
+QVector<Activity> JsonManager::parseActivities(const QByteArray &contents) const
+{
+    QVector<Activity> items;
+    const auto doc = QJsonDocument::fromJson(contents);
+    const auto root = doc.object();
+    const auto array = root.value("activities").toArray();
+    for (const QJsonValue &value : array)
+    {
+        items.append(activityFromJson(value.toObject()));
+    }
+    return items;
+}
+
+SettingsData JsonManager::parseSettings(const QByteArray &contents) const
+{
+    SettingsData settings;
+    const auto doc = QJsonDocument::fromJson(contents);
+    const auto root = doc.object();
+    settings.currentWeek = root.value("current_week").toString(settings.currentWeek);
+    settings.yearLevel = root.value("year_level").toInt(settings.yearLevel);
+    return settings;
+}
+
 QJsonObject JsonManager::activityToJson(const Activity &activity) const
 {
     QJsonObject obj;
-    obj.insert("id", activity.id);
-    obj.insert("title", activity.title);
-    obj.insert("description", activity.description);
-    obj.insert("start_time", toIsoString(activity.startTime));
-    obj.insert("end_time", toIsoString(activity.endTime));
-    obj.insert("color", activity.color.name(QColor::HexRgb));
+    obj.insert("id", activity.id());
+    obj.insert("title", activity.title());
+    obj.insert("description", activity.description());
+    obj.insert("start_time", toIsoString(activity.startTime()));
+    obj.insert("end_time", toIsoString(activity.endTime()));
+    obj.insert("color", activity.color().name(QColor::HexRgb));
     return obj;
 }
 
 Subtask JsonManager::subtaskFromJson(const QJsonObject &obj) const
 {
     Subtask subtask;
-    subtask.id = obj.value("id").toString(QUuid::createUuid().toString(QUuid::WithoutBraces));
-    subtask.title = obj.value("title").toString();
-    subtask.description = obj.value("description").toString();
-    subtask.dueTime = parseIsoDateTime(obj.value("due_time").toString());
-    subtask.weighting = obj.value("weighting").toDouble(1.0);
-    subtask.completed = obj.value("completed").toBool(false);
+    subtask.setId(obj.value("id").toString(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    subtask.setTitle(obj.value("title").toString());
+    subtask.setDescription(obj.value("description").toString());
+    subtask.setDueTime(parseIsoDateTime(obj.value("due_time").toString()));
+    subtask.setWeighting(obj.value("weighting").toDouble(1.0));
+    subtask.setCompleted(obj.value("completed").toBool(false));
     return subtask;
 }
 
 QJsonObject JsonManager::subtaskToJson(const Subtask &subtask) const
 {
     QJsonObject obj;
-    obj.insert("id", subtask.id);
-    obj.insert("title", subtask.title);
-    obj.insert("description", subtask.description);
-    obj.insert("due_time", toIsoString(subtask.dueTime));
-    obj.insert("weighting", subtask.weighting);
-    obj.insert("completed", subtask.completed);
+    obj.insert("id", subtask.id());
+    obj.insert("title", subtask.title());
+    obj.insert("description", subtask.description());
+    obj.insert("due_time", toIsoString(subtask.dueTime()));
+    obj.insert("weighting", subtask.weighting());
+    obj.insert("completed", subtask.isCompleted());
     return obj;
 }
 
 Task JsonManager::taskFromJson(const QJsonObject &obj) const
 {
     Task task;
-    task.id = obj.value("id").toString(QUuid::createUuid().toString(QUuid::WithoutBraces));
-    task.title = obj.value("title").toString();
-    task.description = obj.value("description").toString();
-    task.startTime = parseIsoDateTime(obj.value("start_time").toString());
-    task.endTime = parseIsoDateTime(obj.value("end_time").toString());
+    task.setId(obj.value("id").toString(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    task.setTitle(obj.value("title").toString());
+    task.setDescription(obj.value("description").toString());
+    task.setStartTime(parseIsoDateTime(obj.value("start_time").toString()));
+    task.setEndTime(parseIsoDateTime(obj.value("end_time").toString()));
 
     const auto subtasksArray = obj.value("subtasks").toArray();
+    QVector<Subtask> subtasks;
+    subtasks.reserve(subtasksArray.size());
     for (const QJsonValue &value : subtasksArray)
     {
-        task.subtasks.append(subtaskFromJson(value.toObject()));
+        subtasks.append(subtaskFromJson(value.toObject()));
     }
+    task.setSubtasks(subtasks);
     return task;
 }
 
 QJsonObject JsonManager::taskToJson(const Task &task) const
 {
     QJsonObject obj;
-    obj.insert("id", task.id);
-    obj.insert("title", task.title);
-    obj.insert("description", task.description);
-    obj.insert("start_time", toIsoString(task.startTime));
-    obj.insert("end_time", toIsoString(task.endTime));
+    obj.insert("id", task.id());
+    obj.insert("title", task.title());
+    obj.insert("description", task.description());
+    obj.insert("start_time", toIsoString(task.startTime()));
+    obj.insert("end_time", toIsoString(task.endTime()));
 
     QJsonArray subtasksArray;
-    for (const auto &subtask : task.subtasks)
+    for (const auto &subtask : task.subtasks())
     {
         subtasksArray.append(subtaskToJson(subtask));
     }
@@ -383,6 +405,60 @@ QJsonObject JsonManager::taskToJson(const Task &task) const
     return obj;
 }
 
+SchoolPeriodsData JsonManager::schoolPeriodsFrom(const QByteArray &contents, const QByteArray &sourceHash) const
+{
+    if (sourceHash == defaultSchoolPeriodsHash())
+    {
+        return defaultSchoolPeriods();
+    }
+    return parseSchoolPeriods(QJsonDocument::fromJson(contents));
+}
+
+// The cache is only trusted when magic, format versions and source hash all match;
+// anything else falls back to a full parse and compile, which rewrites it.
+bool JsonManager::readScheduleCache(const QByteArray &sourceHash, ScheduleIndex &index) const
+{
+    QFile file(resolveDataDirectory() + QDir::separator() + kScheduleCacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 cacheVersion = 0;
+    quint32 streamVersion = 0;
+    QByteArray cachedHash;
+    in >> magic >> cacheVersion >> streamVersion >> cachedHash;
+    if (in.status() != QDataStream::Ok || magic != kScheduleCacheMagic || cacheVersion != kScheduleCacheVersion
+        || streamVersion != ScheduleIndex::kStreamVersion || cachedHash != sourceHash)
+    {
+        return false;
+    }
+
+    in >> index;
+    return in.status() == QDataStream::Ok;
+}
+
+void JsonManager::writeScheduleCache(const QByteArray &sourceHash, const ScheduleIndex &index) const
+{
+    QSaveFile file(resolveDataDirectory() + QDir::separator() + kScheduleCacheFile);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kScheduleCacheMagic << kScheduleCacheVersion << ScheduleIndex::kStreamVersion << sourceHash << index;
+    if (out.status() == QDataStream::Ok)
+    {
+        file.commit();
+    }
+}
+
 SchoolPeriodsData JsonManager::parseSchoolPeriods(const QJsonDocument &doc) const
 {
     SchoolPeriodsData data;
@@ -455,5 +531,105 @@ SchoolPeriodsData JsonManager::parseSchoolPeriods(const QJsonDocument &doc) cons
         data.weeks.insert(week.name.toUpper(), week);
     }
 
+    for (const QJsonValue &value : root.value("rotation").toArray())
+    {
+        const QString week = value.toString().toUpper();
+        if (data.weeks.contains(week))
+        {
+            data.rotation.append(week);
+        }
+    }
+    if (data.rotation.isEmpty())
+    {
+        data.rotation = data.weeks.keys();
+    }
+
+    for (const QJsonValue &value : root.value("days").toArray())
+    {
+        const int dayOfWeek = ScheduleIndex::dayOfWeek(value.toString());
+        if (dayOfWeek > 0 && !data.days.contains(dayOfWeek))
+        {
+            data.days.append(dayOfWeek);
+        }
+    }
+    if (data.days.isEmpty())
+    {
+        for (int dayOfWeek = 1; dayOfWeek <= 7; ++dayOfWeek)
+        {
+            const QString name = ScheduleIndex::dayName(dayOfWeek);
+            const bool scheduled = std::any_of(data.weeks.cbegin(), data.weeks.cend(), [&](const WeekSchedule &week) {
+                return week.days.contains(name);
+            });
+            if (scheduled)
+            {
+                data.days.append(dayOfWeek);
+            }
+        }
+    }
+
+    const auto overridesObj = root.value("template_overrides").toObject();
+    for (auto it = overridesObj.begin(); it != overridesObj.end(); ++it)
+    {
+        const auto byYear = it.value().toObject();
+        for (auto yit = byYear.begin(); yit != byYear.end(); ++yit)
+        {
+            bool ok = false;
+            const int yearLevel = yit.key().toInt(&ok);
+            if (ok)
+            {
+                data.templateOverrides[it.key()].insert(yearLevel, yit.value().toString());
+            }
+        }
+    }
+
+    for (const QJsonValue &value : root.value("year_levels").toArray())
+    {
+        const int yearLevel = value.toInt();
+        if (yearLevel > 0 && !data.yearLevels.contains(yearLevel))
+        {
+            data.yearLevels.append(yearLevel);
+        }
+    }
+    if (data.yearLevels.isEmpty())
+    {
+        for (const auto &byYear : data.templateOverrides)
+        {
+            for (auto it = byYear.cbegin(); it != byYear.cend(); ++it)
+            {
+                if (!data.yearLevels.contains(it.key()))
+                {
+                    data.yearLevels.append(it.key());
+                }
+            }
+        }
+    }
+    if (data.yearLevels.isEmpty())
+    {
+        data.yearLevels = {10, 11};
+    }
+    std::sort(data.yearLevels.begin(), data.yearLevels.end());
+
+    // Files written before year-level overrides were declarative relied on any day
+    // whose template mentions "wednesday" using the year 11 variant from year 11 up
+    // and the year 10 variant below that.
+    if (!root.contains("template_overrides"))
+    {
+        for (const auto &week : data.weeks)
+        {
+            for (const auto &day : week.days)
+            {
+                if (!day.templateName.contains(QStringLiteral("wednesday"), Qt::CaseInsensitive))
+                {
+                    continue;
+                }
+                for (const int yearLevel : data.yearLevels)
+                {
+                    data.templateOverrides[day.templateName].insert(
+                        yearLevel, yearLevel >= 11 ? QStringLiteral("wednesday_year11") : QStringLiteral("wednesday_year10"));
+                }
+            }
+        }
+    }
+
     return data;
 }
@@ -1,7 +1,9 @@
 #include "mainwindow.h"
+#include "metrics.h"
+#include "theme.h"
 
 #include <QApplication>
-#include <QFile>
+#include <QDebug>
 #include <QFontDatabase>
 
 int main(int argc, char *argv[])
@@ -10,11 +12,14 @@ int main(int argc, char *argv[])
     QApplication::setOrganizationName(QStringLiteral("TimetableCodex"));
     QApplication::setApplicationName(QStringLiteral("Timetable & Task Manager"));
 
-    QFile styleFile(QStringLiteral(":/styles/app.qss"));
-    if (styleFile.open(QIODevice::ReadOnly))
-    {
-        app.setStyleSheet(QString::fromUtf8(styleFile.readAll()));
-    }
+    Theme::apply(app);
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, []() {
+        for (const QString &line : Metrics::instance().report())
+        {
+            qInfo().noquote() << line;
+        }
+    });
 
     MainWindow window;
     window.show();
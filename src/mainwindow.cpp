@@ -2,75 +2,90 @@
 
 #include <QApplication>
 #include <QBoxLayout>
-#include <QEvent>
+#include <QDebug>
 #include <QLabel>
-#include <QMouseEvent>
+#include <QMessageBox>
 #include <QScreen>
+#include <QStyle>
 #include <QTimer>
 
 #include <algorithm>
 
+namespace
+{
+constexpr int kHotZoneWidth = 6;
+constexpr int kMaxReminderLines = 3;
+
+QString reminderLine(const ReminderEngine::Reminder &reminder)
+{
+    const QString time = reminder.due.toString(QStringLiteral("HH:mm"));
+    switch (reminder.kind)
+    {
+    case ReminderEngine::SubtaskDue:
+        return MainWindow::tr("%1 is due at %2").arg(reminder.title, time);
+    case ReminderEngine::TaskEnd:
+        return MainWindow::tr("%1 ends at %2").arg(reminder.title, time);
+    case ReminderEngine::ActivityStart:
+        return MainWindow::tr("%1 starts at %2").arg(reminder.title, time);
+    }
+    return reminder.title;
+}
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
 {
     setWindowTitle(QStringLiteral("Timetable & Task Manager"));
     resize(1280, 720);
-    setMouseTracking(true);
-    centralWidget();
     createLayout();
+    createRefreshGraph();
     connectSignals();
     mJsonManager.ensureDataFiles();
-    updateSidebarWidth();
+    updateSidebarGeometry();
 
     // Load data into pages
     const auto activities = mJsonManager.loadActivities();
     const auto tasks = mJsonManager.loadTasks();
     const auto settings = mJsonManager.loadSettings();
-    const auto schoolPeriods = mJsonManager.loadSchoolPeriods();
+    const auto schedule = mJsonManager.loadScheduleIndex();
+
+    mStateStore.publishActivities(activities);
+    mStateStore.publishTasks(tasks);
+    mStateStore.publishSettings(settings);
+    mStateStore.publishSchedule(schedule);
+    syncSearchIndex();
 
     mHomePage->setJsonManager(&mJsonManager);
+    mHomePage->setSearch(&mSearchIndex, &mScheduler);
     mHomePage->setActivities(activities);
-    mHomePage->setSchoolPeriods(schoolPeriods);
+    mHomePage->setSchedule(schedule);
     mHomePage->setSettings(settings);
 
     mTimetablePage->setJsonManager(&mJsonManager);
-    mTimetablePage->setSchoolPeriods(schoolPeriods);
+    mTimetablePage->setScheduler(&mScheduler);
+    mTimetablePage->setSchedule(schedule);
     mTimetablePage->setSettings(settings);
 
     mTasksPage->setJsonManager(&mJsonManager);
+    mTasksPage->setSearch(&mSearchIndex, &mScheduler);
     mTasksPage->setTasks(tasks);
 
     mSettingsPage->setJsonManager(&mJsonManager);
+    mSettingsPage->setSchedule(schedule);
     mSettingsPage->setSettings(settings);
 
-    installEventFilter(this);
-    navigateTo(0);
-}
+    // Only the page that is shown first does its initial build now; the others
+    // catch up when they are navigated to.
+    mRefreshGraph->invalidate(mScheduleSource);
+    mRefreshGraph->invalidate(mSettingsSource);
 
-bool MainWindow::eventFilter(QObject *watched, QEvent *event)
-{
-    if (event->type() == QEvent::MouseMove)
-    {
-        const auto mouseEvent = static_cast<QMouseEvent *>(event);
-        const QPoint pos = mouseEvent->globalPosition().toPoint();
-        const QPoint local = mapFromGlobal(pos);
-
-        if (local.x() <= 20)
-        {
-            mSidebar->expand();
-        }
-        else if (!mSidebar->rect().contains(mSidebar->mapFrom(this, local)))
-        {
-            mSidebar->collapse();
-        }
-    }
-    return QMainWindow::eventFilter(watched, event);
+    navigateTo(0);
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
     QMainWindow::resizeEvent(event);
-    updateSidebarWidth();
+    updateSidebarGeometry();
 }
 
 void MainWindow::createLayout()
@@ -80,53 +95,187 @@ void MainWindow::createLayout()
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
 
-    mSidebar = new Sidebar(central);
     mStack = new QStackedWidget(central);
-
-    layout->addWidget(mSidebar);
     layout->addWidget(mStack, 1);
 
+    // The sidebar and its hot zone are overlays outside the layout, so sliding the
+    // sidebar in never resizes the page stack.
+    mHotZone = new SidebarHotZone(central);
+    mSidebar = new Sidebar(central);
+    mHotZone->raise();
+    mSidebar->raise();
+
     setCentralWidget(central);
 
     mHomePage = new HomePage(this);
     mTimetablePage = new TimetablePage(this);
+    mTimelinePage = new TimelinePage(this);
     mTasksPage = new TasksPage(this);
     mSettingsPage = new SettingsPage(this);
 
     mStack->addWidget(mHomePage);
     mStack->addWidget(mTimetablePage);
+    mStack->addWidget(mTimelinePage);
     mStack->addWidget(mTasksPage);
     mStack->addWidget(mSettingsPage);
+
+    if (QSystemTrayIcon::isSystemTrayAvailable())
+    {
+        mTrayIcon = new QSystemTrayIcon(style()->standardIcon(QStyle::SP_MessageBoxInformation), this);
+        mTrayIcon->setToolTip(windowTitle());
+        mTrayIcon->show();
+    }
+}
+
+void MainWindow::createRefreshGraph()
+{
+    mRefreshGraph = new RefreshGraph(mStack, this);
+    mScheduleSource = mRefreshGraph->addSource();
+    mSettingsSource = mRefreshGraph->addSource();
+    mClockSource = mRefreshGraph->addSource();
+
+    const int homePeriods = mRefreshGraph->addView(mHomePage, [this]() {
+        mHomePage->refreshPeriods();
+    });
+    mRefreshGraph->addDependency(homePeriods, mScheduleSource);
+    mRefreshGraph->addDependency(homePeriods, mSettingsSource);
+    mRefreshGraph->addDependency(homePeriods, mClockSource);
+
+    const int timetableSchedule = mRefreshGraph->addView(mTimetablePage, [this]() {
+        mTimetablePage->refreshSchedule();
+    });
+    mRefreshGraph->addDependency(timetableSchedule, mScheduleSource);
+
+    const int timetableWeek = mRefreshGraph->addView(mTimetablePage, [this]() {
+        mTimetablePage->refreshWeek();
+    });
+    mRefreshGraph->addDependency(timetableWeek, timetableSchedule);
+    mRefreshGraph->addDependency(timetableWeek, mSettingsSource);
 }
 
 void MainWindow::connectSignals()
 {
     connect(mSidebar, &Sidebar::pageRequested, this, &MainWindow::navigateTo);
-    connect(mSettingsPage, &SettingsPage::settingsChanged, this, [this](const SettingsData &settings) {
-        mJsonManager.saveSettings(settings);
-        mHomePage->setSettings(settings);
-        mTimetablePage->setSettings(settings);
+    connect(mHotZone, &SidebarHotZone::entered, mSidebar, &Sidebar::expand);
+    connect(mSettingsPage, &SettingsPage::settingsChanged, this, &MainWindow::applySettings);
+    connect(mTimetablePage, &TimetablePage::settingsChanged, this, &MainWindow::applySettings);
+
+    connect(&mStateStore, &StateStore::published, this, [this]() {
+        const AppSnapshotPtr snapshot = mStateStore.snapshot();
+        mReminders.sync(*snapshot);
+        mUrgency.sync(*snapshot);
+        mHomePage->setFocusTasks(mUrgency.top(FocusPanel::kRowCount));
+        mTimelinePage->setSnapshot(snapshot);
+    });
+    connect(mHomePage, &HomePage::focusTaskRequested, this, [this](const QString &taskId) {
+        navigateTo(mStack->indexOf(mTasksPage));
+        mTasksPage->showTask(taskId);
     });
+    connect(&mReminders, &ReminderEngine::remindersDue, this, &MainWindow::showReminders);
 
-    connect(mHomePage, &HomePage::activitiesChanged, this, [this](const QVector<Activity> &activities) {
-        mJsonManager.saveActivities(activities);
-        mTasksPage->refreshFromHome(activities);
+    connect(mHomePage, &HomePage::activitiesChanged, this, &MainWindow::commitActivities);
+    connect(mHomePage, &HomePage::periodsExpired, this, [this]() {
+        mRefreshGraph->invalidate(mClockSource);
     });
 
+    connect(mTasksPage, &TasksPage::studyPlanRequested, this, &MainWindow::planStudyTime);
     connect(mTasksPage, &TasksPage::tasksChanged, this, [this](const QVector<Task> &tasks) {
+        mStateStore.publishTasks(tasks);
+        syncSearchIndex();
         mJsonManager.saveTasks(tasks);
     });
 }
 
-void MainWindow::updateSidebarWidth()
+void MainWindow::commitActivities(const QVector<Activity> &activities)
+{
+    mStateStore.publishActivities(activities);
+    syncSearchIndex();
+    mJsonManager.saveActivities(activities);
+    mTasksPage->refreshFromHome(activities);
+}
+
+void MainWindow::planStudyTime(const Task &task, int minutes)
+{
+    const AppSnapshotPtr snapshot = mStateStore.snapshot();
+    const QDateTime now = QDateTime::currentDateTime();
+    FreeTimeMap freeTime = StudyPlanner::availability(*snapshot, now);
+    const StudyPlanner::Plan plan = StudyPlanner::plan(task, minutes, freeTime, now);
+    if (plan.nothingLeft)
+    {
+        QMessageBox::information(this, tr("Plan Study Time"), tr("Every subtask is already completed, so there is nothing left to plan."));
+        return;
+    }
+    if (plan.sessions.isEmpty())
+    {
+        QMessageBox::information(this, tr("Plan Study Time"), tr("No free time was found before the deadline."));
+        return;
+    }
+
+    const QVector<Activity> activities = snapshot->activities + StudyPlanner::toActivities(plan, task);
+    mHomePage->setActivities(activities);
+    commitActivities(activities);
+
+    QString message = tr("Planned %n study session(s) totalling %1 h.", nullptr, plan.sessions.size())
+                          .arg(plan.plannedMinutes / 60.0, 0, 'f', 1);
+    if (plan.plannedMinutes < plan.requestedMinutes)
+    {
+        message += QLatin1Char(' ') + tr("Only this much free time was found before the deadline.");
+    }
+    QMessageBox::information(this, tr("Plan Study Time"), message);
+}
+
+void MainWindow::applySettings(const SettingsData &settings)
+{
+    mStateStore.publishSettings(settings);
+    mJsonManager.saveSettings(settings);
+    mHomePage->setSettings(settings);
+    mTimetablePage->setSettings(settings);
+    mSettingsPage->setSettings(settings);
+    mRefreshGraph->invalidate(mSettingsSource);
+}
+
+void MainWindow::syncSearchIndex()
+{
+    // The index catches up with the latest snapshot off the GUI thread; active
+    // searches are re-run once it has.
+    const AppSnapshotPtr snapshot = mStateStore.snapshot();
+    mScheduler.run<bool>(TaskScheduler::Background, CancellationToken(), [this, snapshot](const CancellationToken &) {
+        mSearchIndex.sync(*snapshot);
+        return true;
+    }, this, [this](bool) {
+        mTasksPage->refreshSearch();
+        mHomePage->refreshSearch();
+    });
+}
+
+void MainWindow::showReminders(const QVector<ReminderEngine::Reminder> &reminders)
 {
-    const int width = std::max(220, width() / 6);
-    mSidebar->setExpandedWidth(width);
-    if (mSidebar->isExpanded())
+    QStringList lines;
+    for (int i = 0; i < reminders.size() && i < kMaxReminderLines; ++i)
+    {
+        lines.append(reminderLine(reminders.at(i)));
+    }
+    if (reminders.size() > kMaxReminderLines)
     {
-        mSidebar->setMaximumWidth(width);
-        mSidebar->setMinimumWidth(width);
+        lines.append(tr("and %n more", nullptr, reminders.size() - kMaxReminderLines));
     }
+
+    const QString title = reminders.size() == 1 ? tr("Reminder") : tr("%n reminders", nullptr, reminders.size());
+    if (mTrayIcon)
+    {
+        mTrayIcon->showMessage(title, lines.join(QLatin1Char('\n')), QSystemTrayIcon::Information);
+    }
+    else
+    {
+        qInfo().noquote() << title << lines.join(QStringLiteral("; "));
+    }
+}
+
+void MainWindow::updateSidebarGeometry()
+{
+    const int height = centralWidget()->height();
+    mSidebar->setOverlayGeometry(std::max(220, width() / 6), height);
+    mHotZone->setGeometry(0, 0, kHotZoneWidth, height);
 }
 
 void MainWindow::navigateTo(int index)
@@ -136,4 +285,5 @@ void MainWindow::navigateTo(int index)
         return;
     }
     mStack->setCurrentIndex(index);
+    mSidebar->setCurrentIndex(index);
 }
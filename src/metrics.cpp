@@ -0,0 +1,89 @@
+#include "metrics.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::increment(const QString &name, qint64 delta)
+{
+    QMutexLocker locker(&mMutex);
+    mCounters[name] += delta;
+}
+
+void Metrics::setGauge(const QString &name, qint64 value)
+{
+    QMutexLocker locker(&mMutex);
+    Gauge &gauge = mGauges[name];
+    gauge.value = value;
+    gauge.peak = std::max(gauge.peak, value);
+}
+
+void Metrics::recordDuration(const QString &name, qint64 micros)
+{
+    QMutexLocker locker(&mMutex);
+    Timing &timing = mTimings[name];
+    ++timing.count;
+    timing.totalMicros += micros;
+    timing.maxMicros = std::max(timing.maxMicros, micros);
+}
+
+qint64 Metrics::counter(const QString &name) const
+{
+    QMutexLocker locker(&mMutex);
+    return mCounters.value(name);
+}
+
+qint64 Metrics::gauge(const QString &name) const
+{
+    QMutexLocker locker(&mMutex);
+    return mGauges.value(name).value;
+}
+
+qint64 Metrics::gaugePeak(const QString &name) const
+{
+    QMutexLocker locker(&mMutex);
+    return mGauges.value(name).peak;
+}
+
+QStringList Metrics::report() const
+{
+    QMutexLocker locker(&mMutex);
+    QStringList lines;
+    for (auto it = mCounters.cbegin(); it != mCounters.cend(); ++it)
+    {
+        lines << QStringLiteral("%1: %2").arg(it.key()).arg(it.value());
+    }
+
+    // Pools count "<name>.hits" and "<name>.misses"; summarise them as a hit rate.
+    const QString hitsSuffix = QStringLiteral(".hits");
+    for (auto it = mCounters.cbegin(); it != mCounters.cend(); ++it)
+    {
+        if (!it.key().endsWith(hitsSuffix))
+        {
+            continue;
+        }
+        const QString name = it.key().chopped(hitsSuffix.size());
+        const qint64 total = it.value() + mCounters.value(name + QStringLiteral(".misses"));
+        if (total > 0)
+        {
+            lines << QStringLiteral("%1.hitRate: %2%").arg(name).arg(100.0 * it.value() / total, 0, 'f', 1);
+        }
+    }
+    for (auto it = mGauges.cbegin(); it != mGauges.cend(); ++it)
+    {
+        lines << QStringLiteral("%1: %2 (peak %3)").arg(it.key()).arg(it.value().value).arg(it.value().peak);
+    }
+    for (auto it = mTimings.cbegin(); it != mTimings.cend(); ++it)
+    {
+        const Timing &timing = it.value();
+        const double mean = timing.count > 0 ? double(timing.totalMicros) / timing.count : 0.0;
+        lines << QStringLiteral("%1: n=%2 mean=%3us max=%4us").arg(it.key()).arg(timing.count).arg(mean, 0, 'f', 1).arg(timing.maxMicros);
+    }
+    return lines;
+}
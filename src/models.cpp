@@ -0,0 +1,262 @@
+#include "models.h"
+
+class ActivityData : public QSharedData
+{
+public:
+    QString id;
+    QString title;
+    QString description;
+    QDateTime startTime;
+    QDateTime endTime;
+    QColor color;
+};
+
+class SubtaskData : public QSharedData
+{
+public:
+    QString id;
+    QString title;
+    QString description;
+    QDateTime dueTime;
+    double weighting = 1.0;
+    bool completed = false;
+};
+
+class TaskData : public QSharedData
+{
+public:
+    QString id;
+    QString title;
+    QString description;
+    QDateTime startTime;
+    QDateTime endTime;
+    QVector<Subtask> subtasks;
+};
+
+Activity::Activity()
+    : d(new ActivityData)
+{
+}
+
+Activity::Activity(const Activity &other) = default;
+Activity::Activity(Activity &&other) noexcept = default;
+Activity &Activity::operator=(const Activity &other) = default;
+Activity &Activity::operator=(Activity &&other) noexcept = default;
+Activity::~Activity() = default;
+
+const QString &Activity::id() const
+{
+    return d->id;
+}
+
+void Activity::setId(const QString &id)
+{
+    d->id = id;
+}
+
+const QString &Activity::title() const
+{
+    return d->title;
+}
+
+void Activity::setTitle(const QString &title)
+{
+    d->title = title;
+}
+
+const QString &Activity::description() const
+{
+    return d->description;
+}
+
+void Activity::setDescription(const QString &description)
+{
+    d->description = description;
+}
+
+const QDateTime &Activity::startTime() const
+{
+    return d->startTime;
+}
+
+void Activity::setStartTime(const QDateTime &startTime)
+{
+    d->startTime = startTime;
+}
+
+const QDateTime &Activity::endTime() const
+{
+    return d->endTime;
+}
+
+void Activity::setEndTime(const QDateTime &endTime)
+{
+    d->endTime = endTime;
+}
+
+const QColor &Activity::color() const
+{
+    return d->color;
+}
+
+void Activity::setColor(const QColor &color)
+{
+    d->color = color;
+}
+
+bool Activity::isSharedWith(const Activity &other) const
+{
+    return d == other.d;
+}
+
+Subtask::Subtask()
+    : d(new SubtaskData)
+{
+}
+
+Subtask::Subtask(const Subtask &other) = default;
+Subtask::Subtask(Subtask &&other) noexcept = default;
+Subtask &Subtask::operator=(const Subtask &other) = default;
+Subtask &Subtask::operator=(Subtask &&other) noexcept = default;
+Subtask::~Subtask() = default;
+
+const QString &Subtask::id() const
+{
+    return d->id;
+}
+
+void Subtask::setId(const QString &id)
+{
+    d->id = id;
+}
+
+const QString &Subtask::title() const
+{
+    return d->title;
+}
+
+void Subtask::setTitle(const QString &title)
+{
+    d->title = title;
+}
+
+const QString &Subtask::description() const
+{
+    return d->description;
+}
+
+void Subtask::setDescription(const QString &description)
+{
+    d->description = description;
+}
+
+const QDateTime &Subtask::dueTime() const
+{
+    return d->dueTime;
+}
+
+void Subtask::setDueTime(const QDateTime &dueTime)
+{
+    d->dueTime = dueTime;
+}
+
+double Subtask::weighting() const
+{
+    return d->weighting;
+}
+
+void Subtask::setWeighting(double weighting)
+{
+    d->weighting = weighting;
+}
+
+bool Subtask::isCompleted() const
+{
+    return d->completed;
+}
+
+void Subtask::setCompleted(bool completed)
+{
+    d->completed = completed;
+}
+
+bool Subtask::isSharedWith(const Subtask &other) const
+{
+    return d == other.d;
+}
+
+Task::Task()
+    : d(new TaskData)
+{
+}
+
+Task::Task(const Task &other) = default;
+Task::Task(Task &&other) noexcept = default;
+Task &Task::operator=(const Task &other) = default;
+Task &Task::operator=(Task &&other) noexcept = default;
+Task::~Task() = default;
+
+const QString &Task::id() const
+{
+    return d->id;
+}
+
+void Task::setId(const QString &id)
+{
+    d->id = id;
+}
+
+const QString &Task::title() const
+{
+    return d->title;
+}
+
+void Task::setTitle(const QString &title)
+{
+    d->title = title;
+}
+
+const QString &Task::description() const
+{
+    return d->description;
+}
+
+void Task::setDescription(const QString &description)
+{
+    d->description = description;
+}
+
+const QDateTime &Task::startTime() const
+{
+    return d->startTime;
+}
+
+void Task::setStartTime(const QDateTime &startTime)
+{
+    d->startTime = startTime;
+}
+
+const QDateTime &Task::endTime() const
+{
+    return d->endTime;
+}
+
+void Task::setEndTime(const QDateTime &endTime)
+{
+    d->endTime = endTime;
+}
+
+const QVector<Subtask> &Task::subtasks() const
+{
+    return d->subtasks;
+}
+
+void Task::setSubtasks(const QVector<Subtask> &subtasks)
+{
+    d->subtasks = subtasks;
+}
+
+bool Task::isSharedWith(const Task &other) const
+{
+    return d == other.d;
+}
@@ -0,0 +1,98 @@
+#include "refreshgraph.h"
+
+#include <QTimer>
+
+#include <utility>
+
+RefreshGraph::RefreshGraph(QStackedWidget *stack, QObject *parent)
+    : QObject(parent)
+    , mStack(stack)
+{
+    // Bring a page up to date before it is first painted.
+    connect(mStack, &QStackedWidget::currentChanged, this, &RefreshGraph::flush);
+}
+
+int RefreshGraph::addSource()
+{
+    mNodes.append(Node{});
+    return mNodes.size() - 1;
+}
+
+int RefreshGraph::addView(QWidget *page, std::function<void()> refresh)
+{
+    Node node;
+    node.page = page;
+    node.refresh = std::move(refresh);
+    mNodes.append(node);
+    return mNodes.size() - 1;
+}
+
+void RefreshGraph::addDependency(int node, int dependsOn)
+{
+    Q_ASSERT(node > dependsOn); // nodes are refreshed in creation order
+    mNodes[dependsOn].dependents.append(node);
+}
+
+void RefreshGraph::invalidate(int node)
+{
+    QVector<int> pending{node};
+    bool marked = false;
+    while (!pending.isEmpty())
+    {
+        const int current = pending.takeLast();
+        for (const int dependent : std::as_const(mNodes[current].dependents))
+        {
+            if (!mNodes.at(dependent).dirty)
+            {
+                mNodes[dependent].dirty = true;
+                pending.append(dependent);
+                marked = true;
+            }
+        }
+    }
+
+    if (marked)
+    {
+        scheduleFlush();
+    }
+}
+
+bool RefreshGraph::isDirty(int node) const
+{
+    return mNodes.at(node).dirty;
+}
+
+void RefreshGraph::flush()
+{
+    mFlushScheduled = false;
+
+    // Creation order is a topological order, so upstream views refresh first.
+    for (int i = 0; i < mNodes.size(); ++i)
+    {
+        if (!mNodes.at(i).dirty || !isShown(mNodes.at(i)))
+        {
+            continue;
+        }
+
+        mNodes[i].dirty = false;
+        if (mNodes.at(i).refresh)
+        {
+            mNodes.at(i).refresh();
+        }
+    }
+}
+
+void RefreshGraph::scheduleFlush()
+{
+    if (mFlushScheduled)
+    {
+        return;
+    }
+    mFlushScheduled = true;
+    QTimer::singleShot(0, this, &RefreshGraph::flush);
+}
+
+bool RefreshGraph::isShown(const Node &node) const
+{
+    return node.page.isNull() || node.page == mStack->currentWidget();
+}
@@ -0,0 +1,221 @@
+#include "reminderengine.h"
+
+#include "metrics.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr qint64 kLeadMs = 15 * 60 * 1000;
+constexpr qint64 kMaxArmMs = 5 * 60 * 1000;
+
+QString taskKey(const QString &id)
+{
+    return QStringLiteral("t:") + id;
+}
+
+QString subtaskKey(const QString &id)
+{
+    return QStringLiteral("s:") + id;
+}
+
+QString activityKey(const QString &id)
+{
+    return QStringLiteral("a:") + id;
+}
+
+// std heap functions build a max-heap; invert the order for earliest-first.
+struct LaterFirst
+{
+    template <typename EntryT>
+    bool operator()(const EntryT &a, const EntryT &b) const
+    {
+        return a.fireMsecs > b.fireMsecs;
+    }
+};
+}
+
+ReminderEngine::ReminderEngine(QObject *parent)
+    : QObject(parent)
+{
+    mTimer.setSingleShot(true);
+    mTimer.setTimerType(Qt::CoarseTimer);
+    connect(&mTimer, &QTimer::timeout, this, &ReminderEngine::fireDue);
+}
+
+void ReminderEngine::sync(const AppSnapshot &snapshot)
+{
+    if (mVersion != 0 && snapshot.version <= mVersion)
+    {
+        return;
+    }
+    syncTasks(snapshot.tasks);
+    syncActivities(snapshot.activities);
+    mVersion = snapshot.version;
+
+    compact();
+    // Anything already inside its lead window is announced right away.
+    fireDue();
+}
+
+int ReminderEngine::pendingCount() const
+{
+    return mLive.size();
+}
+
+void ReminderEngine::syncTasks(const QVector<Task> &tasks)
+{
+    diffEntities(mTasks, tasks, [this](const Task &task) {
+        scheduleTask(task);
+    }, [this](const QString &taskId) {
+        for (const QString &key : mTaskKeys.take(taskId))
+        {
+            unschedule(key);
+            mFired.remove(key);
+        }
+    });
+    mTasks = tasks;
+}
+
+void ReminderEngine::syncActivities(const QVector<Activity> &activities)
+{
+    diffEntities(mActivities, activities, [this](const Activity &activity) {
+        unschedule(activityKey(activity.id()));
+        if (activity.startTime().isValid())
+        {
+            schedule(activityKey(activity.id()), {ActivityStart, activity.id(), activity.title(), activity.startTime()});
+        }
+    }, [this](const QString &activityId) {
+        unschedule(activityKey(activityId));
+        mFired.remove(activityKey(activityId));
+    });
+    mActivities = activities;
+}
+
+void ReminderEngine::scheduleTask(const Task &task)
+{
+    const QStringList oldKeys = mTaskKeys.take(task.id());
+    for (const QString &key : oldKeys)
+    {
+        unschedule(key);
+    }
+
+    QStringList keys;
+    if (task.endTime().isValid())
+    {
+        keys.append(taskKey(task.id()));
+        schedule(keys.last(), {TaskEnd, task.id(), task.title(), task.endTime()});
+    }
+    for (const Subtask &subtask : task.subtasks())
+    {
+        if (subtask.isCompleted() || !subtask.dueTime().isValid())
+        {
+            continue;
+        }
+        keys.append(subtaskKey(subtask.id()));
+        schedule(keys.last(), {SubtaskDue, subtask.id(), subtask.title(), subtask.dueTime()});
+    }
+    for (const QString &key : oldKeys)
+    {
+        if (!keys.contains(key))
+        {
+            mFired.remove(key);
+        }
+    }
+    mTaskKeys.insert(task.id(), keys);
+}
+
+void ReminderEngine::schedule(const QString &key, const Reminder &reminder)
+{
+    const qint64 dueMsecs = reminder.due.toMSecsSinceEpoch();
+    // Past deadlines and ones already announced for this instant stay silent.
+    if (dueMsecs <= QDateTime::currentMSecsSinceEpoch() || mFired.value(key, -1) == dueMsecs)
+    {
+        return;
+    }
+
+    Live live;
+    live.reminder = reminder;
+    live.fireMsecs = dueMsecs - kLeadMs;
+    live.generation = ++mGeneration;
+    mLive.insert(key, live);
+
+    mHeap.push_back({live.fireMsecs, live.generation, key});
+    std::push_heap(mHeap.begin(), mHeap.end(), LaterFirst());
+}
+
+void ReminderEngine::unschedule(const QString &key)
+{
+    // The heap entry stays behind and is discarded when it surfaces.
+    mLive.remove(key);
+}
+
+void ReminderEngine::fireDue()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<Reminder> due;
+    while (!mHeap.empty() && mHeap.front().fireMsecs <= now)
+    {
+        std::pop_heap(mHeap.begin(), mHeap.end(), LaterFirst());
+        const Entry entry = mHeap.back();
+        mHeap.pop_back();
+
+        const auto live = mLive.constFind(entry.key);
+        if (live == mLive.constEnd() || live->generation != entry.generation)
+        {
+            continue;
+        }
+        due.append(live->reminder);
+        mFired.insert(entry.key, live->reminder.due.toMSecsSinceEpoch());
+        mLive.erase(live);
+    }
+
+    Metrics::instance().increment(QStringLiteral("reminders.wakeups"));
+    Metrics::instance().setGauge(QStringLiteral("reminders.pending"), mLive.size());
+    if (!due.isEmpty())
+    {
+        Metrics::instance().increment(QStringLiteral("reminders.fired"), due.size());
+        emit remindersDue(due);
+    }
+    arm();
+}
+
+void ReminderEngine::arm()
+{
+    // Drop stale entries at the top so the timer is armed for a live deadline.
+    while (!mHeap.empty())
+    {
+        const Entry &top = mHeap.front();
+        const auto live = mLive.constFind(top.key);
+        if (live != mLive.constEnd() && live->generation == top.generation)
+        {
+            break;
+        }
+        std::pop_heap(mHeap.begin(), mHeap.end(), LaterFirst());
+        mHeap.pop_back();
+    }
+
+    if (mHeap.empty())
+    {
+        mTimer.stop();
+        return;
+    }
+    const qint64 wait = mHeap.front().fireMsecs - QDateTime::currentMSecsSinceEpoch();
+    mTimer.start(static_cast<int>(std::clamp<qint64>(wait, 0, kMaxArmMs)));
+}
+
+void ReminderEngine::compact()
+{
+    // Rebuild once stale entries outnumber live ones, keeping the heap O(live).
+    if (mHeap.size() <= 2 * static_cast<size_t>(mLive.size()) + 64)
+    {
+        return;
+    }
+    mHeap.clear();
+    mHeap.reserve(mLive.size());
+    for (auto it = mLive.cbegin(); it != mLive.cend(); ++it)
+    {
+        mHeap.push_back({it->fireMsecs, it->generation, it.key()});
+    }
+    std::make_heap(mHeap.begin(), mHeap.end(), LaterFirst());
+}
@@ -0,0 +1,637 @@
+#include "scheduleindex.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+constexpr int kDaysPerWeek = 7;
+constexpr int kMinutesPerDay = 24 * 60;
+
+const QStringList kWeekdayNames = {QStringLiteral("Monday"), QStringLiteral("Tuesday"), QStringLiteral("Wednesday"),
+                                   QStringLiteral("Thursday"), QStringLiteral("Friday"), QStringLiteral("Saturday"),
+                                   QStringLiteral("Sunday")};
+
+const QColor kSpecialColor("#EFEFEF");
+
+QDate mondayOf(const QDate &date)
+{
+    return date.addDays(1 - date.dayOfWeek());
+}
+
+qint16 minuteOfDay(const QTime &time)
+{
+    return static_cast<qint16>(time.isValid() ? time.msecsSinceStartOfDay() / 60000 : 0);
+}
+}
+
+ScheduleIndex ScheduleIndex::compile(const SchoolPeriodsData &data)
+{
+    ScheduleIndex index;
+
+    // The current week is stored by name, so a week may appear only once in the
+    // rotation; a rotation that repeats one is rejected rather than collapsed.
+    for (const auto &week : data.rotation)
+    {
+        if (!data.weeks.contains(week.toUpper()))
+        {
+            continue;
+        }
+        if (index.mWeekNames.contains(week.toUpper()))
+        {
+            qWarning("SchoolPeriods.json: week %s repeats in the rotation; using the week tables in name order instead",
+                     qUtf8Printable(week));
+            index.mWeekNames.clear();
+            break;
+        }
+        index.mWeekNames.append(week.toUpper());
+    }
+    if (index.mWeekNames.isEmpty())
+    {
+        index.mWeekNames = data.weeks.keys();
+    }
+
+    index.mDays = data.days;
+    index.mYearLevels = data.yearLevels;
+    std::sort(index.mYearLevels.begin(), index.mYearLevels.end());
+    index.mYearLevels.erase(std::unique(index.mYearLevels.begin(), index.mYearLevels.end()), index.mYearLevels.end());
+    if (index.mYearLevels.isEmpty())
+    {
+        index.mYearLevels.append(SettingsData{}.yearLevel);
+    }
+
+    QHash<QString, int> subjectIds;
+    for (auto it = data.subjects.cbegin(); it != data.subjects.cend(); ++it)
+    {
+        subjectIds.insert(it.key(), index.mSubjects.size());
+        index.mSubjects.append(it.value());
+    }
+
+    QHash<QString, int> roomIds;
+    auto internRoom = [&](const QString &room) -> int {
+        if (room.isEmpty())
+        {
+            return -1;
+        }
+        const auto found = roomIds.constFind(room);
+        if (found != roomIds.cend())
+        {
+            return found.value();
+        }
+        roomIds.insert(room, index.mRooms.size());
+        index.mRooms.append(room);
+        return index.mRooms.size() - 1;
+    };
+
+    auto internSubject = [&](const QString &name) -> int {
+        const auto found = subjectIds.constFind(name);
+        if (found != subjectIds.cend())
+        {
+            return found.value();
+        }
+        SubjectDefinition definition;
+        definition.name = name;
+        subjectIds.insert(name, index.mSubjects.size());
+        index.mSubjects.append(definition);
+        return index.mSubjects.size() - 1;
+    };
+
+    const int yearCount = index.mYearLevels.size();
+    index.mDayTable = QVector<DayRange>(index.mWeekNames.size() * kDaysPerWeek * yearCount);
+
+    for (int week = 0; week < index.mWeekNames.size(); ++week)
+    {
+        const WeekSchedule schedule = data.weeks.value(index.mWeekNames.at(week));
+        for (int dayOfWeek = 1; dayOfWeek <= kDaysPerWeek; ++dayOfWeek)
+        {
+            const auto dayIt = schedule.days.constFind(dayName(dayOfWeek));
+            if (dayIt == schedule.days.cend())
+            {
+                continue;
+            }
+
+            const DaySchedule &day = dayIt.value();
+            QHash<QString, const TimetableSubjectSlot *> slotLookup;
+            for (const auto &slot : day.slots)
+            {
+                slotLookup.insert(slot.periodKey, &slot);
+            }
+
+            for (int year = 0; year < yearCount; ++year)
+            {
+                const QString templateName = data.templateOverrides.value(day.templateName).value(index.mYearLevels.at(year), day.templateName);
+                const auto templIt = data.templates.constFind(templateName);
+                if (templIt == data.templates.cend())
+                {
+                    continue;
+                }
+
+                DayRange range;
+                range.first = index.mPeriods.size();
+                for (const auto &periodTime : templIt.value().periods)
+                {
+                    ScheduledPeriod period;
+                    period.label = periodTime.label;
+                    period.startMinute = minuteOfDay(periodTime.start);
+                    period.endMinute = minuteOfDay(periodTime.end);
+                    if (const TimetableSubjectSlot *slot = slotLookup.value(periodTime.label, nullptr))
+                    {
+                        period.subject = internSubject(slot->subjectName);
+                        period.room = internRoom(slot->room);
+                    }
+                    index.mPeriods.append(period);
+                }
+                range.count = index.mPeriods.size() - range.first;
+                index.mDayTable[index.cell(week, dayOfWeek, year)] = range;
+            }
+        }
+    }
+
+    index.buildReverseIndexes();
+    return index;
+}
+
+QString ScheduleIndex::dayName(int dayOfWeek)
+{
+    if (dayOfWeek < 1 || dayOfWeek > kDaysPerWeek)
+    {
+        return {};
+    }
+    return kWeekdayNames.at(dayOfWeek - 1);
+}
+
+int ScheduleIndex::dayOfWeek(const QString &dayName)
+{
+    for (int i = 0; i < kWeekdayNames.size(); ++i)
+    {
+        if (kWeekdayNames.at(i).compare(dayName, Qt::CaseInsensitive) == 0)
+        {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+bool ScheduleIndex::isEmpty() const
+{
+    return mPeriods.isEmpty();
+}
+
+int ScheduleIndex::weekCount() const
+{
+    return mWeekNames.size();
+}
+
+const QStringList &ScheduleIndex::weekNames() const
+{
+    return mWeekNames;
+}
+
+int ScheduleIndex::weekIndex(const QString &weekName) const
+{
+    return mWeekNames.indexOf(weekName.toUpper());
+}
+
+int ScheduleIndex::rotationWeekFor(const QDate &date, const QString &currentWeek, const QDate &today) const
+{
+    const int count = weekCount();
+    if (count == 0)
+    {
+        return -1;
+    }
+
+    const int base = std::max(0, weekIndex(currentWeek));
+    const qint64 weeksAhead = mondayOf(today).daysTo(mondayOf(date)) / kDaysPerWeek;
+    return static_cast<int>(((base + weeksAhead) % count + count) % count);
+}
+
+const QVector<int> &ScheduleIndex::days() const
+{
+    return mDays;
+}
+
+const QVector<int> &ScheduleIndex::yearLevels() const
+{
+    return mYearLevels;
+}
+
+int ScheduleIndex::yearIndex(int yearLevel) const
+{
+    int result = 0;
+    for (int i = 0; i < mYearLevels.size(); ++i)
+    {
+        if (mYearLevels.at(i) <= yearLevel)
+        {
+            result = i;
+        }
+    }
+    return result;
+}
+
+int ScheduleIndex::subjectCount() const
+{
+    return mSubjects.size();
+}
+
+const SubjectDefinition &ScheduleIndex::subject(int index) const
+{
+    return mSubjects.at(index);
+}
+
+int ScheduleIndex::roomCount() const
+{
+    return mRooms.size();
+}
+
+const QString &ScheduleIndex::room(int index) const
+{
+    return mRooms.at(index);
+}
+
+ScheduleIndex::DayRange ScheduleIndex::dayRange(int week, int dayOfWeek, int yearIndex) const
+{
+    if (week < 0 || week >= weekCount() || dayOfWeek < 1 || dayOfWeek > kDaysPerWeek || yearIndex < 0
+        || yearIndex >= mYearLevels.size())
+    {
+        return {};
+    }
+    return mDayTable.at(cell(week, dayOfWeek, yearIndex));
+}
+
+const ScheduledPeriod &ScheduleIndex::period(int index) const
+{
+    return mPeriods.at(index);
+}
+
+TimetablePeriod ScheduleIndex::toTimetablePeriod(const ScheduledPeriod &period, const QDate &date) const
+{
+    TimetablePeriod result;
+    result.periodKey = period.label;
+    result.startTime = QDateTime(date, QTime::fromMSecsSinceStartOfDay(period.startMinute * 60000));
+    result.endTime = QDateTime(date, QTime::fromMSecsSinceStartOfDay(period.endMinute * 60000));
+
+    if (period.subject >= 0)
+    {
+        const auto &definition = mSubjects.at(period.subject);
+        result.subjectName = definition.name;
+        result.teacher = definition.teacher;
+        result.color = definition.color;
+        result.room = period.room >= 0 ? mRooms.at(period.room) : QString();
+    }
+    else
+    {
+        result.isSpecial = true;
+        result.subjectName = period.label;
+        result.color = kSpecialColor;
+    }
+    return result;
+}
+
+QVector<TimetablePeriod> ScheduleIndex::periodsOn(const QDate &date, int week, int yearIndex) const
+{
+    QVector<TimetablePeriod> result;
+    const DayRange range = dayRange(week, date.dayOfWeek(), yearIndex);
+    result.reserve(range.count);
+    for (int i = range.first; i < range.first + range.count; ++i)
+    {
+        result.append(toTimetablePeriod(mPeriods.at(i), date));
+    }
+    return result;
+}
+
+QVector<TimetablePeriod> ScheduleIndex::periodsBetween(const QDateTime &from, const QDateTime &to, const SettingsData &settings) const
+{
+    QVector<TimetablePeriod> result;
+    if (weekCount() == 0 || !from.isValid() || !to.isValid())
+    {
+        return result;
+    }
+
+    const int year = yearIndex(settings.yearLevel);
+    for (QDate date = from.date(); date <= to.date(); date = date.addDays(1))
+    {
+        const int week = rotationWeekFor(date, settings.currentWeek);
+        const DayRange range = dayRange(week, date.dayOfWeek(), year);
+        for (int i = range.first; i < range.first + range.count; ++i)
+        {
+            TimetablePeriod period = toTimetablePeriod(mPeriods.at(i), date);
+            if (period.endTime <= from || period.startTime >= to)
+            {
+                continue;
+            }
+            result.append(period);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const TimetablePeriod &a, const TimetablePeriod &b) {
+        return a.startTime < b.startTime;
+    });
+    return result;
+}
+
+int ScheduleIndex::facetCount(Facet facet) const
+{
+    switch (facet)
+    {
+    case Facet::Subject:
+        return mSubjects.size();
+    case Facet::Room:
+        return mRooms.size();
+    case Facet::Teacher:
+        return mTeachers.size();
+    }
+    return 0;
+}
+
+QString ScheduleIndex::facetName(Facet facet, int id) const
+{
+    if (id < 0 || id >= facetCount(facet))
+    {
+        return {};
+    }
+    switch (facet)
+    {
+    case Facet::Subject:
+        return mSubjects.at(id).name;
+    case Facet::Room:
+        return mRooms.at(id);
+    case Facet::Teacher:
+        return mTeachers.at(id);
+    }
+    return {};
+}
+
+int ScheduleIndex::facetIndex(Facet facet, const QString &name) const
+{
+    return reverseIndex(facet).ids.value(name.trimmed().toLower(), -1);
+}
+
+QVector<int> ScheduleIndex::occurrencesOn(Facet facet, int id, int week, int dayOfWeek, int yearIndex) const
+{
+    QVector<int> result;
+    const int count = facetCount(facet);
+    if (id < 0 || id >= count || yearIndex < 0 || yearIndex >= mYearLevels.size())
+    {
+        return result;
+    }
+
+    const ReverseIndex &index = reverseIndex(facet);
+    const int bucket = yearIndex * count + id;
+    const Posting *first = index.postings.constData() + index.offsets.at(bucket);
+    const Posting *last = index.postings.constData() + index.offsets.at(bucket + 1);
+    const int dayStart = (week * kDaysPerWeek + dayOfWeek - 1) * kMinutesPerDay;
+    const auto byMinute = [](const Posting &posting, int minute) {
+        return posting.cycleMinute < minute;
+    };
+    for (auto it = std::lower_bound(first, last, dayStart, byMinute); it != last && it->cycleMinute < dayStart + kMinutesPerDay; ++it)
+    {
+        result.append(it->period);
+    }
+    return result;
+}
+
+TimetablePeriod ScheduleIndex::nextOccurrence(Facet facet, int id, const QDateTime &from, const SettingsData &settings) const
+{
+    const int count = facetCount(facet);
+    if (weekCount() == 0 || !from.isValid() || id < 0 || id >= count)
+    {
+        return {};
+    }
+
+    const ReverseIndex &index = reverseIndex(facet);
+    const int bucket = yearIndex(settings.yearLevel) * count + id;
+    const Posting *first = index.postings.constData() + index.offsets.at(bucket);
+    const Posting *last = index.postings.constData() + index.offsets.at(bucket + 1);
+    if (first == last)
+    {
+        return {};
+    }
+
+    const QDate date = from.date();
+    const int week = rotationWeekFor(date, settings.currentWeek);
+    const int nowMinute = (week * kDaysPerWeek + date.dayOfWeek() - 1) * kMinutesPerDay + minuteOfDay(from.time());
+    const auto it = std::lower_bound(first, last, nowMinute, [](const Posting &posting, int minute) {
+        return posting.cycleMinute < minute;
+    });
+
+    // Past the last class of this cycle the first class of the next one follows.
+    const Posting &next = it != last ? *it : *first;
+    const int cycleDays = it != last ? 0 : weekCount() * kDaysPerWeek;
+    const int daysAhead = next.cycleMinute / kMinutesPerDay - nowMinute / kMinutesPerDay + cycleDays;
+    return toTimetablePeriod(mPeriods.at(next.period), date.addDays(daysAhead));
+}
+
+int ScheduleIndex::cycleMinutes(int subject, int yearIndex) const
+{
+    return mSubjectMinutes.value(yearIndex * mSubjects.size() + subject);
+}
+
+void ScheduleIndex::buildReverseIndexes()
+{
+    mTeachers.clear();
+    mSubjectTeacher.clear();
+    QHash<QString, int> teacherIds;
+    for (const auto &subject : mSubjects)
+    {
+        int id = -1;
+        if (!subject.teacher.isEmpty())
+        {
+            id = teacherIds.value(subject.teacher, mTeachers.size());
+            if (id == mTeachers.size())
+            {
+                teacherIds.insert(subject.teacher, id);
+                mTeachers.append(subject.teacher);
+            }
+        }
+        mSubjectTeacher.append(id);
+    }
+
+    const int years = mYearLevels.size();
+    const int weeks = weekCount();
+    // Visits every period of every cycle in cycle order, per year level.
+    const auto visit = [&](const std::function<void(int, int, int)> &callback) {
+        for (int year = 0; year < years; ++year)
+        {
+            for (int week = 0; week < weeks; ++week)
+            {
+                for (int dayOfWeek = 1; dayOfWeek <= kDaysPerWeek; ++dayOfWeek)
+                {
+                    const DayRange range = dayRange(week, dayOfWeek, year);
+                    const int dayStart = (week * kDaysPerWeek + dayOfWeek - 1) * kMinutesPerDay;
+                    for (int i = range.first; i < range.first + range.count; ++i)
+                    {
+                        callback(year, dayStart + mPeriods.at(i).startMinute, i);
+                    }
+                }
+            }
+        }
+    };
+
+    mSubjectMinutes = QVector<qint32>(years * mSubjects.size(), 0);
+    visit([&](int year, int, int period) {
+        const ScheduledPeriod &scheduled = mPeriods.at(period);
+        if (scheduled.subject >= 0)
+        {
+            mSubjectMinutes[year * mSubjects.size() + scheduled.subject] += scheduled.endMinute - scheduled.startMinute;
+        }
+    });
+
+    // Counting sort into per-bucket ranges; filling in cycle order keeps each bucket sorted.
+    for (const Facet facet : {Facet::Subject, Facet::Room, Facet::Teacher})
+    {
+        ReverseIndex &index = facet == Facet::Subject ? mBySubject : facet == Facet::Room ? mByRoom : mByTeacher;
+        const int count = facetCount(facet);
+        index.ids.clear();
+        index.ids.reserve(count);
+        for (int id = count - 1; id >= 0; --id)
+        {
+            index.ids.insert(facetName(facet, id).trimmed().toLower(), id);
+        }
+
+        index.offsets = QVector<qint32>(years * count + 1, 0);
+        visit([&](int year, int, int period) {
+            const int id = facetOf(facet, mPeriods.at(period));
+            if (id >= 0)
+            {
+                ++index.offsets[year * count + id + 1];
+            }
+        });
+        for (int bucket = 1; bucket < index.offsets.size(); ++bucket)
+        {
+            index.offsets[bucket] += index.offsets.at(bucket - 1);
+        }
+
+        index.postings = QVector<Posting>(index.offsets.last());
+        QVector<qint32> cursor = index.offsets;
+        visit([&](int year, int cycleMinute, int period) {
+            const int id = facetOf(facet, mPeriods.at(period));
+            if (id >= 0)
+            {
+                index.postings[cursor[year * count + id]++] = {cycleMinute, period};
+            }
+        });
+    }
+}
+
+const ScheduleIndex::ReverseIndex &ScheduleIndex::reverseIndex(Facet facet) const
+{
+    switch (facet)
+    {
+    case Facet::Subject:
+        return mBySubject;
+    case Facet::Room:
+        return mByRoom;
+    case Facet::Teacher:
+        break;
+    }
+    return mByTeacher;
+}
+
+int ScheduleIndex::facetOf(Facet facet, const ScheduledPeriod &period) const
+{
+    switch (facet)
+    {
+    case Facet::Subject:
+        return period.subject;
+    case Facet::Room:
+        return period.room;
+    case Facet::Teacher:
+        return period.subject >= 0 ? mSubjectTeacher.at(period.subject) : -1;
+    }
+    return -1;
+}
+
+QDataStream &operator<<(QDataStream &out, const ScheduleIndex &index)
+{
+    out << index.mWeekNames << index.mDays << index.mYearLevels << index.mRooms;
+
+    out << qint32(index.mSubjects.size());
+    for (const auto &subject : index.mSubjects)
+    {
+        out << subject.name << subject.teacher << subject.color;
+    }
+
+    out << qint32(index.mPeriods.size());
+    for (const auto &period : index.mPeriods)
+    {
+        out << period.label << period.startMinute << period.endMinute << period.subject << period.room;
+    }
+
+    out << qint32(index.mDayTable.size());
+    for (const auto &range : index.mDayTable)
+    {
+        out << range.first << range.count;
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, ScheduleIndex &index)
+{
+    ScheduleIndex result;
+    in >> result.mWeekNames >> result.mDays >> result.mYearLevels >> result.mRooms;
+
+    qint32 count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        SubjectDefinition subject;
+        in >> subject.name >> subject.teacher >> subject.color;
+        result.mSubjects.append(subject);
+    }
+
+    count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        ScheduledPeriod period;
+        in >> period.label >> period.startMinute >> period.endMinute >> period.subject >> period.room;
+        result.mPeriods.append(period);
+    }
+
+    count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        ScheduleIndex::DayRange range;
+        in >> range.first >> range.count;
+        result.mDayTable.append(range);
+    }
+
+    if (in.status() == QDataStream::Ok && !result.isConsistent())
+    {
+        in.setStatus(QDataStream::ReadCorruptData);
+    }
+    if (in.status() == QDataStream::Ok)
+    {
+        result.buildReverseIndexes();
+        index = std::move(result);
+    }
+    return in;
+}
+
+int ScheduleIndex::cell(int week, int dayOfWeek, int yearIndex) const
+{
+    return (week * kDaysPerWeek + (dayOfWeek - 1)) * mYearLevels.size() + yearIndex;
+}
+
+bool ScheduleIndex::isConsistent() const
+{
+    if (mYearLevels.isEmpty() || mDayTable.size() != mWeekNames.size() * kDaysPerWeek * mYearLevels.size())
+    {
+        return false;
+    }
+
+    for (const auto &range : mDayTable)
+    {
+        if (range.first < 0 || range.count < 0 || range.first + range.count > mPeriods.size())
+        {
+            return false;
+        }
+    }
+
+    return std::all_of(mPeriods.cbegin(), mPeriods.cend(), [this](const ScheduledPeriod &period) {
+        return period.subject >= -1 && period.subject < mSubjects.size() && period.room >= -1 && period.room < mRooms.size();
+    });
+}
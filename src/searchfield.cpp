@@ -0,0 +1,60 @@
+#include "searchfield.h"
+
+#include "theme.h"
+
+SearchField::SearchField(QWidget *parent)
+    : QLineEdit(parent)
+{
+    setClearButtonEnabled(true);
+    Theme::setRole(this, "search");
+    connect(this, &QLineEdit::textChanged, this, &SearchField::runQuery);
+}
+
+void SearchField::setSearch(const SearchIndex *index, TaskScheduler *scheduler, SearchIndex::Kinds kinds, int limit)
+{
+    mIndex = index;
+    mScheduler = scheduler;
+    mKinds = kinds;
+    mLimit = limit;
+}
+
+bool SearchField::isActive() const
+{
+    return !text().trimmed().isEmpty();
+}
+
+void SearchField::refresh()
+{
+    if (isActive())
+    {
+        runQuery(text());
+    }
+}
+
+void SearchField::runQuery(const QString &text)
+{
+    mToken.cancel();
+    mToken = CancellationToken();
+
+    if (text.trimmed().isEmpty())
+    {
+        emit cleared();
+        return;
+    }
+    if (!mIndex || !mScheduler)
+    {
+        return;
+    }
+
+    const SearchIndex *index = mIndex;
+    const SearchIndex::Kinds kinds = mKinds;
+    const int limit = mLimit;
+    mScheduler->run<QVector<SearchIndex::Hit>>(
+        TaskScheduler::Interactive, mToken,
+        [index, text, kinds, limit](const CancellationToken &token) {
+            return index->search(text, kinds, limit, token);
+        },
+        this, [this](const QVector<SearchIndex::Hit> &hits) {
+            emit resultsReady(hits);
+        });
+}
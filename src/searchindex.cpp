@@ -0,0 +1,542 @@
+#include "searchindex.h"
+
+#include "metrics.h"
+
+#include <QElapsedTimer>
+#include <QReadLocker>
+#include <QSet>
+#include <QWriteLocker>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+constexpr int kMinFuzzyLength = 3;
+constexpr int kMaxPrefixTerms = 128;
+constexpr int kExactWeight = 3;
+constexpr int kPrefixWeight = 2;
+constexpr int kFuzzyWeight = 1;
+constexpr double kTitleBoost = 2.0;
+
+QString documentKey(SearchIndex::Kind kind, const QString &id)
+{
+    return QString::number(kind) + QLatin1Char(':') + id;
+}
+
+QStringList deletions(const QString &text)
+{
+    QStringList variants;
+    variants.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i)
+    {
+        QString variant = text;
+        variant.remove(i, 1);
+        if (variants.isEmpty() || variants.constLast() != variant)
+        {
+            variants.append(variant);
+        }
+    }
+    return variants;
+}
+
+// True when b is reachable from a by one insertion, deletion, substitution or
+// swap of adjacent characters.
+bool withinOneEdit(const QString &a, const QString &b)
+{
+    const int lengthA = a.size();
+    const int lengthB = b.size();
+    if (std::abs(lengthA - lengthB) > 1)
+    {
+        return false;
+    }
+
+    int i = 0;
+    while (i < lengthA && i < lengthB && a.at(i) == b.at(i))
+    {
+        ++i;
+    }
+    if (lengthA == lengthB)
+    {
+        if (i == lengthA)
+        {
+            return true;
+        }
+        if (QStringView(a).mid(i + 1) == QStringView(b).mid(i + 1))
+        {
+            return true;
+        }
+        return i + 1 < lengthA && a.at(i) == b.at(i + 1) && a.at(i + 1) == b.at(i) && QStringView(a).mid(i + 2) == QStringView(b).mid(i + 2);
+    }
+    if (lengthA > lengthB)
+    {
+        return QStringView(a).mid(i + 1) == QStringView(b).mid(i);
+    }
+    return QStringView(a).mid(i) == QStringView(b).mid(i + 1);
+}
+}
+
+void SearchIndex::sync(const AppSnapshot &snapshot)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QWriteLocker locker(&mLock);
+    // Syncs may be scheduled out of order; an older snapshot never overwrites a newer one.
+    if (mVersion != 0 && snapshot.version <= mVersion)
+    {
+        return;
+    }
+
+    syncTasks(snapshot.tasks);
+    syncActivities(snapshot.activities);
+    reclaimTerms();
+    if (mSortedTermsDirty)
+    {
+        rebuildSortedTerms();
+    }
+    mVersion = snapshot.version;
+
+    Metrics::instance().recordDuration(QStringLiteral("search.sync"), timer.nsecsElapsed() / 1000);
+    Metrics::instance().setGauge(QStringLiteral("search.documents"), mLiveDocuments);
+    Metrics::instance().setGauge(QStringLiteral("search.terms"), mTermIds.size());
+}
+
+QVector<SearchIndex::Hit> SearchIndex::search(const QString &query, Kinds kinds, int limit, const CancellationToken &token) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList tokens = tokenize(query);
+    tokens.removeDuplicates();
+    if (tokens.isEmpty())
+    {
+        return {};
+    }
+
+    QReadLocker locker(&mLock);
+
+    QHash<int, double> scores;
+    bool first = true;
+    for (const QString &queryToken : std::as_const(tokens))
+    {
+        QHash<int, double> best;
+        const auto terms = matchingTerms(queryToken);
+        for (const auto &[term, weight] : terms)
+        {
+            if (token.isCancelled())
+            {
+                return {};
+            }
+            for (const Posting &posting : mTerms.at(term).postings)
+            {
+                if (!first && !scores.contains(posting.document))
+                {
+                    continue;
+                }
+                if (!kinds.testFlag(mDocuments[posting.document].kind))
+                {
+                    continue;
+                }
+                const double score = weight * (posting.inTitle ? kTitleBoost : 1.0);
+                double &current = best[posting.document];
+                current = std::max(current, score);
+            }
+        }
+
+        if (first)
+        {
+            scores = best;
+            first = false;
+        }
+        else
+        {
+            for (auto it = scores.begin(); it != scores.end();)
+            {
+                const auto match = best.constFind(it.key());
+                if (match == best.constEnd())
+                {
+                    it = scores.erase(it);
+                }
+                else
+                {
+                    it.value() += match.value();
+                    ++it;
+                }
+            }
+        }
+        if (scores.isEmpty())
+        {
+            break;
+        }
+    }
+
+    QVector<Hit> hits;
+    hits.reserve(scores.size());
+    for (auto it = scores.cbegin(); it != scores.cend(); ++it)
+    {
+        const Document &document = mDocuments[it.key()];
+        hits.append({document.kind, document.id, document.taskId, it.value()});
+    }
+    locker.unlock();
+
+    const auto byScore = [](const Hit &a, const Hit &b) {
+        return a.score != b.score ? a.score > b.score : a.id < b.id;
+    };
+    if (limit > 0 && hits.size() > limit)
+    {
+        std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), byScore);
+        hits.resize(limit);
+    }
+    else
+    {
+        std::sort(hits.begin(), hits.end(), byScore);
+    }
+
+    Metrics::instance().recordDuration(QStringLiteral("search.query"), timer.nsecsElapsed() / 1000);
+    return hits;
+}
+
+int SearchIndex::documentCount() const
+{
+    QReadLocker locker(&mLock);
+    return mLiveDocuments;
+}
+
+QStringList SearchIndex::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString current;
+    for (const QChar ch : text)
+    {
+        if (ch.isLetterOrNumber())
+        {
+            current.append(ch.toLower());
+        }
+        else if (!current.isEmpty())
+        {
+            tokens.append(current);
+            current.clear();
+        }
+    }
+    if (!current.isEmpty())
+    {
+        tokens.append(current);
+    }
+    return tokens;
+}
+
+void SearchIndex::syncTasks(const QVector<Task> &tasks)
+{
+    QHash<QString, Task> next;
+    next.reserve(tasks.size());
+    for (const Task &task : tasks)
+    {
+        next.insert(task.id(), task);
+
+        // A task's subtasks live in its payload, so a shared payload means nothing
+        // below it changed either.
+        const auto previous = mIndexedTasks.constFind(task.id());
+        if (previous != mIndexedTasks.constEnd() && previous->isSharedWith(task))
+        {
+            continue;
+        }
+
+        indexDocument(TaskKind, task.id(), task.id(), task.title(), task.description());
+
+        QSet<QString> current;
+        for (const Subtask &subtask : task.subtasks())
+        {
+            current.insert(subtask.id());
+            const auto indexed = mIndexedSubtasks.constFind(subtask.id());
+            if (indexed != mIndexedSubtasks.constEnd() && indexed->isSharedWith(subtask))
+            {
+                continue;
+            }
+            indexDocument(SubtaskKind, subtask.id(), task.id(), subtask.title(), subtask.description());
+            mIndexedSubtasks.insert(subtask.id(), subtask);
+        }
+        if (previous != mIndexedTasks.constEnd())
+        {
+            for (const Subtask &subtask : previous->subtasks())
+            {
+                if (!current.contains(subtask.id()))
+                {
+                    removeDocument(SubtaskKind, subtask.id());
+                    mIndexedSubtasks.remove(subtask.id());
+                }
+            }
+        }
+    }
+
+    for (auto it = mIndexedTasks.cbegin(); it != mIndexedTasks.cend(); ++it)
+    {
+        if (next.contains(it.key()))
+        {
+            continue;
+        }
+        removeDocument(TaskKind, it.key());
+        for (const Subtask &subtask : it->subtasks())
+        {
+            removeDocument(SubtaskKind, subtask.id());
+            mIndexedSubtasks.remove(subtask.id());
+        }
+    }
+    mIndexedTasks = next;
+}
+
+void SearchIndex::syncActivities(const QVector<Activity> &activities)
+{
+    QHash<QString, Activity> next;
+    next.reserve(activities.size());
+    for (const Activity &activity : activities)
+    {
+        next.insert(activity.id(), activity);
+        const auto previous = mIndexedActivities.constFind(activity.id());
+        if (previous != mIndexedActivities.constEnd() && previous->isSharedWith(activity))
+        {
+            continue;
+        }
+        indexDocument(ActivityKind, activity.id(), QString(), activity.title(), activity.description());
+    }
+
+    for (auto it = mIndexedActivities.cbegin(); it != mIndexedActivities.cend(); ++it)
+    {
+        if (!next.contains(it.key()))
+        {
+            removeDocument(ActivityKind, it.key());
+        }
+    }
+    mIndexedActivities = next;
+}
+
+void SearchIndex::indexDocument(Kind kind, const QString &id, const QString &taskId, const QString &title, const QString &description)
+{
+    removeDocument(kind, id);
+
+    int index = 0;
+    if (!mFreeDocuments.isEmpty())
+    {
+        index = mFreeDocuments.takeLast();
+    }
+    else
+    {
+        index = static_cast<int>(mDocuments.size());
+        mDocuments.emplace_back();
+    }
+
+    // Title occurrences win over description occurrences of the same term.
+    QHash<int, bool> terms;
+    for (const QString &token : tokenize(title))
+    {
+        terms.insert(termId(token), true);
+    }
+    for (const QString &token : tokenize(description))
+    {
+        const int term = termId(token);
+        if (!terms.contains(term))
+        {
+            terms.insert(term, false);
+        }
+    }
+
+    Document &document = mDocuments[index];
+    document.kind = kind;
+    document.id = id;
+    document.taskId = taskId;
+    document.alive = true;
+    document.terms.clear();
+    document.terms.reserve(terms.size());
+    for (auto it = terms.cbegin(); it != terms.cend(); ++it)
+    {
+        mTerms[it.key()].postings.append({index, it.value()});
+        document.terms.append(it.key());
+    }
+
+    mDocumentIds.insert(documentKey(kind, id), index);
+    ++mLiveDocuments;
+}
+
+void SearchIndex::removeDocument(Kind kind, const QString &id)
+{
+    const auto found = mDocumentIds.constFind(documentKey(kind, id));
+    if (found == mDocumentIds.constEnd())
+    {
+        return;
+    }
+    const int index = found.value();
+    mDocumentIds.erase(found);
+
+    Document &document = mDocuments[index];
+    for (const int term : std::as_const(document.terms))
+    {
+        auto &postings = mTerms[term].postings;
+        postings.erase(std::remove_if(postings.begin(), postings.end(), [index](const Posting &posting) {
+                           return posting.document == index;
+                       }),
+                       postings.end());
+        if (postings.isEmpty())
+        {
+            mEmptyTerms.append(term);
+        }
+    }
+    document.terms.clear();
+    document.alive = false;
+    mFreeDocuments.append(index);
+    --mLiveDocuments;
+}
+
+int SearchIndex::termId(const QString &text)
+{
+    const auto found = mTermIds.constFind(text);
+    if (found != mTermIds.constEnd())
+    {
+        return found.value();
+    }
+
+    int id = 0;
+    if (!mFreeTerms.isEmpty())
+    {
+        id = mFreeTerms.takeLast();
+        mTerms[id] = {text, {}};
+    }
+    else
+    {
+        id = mTerms.size();
+        mTerms.append({text, {}});
+    }
+    mTermIds.insert(text, id);
+    mSortedTermsDirty = true;
+    if (text.size() >= kMinFuzzyLength)
+    {
+        for (const QString &variant : deletions(text))
+        {
+            mDeletions[variant].append(id);
+        }
+    }
+    return id;
+}
+
+void SearchIndex::reclaimTerms()
+{
+    for (const int term : std::as_const(mEmptyTerms))
+    {
+        Term &entry = mTerms[term];
+        // Re-indexing a document may have given the term postings again.
+        if (entry.text.isEmpty() || !entry.postings.isEmpty())
+        {
+            continue;
+        }
+        if (entry.text.size() >= kMinFuzzyLength)
+        {
+            for (const QString &variant : deletions(entry.text))
+            {
+                const auto found = mDeletions.find(variant);
+                if (found != mDeletions.end())
+                {
+                    found->removeOne(term);
+                    if (found->isEmpty())
+                    {
+                        mDeletions.erase(found);
+                    }
+                }
+            }
+        }
+        if (!mSortedTermsDirty)
+        {
+            const auto sorted = std::lower_bound(mSortedTerms.begin(), mSortedTerms.end(), entry.text, [this](int id, const QString &value) {
+                return mTerms.at(id).text < value;
+            });
+            if (sorted != mSortedTerms.end() && *sorted == term)
+            {
+                mSortedTerms.erase(sorted);
+            }
+        }
+        mTermIds.remove(entry.text);
+        entry = Term();
+        mFreeTerms.append(term);
+    }
+    mEmptyTerms.clear();
+}
+
+void SearchIndex::rebuildSortedTerms()
+{
+    mSortedTerms.clear();
+    mSortedTerms.reserve(mTermIds.size());
+    for (int term = 0; term < mTerms.size(); ++term)
+    {
+        if (!mTerms.at(term).text.isEmpty())
+        {
+            mSortedTerms.append(term);
+        }
+    }
+    std::sort(mSortedTerms.begin(), mSortedTerms.end(), [this](int a, int b) {
+        return mTerms.at(a).text < mTerms.at(b).text;
+    });
+    mSortedTermsDirty = false;
+}
+
+QVector<QPair<int, int>> SearchIndex::matchingTerms(const QString &token) const
+{
+    QHash<int, int> weights;
+    const auto offer = [&](int term, int weight) {
+        if (mTerms.at(term).postings.isEmpty())
+        {
+            return;
+        }
+        int &current = weights[term];
+        current = std::max(current, weight);
+    };
+
+    const auto exact = mTermIds.constFind(token);
+    if (exact != mTermIds.constEnd())
+    {
+        offer(exact.value(), kExactWeight);
+    }
+
+    auto it = std::lower_bound(mSortedTerms.cbegin(), mSortedTerms.cend(), token, [this](int term, const QString &value) {
+        return mTerms.at(term).text < value;
+    });
+    // Only terms that still match a document count toward the cap.
+    for (int taken = 0; it != mSortedTerms.cend() && taken < kMaxPrefixTerms && mTerms.at(*it).text.startsWith(token); ++it)
+    {
+        if (!mTerms.at(*it).postings.isEmpty())
+        {
+            offer(*it, kPrefixWeight);
+            ++taken;
+        }
+    }
+
+    if (token.size() >= kMinFuzzyLength)
+    {
+        const auto offerFuzzy = [&](const QVector<int> &candidates) {
+            for (const int term : candidates)
+            {
+                if (withinOneEdit(token, mTerms.at(term).text))
+                {
+                    offer(term, kFuzzyWeight);
+                }
+            }
+        };
+        // Terms one character longer than the token.
+        offerFuzzy(mDeletions.value(token));
+        for (const QString &variant : deletions(token))
+        {
+            // Terms one character shorter, then terms of equal length.
+            const auto shorter = mTermIds.constFind(variant);
+            if (shorter != mTermIds.constEnd())
+            {
+                offerFuzzy({shorter.value()});
+            }
+            offerFuzzy(mDeletions.value(variant));
+        }
+    }
+
+    QVector<QPair<int, int>> terms;
+    terms.reserve(weights.size());
+    for (auto weight = weights.cbegin(); weight != weights.cend(); ++weight)
+    {
+        terms.append({weight.key(), weight.value()});
+    }
+    return terms;
+}
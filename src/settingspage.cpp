@@ -1,4 +1,6 @@
 #include "settingspage.h"
+#include "cohortdialog.h"
+#include "theme.h"
 
 #include <QBoxLayout>
 #include <QButtonGroup>
@@ -18,6 +20,32 @@ void SettingsPage::setJsonManager(JsonManager *manager)
     mJsonManager = manager;
 }
 
+void SettingsPage::setSchedule(const ScheduleIndex &schedule)
+{
+    mSchedule = schedule;
+
+    QVector<int> weekIds;
+    for (int i = 0; i < schedule.weekCount(); ++i)
+    {
+        weekIds.append(i);
+    }
+    QStringList weekLabels;
+    for (const auto &week : schedule.weekNames())
+    {
+        weekLabels.append(tr("%1 Week").arg(week));
+    }
+    rebuildChoices(mWeekGroup, mWeekButtons, weekLabels, weekIds);
+
+    QStringList yearLabels;
+    for (const int yearLevel : schedule.yearLevels())
+    {
+        yearLabels.append(tr("Year %1").arg(yearLevel));
+    }
+    rebuildChoices(mYearGroup, mYearButtons, yearLabels, schedule.yearLevels());
+
+    updateControls();
+}
+
 void SettingsPage::setSettings(const SettingsData &settings)
 {
     mSettings = settings;
@@ -31,35 +59,26 @@ void SettingsPage::createLayout()
     layout->setSpacing(24);
 
     auto *title = new QLabel(tr("Settings"), this);
-    title->setStyleSheet(QStringLiteral("font-size: 24px; font-weight: bold;"));
+    Theme::setRole(title, "pageTitle");
     layout->addWidget(title);
 
     auto *weekSection = new QFrame(this);
-    weekSection->setStyleSheet(QStringLiteral("QFrame { border: 1px solid #E0E0E0; border-radius: 16px; background: #FFFFFF; padding: 16px; }") );
+    Theme::setRole(weekSection, "section");
     auto *weekLayout = new QVBoxLayout(weekSection);
     weekLayout->setSpacing(12);
 
     auto *weekLabel = new QLabel(tr("Timetable Week Settings"), weekSection);
-    weekLabel->setStyleSheet(QStringLiteral("font-size: 18px; font-weight: bold;"));
+    Theme::setRole(weekLabel, "sectionTitle");
     weekLayout->addWidget(weekLabel);
 
     auto *weekControls = new QHBoxLayout();
     weekControls->setSpacing(12);
-    auto *weekALabel = new QPushButton(tr("A Week"), weekSection);
-    auto *weekBLabel = new QPushButton(tr("B Week"), weekSection);
-    weekALabel->setCheckable(true);
-    weekBLabel->setCheckable(true);
-    weekALabel->setStyleSheet(QStringLiteral("QPushButton { padding: 8px 16px; border-radius: 18px; border: 1px solid #E0E0E0; }"
-                                          "QPushButton:checked { background: #000000; color: #FFFFFF; }"));
-    weekBLabel->setStyleSheet(weekALabel->styleSheet());
-
+    mWeekButtons = new QHBoxLayout();
+    mWeekButtons->setSpacing(12);
     mWeekGroup = new QButtonGroup(this);
-    mWeekGroup->addButton(weekALabel, 0);
-    mWeekGroup->addButton(weekBLabel, 1);
 
     weekControls->addWidget(new QLabel(tr("Current Week:"), weekSection));
-    weekControls->addWidget(weekALabel);
-    weekControls->addWidget(weekBLabel);
+    weekControls->addLayout(mWeekButtons);
     weekControls->addStretch(1);
 
     weekLayout->addLayout(weekControls);
@@ -67,43 +86,71 @@ void SettingsPage::createLayout()
     layout->addWidget(weekSection);
 
     auto *yearSection = new QFrame(this);
-    yearSection->setStyleSheet(weekSection->styleSheet());
+    Theme::setRole(yearSection, "section");
     auto *yearLayout = new QVBoxLayout(yearSection);
     yearLayout->setSpacing(12);
 
-    auto *yearLabel = new QLabel(tr("Wednesday Schedule"), yearSection);
-    yearLabel->setStyleSheet(QStringLiteral("font-size: 18px; font-weight: bold;"));
+    auto *yearLabel = new QLabel(tr("Year Level Schedule"), yearSection);
+    Theme::setRole(yearLabel, "sectionTitle");
     yearLayout->addWidget(yearLabel);
 
     auto *yearControls = new QHBoxLayout();
     yearControls->setSpacing(12);
-    auto *year10 = new QPushButton(tr("Year 10"), yearSection);
-    auto *year11 = new QPushButton(tr("Year 11"), yearSection);
-    year10->setCheckable(true);
-    year11->setCheckable(true);
-    year10->setStyleSheet(weekALabel->styleSheet());
-    year11->setStyleSheet(weekALabel->styleSheet());
-
+    mYearButtons = new QHBoxLayout();
+    mYearButtons->setSpacing(12);
     mYearGroup = new QButtonGroup(this);
-    mYearGroup->addButton(year10, 10);
-    mYearGroup->addButton(year11, 11);
 
     yearControls->addWidget(new QLabel(tr("Year Level:"), yearSection));
-    yearControls->addWidget(year10);
-    yearControls->addWidget(year11);
+    yearControls->addLayout(mYearButtons);
     yearControls->addStretch(1);
 
     yearLayout->addLayout(yearControls);
 
     layout->addWidget(yearSection);
+
+    auto *cohortSection = new QFrame(this);
+    Theme::setRole(cohortSection, "section");
+    auto *cohortLayout = new QVBoxLayout(cohortSection);
+    cohortLayout->setSpacing(12);
+
+    auto *cohortLabel = new QLabel(tr("Cohort Planning"), cohortSection);
+    Theme::setRole(cohortLabel, "sectionTitle");
+    cohortLayout->addWidget(cohortLabel);
+
+    auto *cohortControls = new QHBoxLayout();
+    cohortControls->setSpacing(12);
+    auto *cohortHint = new QLabel(tr("Find times when a group of students is free, from their data directories."), cohortSection);
+    Theme::setRole(cohortHint, "secondary");
+    auto *cohortButton = new QPushButton(tr("Find Common Free Time..."), cohortSection);
+    Theme::setRole(cohortButton, "secondary");
+    cohortButton->setCursor(Qt::PointingHandCursor);
+    cohortControls->addWidget(cohortHint, 1);
+    cohortControls->addWidget(cohortButton);
+    cohortLayout->addLayout(cohortControls);
+
+    layout->addWidget(cohortSection);
     layout->addStretch(1);
 
+    connect(cohortButton, &QPushButton::clicked, this, [this]() {
+        if (!mJsonManager)
+        {
+            return;
+        }
+        CohortDialog dialog(mJsonManager, this);
+        dialog.exec();
+    });
+
     connect(mWeekGroup, &QButtonGroup::idToggled, this, [this](int id, bool checked) {
         if (!checked)
         {
             return;
         }
-        mSettings.currentWeek = id == 0 ? QStringLiteral("A") : QStringLiteral("B");
+        const QString week = mSchedule.weekNames().value(id);
+        if (week.isEmpty() || week.compare(mSettings.currentWeek, Qt::CaseInsensitive) == 0)
+        {
+            return;
+        }
+        mSettings.currentWeek = week;
         emit settingsChanged(mSettings);
     });
 
@@ -112,25 +159,47 @@ void SettingsPage::createLayout()
         {
             return;
         }
+        if (id == mSettings.yearLevel)
+        {
+            return;
+        }
         mSettings.yearLevel = id;
         emit settingsChanged(mSettings);
     });
 }
 
+void SettingsPage::rebuildChoices(QButtonGroup *group, QHBoxLayout *layout, const QStringList &labels, const QVector<int> &ids)
+{
+    const auto buttons = group->buttons();
+    for (auto *button : buttons)
+    {
+        group->removeButton(button);
+        button->deleteLater();
+    }
+
+    for (int i = 0; i < labels.size() && i < ids.size(); ++i)
+    {
+        auto *button = new QPushButton(labels.at(i), this);
+        button->setCheckable(true);
+        Theme::setRole(button, "toggle");
+        group->addButton(button, ids.at(i));
+        layout->addWidget(button);
+    }
+}
+
 void SettingsPage::updateControls()
 {
     if (mWeekGroup)
     {
-        const int id = mSettings.currentWeek.compare(QStringLiteral("B"), Qt::CaseInsensitive) == 0 ? 1 : 0;
-        if (auto *button = mWeekGroup->button(id))
+        if (auto *button = mWeekGroup->button(mSchedule.weekIndex(mSettings.currentWeek)))
         {
             button->setChecked(true);
         }
     }
 
-    if (mYearGroup)
+    if (mYearGroup && !mSchedule.yearLevels().isEmpty())
     {
-        const int id = mSettings.yearLevel >= 11 ? 11 : 10;
+        const int id = mSchedule.yearLevels().at(mSchedule.yearIndex(mSettings.yearLevel));
         if (auto *button = mYearGroup->button(id))
         {
             button->setChecked(true);
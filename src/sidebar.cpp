@@ -1,6 +1,8 @@
 #include "sidebar.h"
 
 #include <QBoxLayout>
+#include <QCursor>
+#include <QEnterEvent>
 #include <QEvent>
 #include <QGraphicsDropShadowEffect>
 
@@ -14,6 +16,7 @@ struct SidebarItem
 const QList<SidebarItem> kItems = {
     {QStringLiteral("Homepage")},
     {QStringLiteral("Timetable")},
+    {QStringLiteral("Timeline")},
     {QStringLiteral("Tasks")},
     {QStringLiteral("Settings")}};
 
@@ -26,7 +29,6 @@ Sidebar::Sidebar(QWidget *parent)
     setObjectName(QStringLiteral("Sidebar"));
     setFrameShape(QFrame::NoFrame);
     setAutoFillBackground(true);
-    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
 
     auto *shadow = new QGraphicsDropShadowEffect(this);
     shadow->setBlurRadius(16.0);
@@ -34,23 +36,33 @@ Sidebar::Sidebar(QWidget *parent)
     shadow->setColor(QColor(0, 0, 0, 30));
     setGraphicsEffect(shadow);
 
-    setStyleSheet(QStringLiteral("#Sidebar { background: #FFFFFF; border-right: 1px solid #E0E0E0; }\n"
-                                 "#Sidebar QToolButton { text-align: left; padding: 12px 16px; font-size: 15px; border: none; }\n"
-                                 "#Sidebar QToolButton:hover { background: #F5F5F5; }\n"
-                                 "#Sidebar QToolButton:checked { background: #E0E0E0; font-weight: bold; }");
-
-    mAnimation = new QPropertyAnimation(this, "maximumWidth", this);
+    mAnimation = new QPropertyAnimation(this, "pos", this);
     mAnimation->setDuration(kAnimationDurationMs);
     mAnimation->setEasingCurve(QEasingCurve::InOutQuad);
-    setMaximumWidth(0);
-    setMinimumWidth(0);
+    connect(mAnimation, &QPropertyAnimation::finished, this, [this]() {
+        // The pointer may have left while the panel was still sliding in.
+        if (mExpanded && !containsCursor())
+        {
+            collapse();
+        }
+    });
 
     rebuildUi();
+    move(-mExpandedWidth, 0);
 }
 
-void Sidebar::setExpandedWidth(int width)
+void Sidebar::setOverlayGeometry(int expandedWidth, int height)
 {
-    mExpandedWidth = width;
+    mExpandedWidth = expandedWidth;
+    resize(expandedWidth, height);
+    if (mAnimation->state() == QAbstractAnimation::Running)
+    {
+        mAnimation->setEndValue(QPoint(mExpanded ? 0 : -expandedWidth, 0));
+    }
+    else
+    {
+        move(mExpanded ? 0 : -expandedWidth, 0);
+    }
 }
 
 int Sidebar::expandedWidth() const
@@ -60,41 +72,50 @@ int Sidebar::expandedWidth() const
 
 void Sidebar::expand()
 {
-    if (isExpanded())
+    if (mExpanded)
     {
         return;
     }
-    animateToWidth(mExpandedWidth);
+    mExpanded = true;
+    raise();
+    animateToX(0);
 }
 
 void Sidebar::collapse()
 {
-    if (!isExpanded())
+    if (!mExpanded)
     {
         return;
     }
-    animateToWidth(0);
+    mExpanded = false;
+    animateToX(-mExpandedWidth);
 }
 
 bool Sidebar::isExpanded() const
 {
-    return maximumWidth() > 0;
+    return mExpanded;
 }
 
-void Sidebar::enterEvent(QEvent *event)
+void Sidebar::enterEvent(QEnterEvent *event)
 {
-    mExplicitHover = true;
     expand();
     QFrame::enterEvent(event);
 }
 
 void Sidebar::leaveEvent(QEvent *event)
 {
-    mExplicitHover = false;
     collapse();
     QFrame::leaveEvent(event);
 }
 
+void Sidebar::setCurrentIndex(int index)
+{
+    if (index >= 0 && index < mButtons.size())
+    {
+        mButtons.at(index)->setChecked(true);
+    }
+}
+
 void Sidebar::rebuildUi()
 {
     auto *layout = new QVBoxLayout(this);
@@ -121,15 +142,31 @@ void Sidebar::rebuildUi()
     layout->addStretch(1);
 }
 
-void Sidebar::animateToWidth(int width)
+void Sidebar::animateToX(int x)
 {
     if (mAnimation->state() == QAbstractAnimation::Running)
     {
         mAnimation->stop();
     }
 
-    mAnimation->setStartValue(maximumWidth());
-    mAnimation->setEndValue(width);
+    mAnimation->setStartValue(pos());
+    mAnimation->setEndValue(QPoint(x, 0));
     mAnimation->start();
-    setMinimumWidth(width);
+}
+
+bool Sidebar::containsCursor() const
+{
+    return rect().contains(mapFromGlobal(QCursor::pos()));
+}
+
+SidebarHotZone::SidebarHotZone(QWidget *parent)
+    : QWidget(parent)
+{
+    setObjectName(QStringLiteral("SidebarHotZone"));
+}
+
+void SidebarHotZone::enterEvent(QEnterEvent *event)
+{
+    emit entered();
+    QWidget::enterEvent(event);
 }
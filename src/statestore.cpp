@@ -0,0 +1,67 @@
+#include "statestore.h"
+
+#include "metrics.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <atomic>
+
+StateStore::StateStore(QObject *parent)
+    : QObject(parent)
+    , mCurrent(std::make_shared<const AppSnapshot>())
+{
+}
+
+AppSnapshotPtr StateStore::snapshot() const
+{
+    return std::atomic_load_explicit(&mCurrent, std::memory_order_acquire);
+}
+
+void StateStore::publishActivities(const QVector<Activity> &activities)
+{
+    publish([&](AppSnapshot &next) {
+        next.activities = activities;
+    });
+}
+
+void StateStore::publishTasks(const QVector<Task> &tasks)
+{
+    publish([&](AppSnapshot &next) {
+        next.tasks = tasks;
+    });
+}
+
+void StateStore::publishSettings(const SettingsData &settings)
+{
+    publish([&](AppSnapshot &next) {
+        next.settings = settings;
+    });
+}
+
+void StateStore::publishSchedule(const ScheduleIndex &schedule)
+{
+    publish([&](AppSnapshot &next) {
+        next.schedule = schedule;
+    });
+}
+
+void StateStore::publish(const std::function<void(AppSnapshot &)> &change)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    quint64 version = 0;
+    {
+        // Writers are serialised so no published version is lost; readers never
+        // take this lock.
+        QMutexLocker locker(&mWriteMutex);
+        auto next = std::make_shared<AppSnapshot>(*mCurrent);
+        change(*next);
+        version = ++next->version;
+        std::atomic_store_explicit(&mCurrent, AppSnapshotPtr(std::move(next)), std::memory_order_release);
+    }
+
+    Metrics::instance().recordDuration(QStringLiteral("state.publish"), timer.nsecsElapsed() / 1000);
+    emit published(version);
+}
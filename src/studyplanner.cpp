@@ -0,0 +1,162 @@
+#include "studyplanner.h"
+
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QUuid>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+constexpr int kStudyDayStartMinute = 8 * 60;
+constexpr int kStudyDayEndMinute = 21 * 60;
+constexpr int kMinSessionSlots = 30 / FreeTimeMap::kSlotMinutes;
+constexpr int kMaxSessionSlots = 120 / FreeTimeMap::kSlotMinutes;
+const QColor kStudyColor(QStringLiteral("#7E57C2"));
+
+struct Demand
+{
+    QString subtaskId;
+    QString title;
+    QDateTime deadline;
+    double weight = 0.0;
+    int slots = 0;
+};
+}
+
+FreeTimeMap StudyPlanner::availability(const AppSnapshot &snapshot, const QDateTime &from)
+{
+    FreeTimeMap map(from.date(), kHorizonDays);
+    map.markOutsideHours(kStudyDayStartMinute, kStudyDayEndMinute);
+    map.markSchedule(snapshot.schedule, snapshot.settings);
+    map.markActivities(snapshot.activities);
+    return map;
+}
+
+StudyPlanner::Plan StudyPlanner::plan(const Task &task, int minutes, FreeTimeMap &map, const QDateTime &notBefore)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Plan result;
+    result.requestedMinutes = minutes;
+
+    QVector<Demand> demands;
+    double totalWeight = 0.0;
+    for (const Subtask &subtask : task.subtasks())
+    {
+        if (!subtask.isCompleted())
+        {
+            totalWeight += std::max(0.0, subtask.weighting());
+            demands.append({subtask.id(), subtask.title(), subtask.dueTime(), std::max(0.0, subtask.weighting()), 0});
+        }
+    }
+    if (task.subtasks().isEmpty())
+    {
+        demands.append({QString(), task.title(), QDateTime(), 0.0, 0});
+    }
+    if (demands.isEmpty())
+    {
+        result.nothingLeft = true;
+        return result;
+    }
+
+    // Whole slots only, so the plan never exceeds the request. Shares are rounded
+    // down and the slots lost to rounding go to the largest remainders.
+    const int totalSlots = minutes / FreeTimeMap::kSlotMinutes;
+    QVector<double> remainders;
+    remainders.reserve(demands.size());
+    int assigned = 0;
+    for (Demand &demand : demands)
+    {
+        // Unweighted subtasks share the time equally.
+        const double share = totalWeight > 0.0 ? demand.weight / totalWeight : 1.0 / demands.size();
+        const double exact = totalSlots * share;
+        demand.slots = static_cast<int>(std::floor(exact));
+        remainders.append(exact - demand.slots);
+        assigned += demand.slots;
+        if (!demand.deadline.isValid())
+        {
+            demand.deadline = task.endTime();
+        }
+    }
+    QVector<int> order(demands.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&remainders](int a, int b) {
+        return remainders.at(a) > remainders.at(b);
+    });
+    for (int i = 0; i < std::max(0, totalSlots - assigned) && i < order.size(); ++i)
+    {
+        ++demands[order.at(i)].slots;
+    }
+
+    // Earliest deadline first; subtasks without any deadline go last.
+    std::stable_sort(demands.begin(), demands.end(), [](const Demand &a, const Demand &b) {
+        if (a.deadline.isValid() != b.deadline.isValid())
+        {
+            return a.deadline.isValid();
+        }
+        return a.deadline.isValid() && a.deadline < b.deadline;
+    });
+
+    const int firstSlot = map.slotAt(notBefore, true);
+    int carried = 0;
+    for (const Demand &demand : demands)
+    {
+        const int deadlineSlot = demand.deadline.isValid() ? map.slotAt(demand.deadline) : map.slotCount();
+        // Time too short for a session of its own moves on to the next subtask.
+        int remaining = demand.slots + carried;
+        while (remaining >= kMinSessionSlots)
+        {
+            const int first = map.findFree(kMinSessionSlots, firstSlot, deadlineSlot);
+            if (first < 0)
+            {
+                break;
+            }
+            // The run starting at first is at least the minimum long; extend it up to a full session.
+            const int limit = std::min({first + remaining, first + kMaxSessionSlots, deadlineSlot});
+            int length = map.freeRuns(first, limit, 1).first().slotCount;
+            // Stop short where the rest would otherwise be below the minimum session.
+            const int rest = remaining - length;
+            if (rest > 0 && rest < kMinSessionSlots && remaining - kMinSessionSlots >= kMinSessionSlots)
+            {
+                length = remaining - kMinSessionSlots;
+            }
+            const QDateTime start = map.timeAt(first);
+            const QDateTime end = map.timeAt(first + length);
+            map.markBusy(start, end);
+            result.sessions.append({demand.subtaskId, demand.title, start, end});
+            result.plannedMinutes += length * FreeTimeMap::kSlotMinutes;
+            remaining -= length;
+        }
+        carried = remaining < kMinSessionSlots ? remaining : 0;
+    }
+
+    std::sort(result.sessions.begin(), result.sessions.end(), [](const Session &a, const Session &b) {
+        return a.start < b.start;
+    });
+    Metrics::instance().recordDuration(QStringLiteral("planner.plan"), timer.nsecsElapsed() / 1000);
+    return result;
+}
+
+QVector<Activity> StudyPlanner::toActivities(const Plan &plan, const Task &task)
+{
+    QVector<Activity> activities;
+    activities.reserve(plan.sessions.size());
+    for (const Session &session : plan.sessions)
+    {
+        Activity activity;
+        activity.setId(QUuid::createUuid().toString(QUuid::WithoutBraces));
+        activity.setTitle(QCoreApplication::translate("StudyPlanner", "Study: %1").arg(session.title));
+        activity.setDescription(QCoreApplication::translate("StudyPlanner", "Planned for task \"%1\".").arg(task.title()));
+        activity.setStartTime(session.start);
+        activity.setEndTime(session.end);
+        activity.setColor(kStudyColor);
+        activities.append(activity);
+    }
+    return activities;
+}
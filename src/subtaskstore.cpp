@@ -0,0 +1,232 @@
+#include "subtaskstore.h"
+
+#include <algorithm>
+
+namespace
+{
+template <typename T>
+void splice(QVector<T> &values, int first, int removeCount, const QVector<T> &replacement)
+{
+    QVector<T> result = values.mid(0, first);
+    result.reserve(values.size() - removeCount + replacement.size());
+    result += replacement;
+    result += values.mid(first + removeCount);
+    values = result;
+}
+}
+
+void SubtaskStore::rebuild(const QVector<Task> &tasks)
+{
+    clear();
+
+    int total = 0;
+    for (const auto &task : tasks)
+    {
+        total += task.subtasks().size();
+    }
+
+    mWeightings.reserve(total);
+    mCompleted.reserve(total);
+    mDueSecs.reserve(total);
+    mTaskOffsets.reserve(tasks.size() + 1);
+
+    mTaskOffsets.append(0);
+    for (int i = 0; i < tasks.size(); ++i)
+    {
+        appendSubtasks(tasks.at(i));
+        mTaskOffsets.append(mWeightings.size());
+    }
+}
+
+void SubtaskStore::replaceTask(int taskIndex, const Task &task)
+{
+    if (taskIndex < 0 || taskIndex >= taskCount())
+    {
+        return;
+    }
+
+    const int first = mTaskOffsets.at(taskIndex);
+    const int oldCount = mTaskOffsets.at(taskIndex + 1) - first;
+    const int newCount = task.subtasks().size();
+
+    if (oldCount == newCount)
+    {
+        for (int i = 0; i < newCount; ++i)
+        {
+            const auto &subtask = task.subtasks().at(i);
+            mWeightings[first + i] = std::max(0.0, subtask.weighting());
+            mCompleted[first + i] = subtask.isCompleted() ? 1 : 0;
+            mDueSecs[first + i] = subtask.dueTime().isValid() ? subtask.dueTime().toSecsSinceEpoch() : kNoDueTime;
+        }
+        return;
+    }
+
+    QVector<double> weightings;
+    QVector<quint8> completed;
+    QVector<qint64> dueSecs;
+    for (const auto &subtask : task.subtasks())
+    {
+        weightings.append(std::max(0.0, subtask.weighting()));
+        completed.append(subtask.isCompleted() ? 1 : 0);
+        dueSecs.append(subtask.dueTime().isValid() ? subtask.dueTime().toSecsSinceEpoch() : kNoDueTime);
+    }
+
+    splice(mWeightings, first, oldCount, weightings);
+    splice(mCompleted, first, oldCount, completed);
+    splice(mDueSecs, first, oldCount, dueSecs);
+
+    const int delta = newCount - oldCount;
+    for (int i = taskIndex + 1; i < mTaskOffsets.size(); ++i)
+    {
+        mTaskOffsets[i] += delta;
+    }
+}
+
+void SubtaskStore::clear()
+{
+    mWeightings.clear();
+    mCompleted.clear();
+    mDueSecs.clear();
+    mTaskOffsets.clear();
+}
+
+int SubtaskStore::size() const
+{
+    return mWeightings.size();
+}
+
+int SubtaskStore::taskCount() const
+{
+    return std::max(0, static_cast<int>(mTaskOffsets.size()) - 1);
+}
+
+int SubtaskStore::firstSubtask(int taskIndex) const
+{
+    return mTaskOffsets.at(taskIndex);
+}
+
+int SubtaskStore::subtaskCount(int taskIndex) const
+{
+    return mTaskOffsets.at(taskIndex + 1) - mTaskOffsets.at(taskIndex);
+}
+
+double SubtaskStore::weighting(int index) const
+{
+    return mWeightings.at(index);
+}
+
+bool SubtaskStore::isCompleted(int index) const
+{
+    return mCompleted.at(index) != 0;
+}
+
+qint64 SubtaskStore::dueSecs(int index) const
+{
+    return mDueSecs.at(index);
+}
+
+double SubtaskStore::progress(int taskIndex) const
+{
+    if (taskIndex < 0 || taskIndex >= taskCount())
+    {
+        return 0.0;
+    }
+
+    const int first = mTaskOffsets.at(taskIndex);
+    const int last = mTaskOffsets.at(taskIndex + 1);
+    const double *weights = mWeightings.constData();
+    const quint8 *done = mCompleted.constData();
+
+    // Four independent accumulators break the floating point dependency chain so
+    // the loop can be vectorised without relaxing IEEE semantics.
+    double total[4] = {0.0, 0.0, 0.0, 0.0};
+    double completed[4] = {0.0, 0.0, 0.0, 0.0};
+    int i = first;
+    for (; i + 4 <= last; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            total[lane] += weights[i + lane];
+            completed[lane] += weights[i + lane] * done[i + lane];
+        }
+    }
+    for (; i < last; ++i)
+    {
+        total[0] += weights[i];
+        completed[0] += weights[i] * done[i];
+    }
+
+    const double totalWeight = (total[0] + total[1]) + (total[2] + total[3]);
+    const double completedWeight = (completed[0] + completed[1]) + (completed[2] + completed[3]);
+    if (totalWeight <= 0.0)
+    {
+        return 0.0;
+    }
+    return (completedWeight / totalWeight) * 100.0;
+}
+
+QVector<double> SubtaskStore::progressAll() const
+{
+    QVector<double> result(taskCount(), 0.0);
+    for (int t = 0; t < result.size(); ++t)
+    {
+        result[t] = progress(t);
+    }
+    return result;
+}
+
+int SubtaskStore::overdueCount(qint64 nowSecs) const
+{
+    const qint64 *due = mDueSecs.constData();
+    const quint8 *done = mCompleted.constData();
+    const int count = size();
+
+    int overdue = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        overdue += static_cast<int>((done[i] == 0) & (due[i] < nowSecs));
+    }
+    return overdue;
+}
+
+int SubtaskStore::dueBetweenCount(qint64 fromSecs, qint64 toSecs) const
+{
+    const qint64 *due = mDueSecs.constData();
+    const quint8 *done = mCompleted.constData();
+    const int count = size();
+
+    int matches = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        matches += static_cast<int>((done[i] == 0) & (due[i] >= fromSecs) & (due[i] < toSecs));
+    }
+    return matches;
+}
+
+QVector<qint64> SubtaskStore::openDueTimes(int taskIndex) const
+{
+    const qint64 *due = mDueSecs.constData();
+    const quint8 *done = mCompleted.constData();
+    const int last = mTaskOffsets.at(taskIndex + 1);
+
+    QVector<qint64> times;
+    for (int i = mTaskOffsets.at(taskIndex); i < last; ++i)
+    {
+        if (!done[i] && due[i] != kNoDueTime)
+        {
+            times.append(due[i]);
+        }
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+void SubtaskStore::appendSubtasks(const Task &task)
+{
+    for (const auto &subtask : task.subtasks())
+    {
+        mWeightings.append(std::max(0.0, subtask.weighting()));
+        mCompleted.append(subtask.isCompleted() ? 1 : 0);
+        mDueSecs.append(subtask.dueTime().isValid() ? subtask.dueTime().toSecsSinceEpoch() : kNoDueTime);
+    }
+}
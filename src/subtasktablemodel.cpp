@@ -0,0 +1,241 @@
+#include "subtasktablemodel.h"
+
+#include <QDateTimeEdit>
+#include <QDoubleSpinBox>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+
+#include <algorithm>
+
+namespace
+{
+const QString kDueFormat = QStringLiteral("yyyy-MM-dd HH:mm");
+// Lines of description visible while editing; the editor overlaps the rows below.
+constexpr int kDescriptionEditorLines = 4;
+}
+
+SubtaskTableModel::SubtaskTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void SubtaskTableModel::setSubtasks(const QVector<Subtask> &subtasks)
+{
+    beginResetModel();
+    mSubtasks = subtasks;
+    endResetModel();
+}
+
+const Subtask &SubtaskTableModel::subtaskAt(int row) const
+{
+    return mSubtasks.at(row);
+}
+
+void SubtaskTableModel::insertSubtask(int row, const Subtask &subtask)
+{
+    row = qBound(0, row, static_cast<int>(mSubtasks.size()));
+    beginInsertRows(QModelIndex(), row, row);
+    mSubtasks.insert(row, subtask);
+    endInsertRows();
+}
+
+void SubtaskTableModel::removeSubtask(int row)
+{
+    if (row < 0 || row >= mSubtasks.size())
+    {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    mSubtasks.removeAt(row);
+    endRemoveRows();
+}
+
+bool SubtaskTableModel::moveSubtask(int from, int to)
+{
+    if (from < 0 || from >= mSubtasks.size() || to < 0 || to >= mSubtasks.size() || from == to)
+    {
+        return false;
+    }
+    // beginMoveRows takes the destination as the row the item is inserted before.
+    const int destination = to > from ? to + 1 : to;
+    if (!beginMoveRows(QModelIndex(), from, from, QModelIndex(), destination))
+    {
+        return false;
+    }
+    mSubtasks.move(from, to);
+    endMoveRows();
+    return true;
+}
+
+int SubtaskTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(mSubtasks.size());
+}
+
+int SubtaskTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SubtaskTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= mSubtasks.size())
+    {
+        return {};
+    }
+
+    const Subtask &subtask = mSubtasks.at(index.row());
+    if (index.column() == DoneColumn)
+    {
+        return role == Qt::CheckStateRole ? QVariant(subtask.isCompleted() ? Qt::Checked : Qt::Unchecked) : QVariant();
+    }
+    if (role != Qt::DisplayRole && role != Qt::EditRole)
+    {
+        return {};
+    }
+
+    switch (index.column())
+    {
+    case TitleColumn:
+        return subtask.title();
+    case DescriptionColumn:
+        return subtask.description();
+    case DueColumn:
+        return role == Qt::EditRole ? QVariant(subtask.dueTime()) : QVariant(subtask.dueTime().toString(kDueFormat));
+    case WeightColumn:
+        return role == Qt::EditRole ? QVariant(subtask.weighting()) : QVariant(QString::number(subtask.weighting(), 'f', 2));
+    default:
+        return {};
+    }
+}
+
+bool SubtaskTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= mSubtasks.size())
+    {
+        return false;
+    }
+
+    Subtask &subtask = mSubtasks[index.row()];
+    if (index.column() == DoneColumn)
+    {
+        if (role != Qt::CheckStateRole)
+        {
+            return false;
+        }
+        subtask.setCompleted(static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked);
+    }
+    else
+    {
+        if (role != Qt::EditRole)
+        {
+            return false;
+        }
+        switch (index.column())
+        {
+        case TitleColumn:
+            subtask.setTitle(value.toString());
+            break;
+        case DescriptionColumn:
+            subtask.setDescription(value.toString());
+            break;
+        case DueColumn:
+            subtask.setDueTime(value.toDateTime());
+            break;
+        case WeightColumn:
+            subtask.setWeighting(value.toDouble());
+            break;
+        default:
+            return false;
+        }
+    }
+
+    emit dataChanged(index, index, {role, Qt::DisplayRole});
+    emit subtaskEdited(index.row(), subtask);
+    return true;
+}
+
+QVariant SubtaskTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    {
+        return {};
+    }
+
+    switch (section)
+    {
+    case DoneColumn:
+        return QString();
+    case TitleColumn:
+        return tr("Title");
+    case DescriptionColumn:
+        return tr("Description");
+    case DueColumn:
+        return tr("Due");
+    case WeightColumn:
+        return tr("Weight");
+    default:
+        return {};
+    }
+}
+
+Qt::ItemFlags SubtaskTableModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+    {
+        return Qt::NoItemFlags;
+    }
+    if (index.column() == DoneColumn)
+    {
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+QWidget *SubtaskItemDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    switch (index.column())
+    {
+    case SubtaskTableModel::TitleColumn:
+    {
+        auto *editor = new QLineEdit(parent);
+        editor->setPlaceholderText(tr("Subtask title"));
+        return editor;
+    }
+    case SubtaskTableModel::DescriptionColumn:
+    {
+        // Enter inserts a line break; the delegate commits on focus-out and Tab.
+        auto *editor = new QPlainTextEdit(parent);
+        editor->setPlaceholderText(tr("Description"));
+        editor->setTabChangesFocus(true);
+        return editor;
+    }
+    case SubtaskTableModel::DueColumn:
+    {
+        auto *editor = new QDateTimeEdit(parent);
+        editor->setDisplayFormat(kDueFormat);
+        return editor;
+    }
+    case SubtaskTableModel::WeightColumn:
+    {
+        auto *editor = new QDoubleSpinBox(parent);
+        editor->setRange(0.0, 1000.0);
+        editor->setDecimals(2);
+        return editor;
+    }
+    default:
+        return QStyledItemDelegate::createEditor(parent, option, index);
+    }
+}
+
+void SubtaskItemDelegate::updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (index.column() != SubtaskTableModel::DescriptionColumn)
+    {
+        QStyledItemDelegate::updateEditorGeometry(editor, option, index);
+        return;
+    }
+    QRect rect = option.rect;
+    rect.setHeight(std::max(rect.height(), option.fontMetrics.lineSpacing() * kDescriptionEditorLines + 12));
+    editor->setGeometry(rect);
+}
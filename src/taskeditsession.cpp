@@ -0,0 +1,70 @@
+#include "taskeditsession.h"
+
+#include "metrics.h"
+
+#include <QElapsedTimer>
+
+namespace
+{
+constexpr int kIdleCommitMs = 750;
+}
+
+TaskEditSession::TaskEditSession(QObject *parent)
+    : QObject(parent)
+{
+    mIdleTimer = new QTimer(this);
+    mIdleTimer->setSingleShot(true);
+    mIdleTimer->setInterval(kIdleCommitMs);
+    connect(mIdleTimer, &QTimer::timeout, this, &TaskEditSession::commit);
+}
+
+void TaskEditSession::begin(const Task &task)
+{
+    commit();
+    mTask = task;
+    mDirty = false;
+}
+
+const Task &TaskEditSession::task() const
+{
+    return mTask;
+}
+
+bool TaskEditSession::isDirty() const
+{
+    return mDirty;
+}
+
+void TaskEditSession::update(const std::function<void(Task &)> &change)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    change(mTask);
+    mDirty = true;
+    emit edited(mTask);
+    mIdleTimer->start();
+
+    Metrics::instance().recordDuration(QStringLiteral("taskEdit.update"), timer.nsecsElapsed() / 1000);
+}
+
+void TaskEditSession::commit()
+{
+    mIdleTimer->stop();
+    if (!mDirty)
+    {
+        return;
+    }
+    mDirty = false;
+
+    QElapsedTimer timer;
+    timer.start();
+    emit committed(mTask);
+    Metrics::instance().recordDuration(QStringLiteral("taskEdit.commit"), timer.nsecsElapsed() / 1000);
+}
+
+void TaskEditSession::discard()
+{
+    mIdleTimer->stop();
+    mDirty = false;
+}
@@ -0,0 +1,181 @@
+#include "taskscheduler.h"
+
+#include "metrics.h"
+
+#include <QString>
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+const char *const kLaneNames[] = {"interactive", "background", "idle"};
+
+// Identifies the scheduler and worker the current thread belongs to, so jobs
+// posted from inside a job stay on that worker's deques.
+thread_local const TaskScheduler *tScheduler = nullptr;
+thread_local int tWorkerIndex = -1;
+
+qint64 nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString metricName(const char *metric, TaskScheduler::Priority priority)
+{
+    return QStringLiteral("scheduler.%1.%2").arg(QLatin1String(metric), QLatin1String(kLaneNames[priority]));
+}
+}
+
+CancellationToken::CancellationToken()
+    : mCancelled(std::make_shared<std::atomic_bool>(false))
+{
+}
+
+void CancellationToken::cancel()
+{
+    mCancelled->store(true, std::memory_order_release);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return mCancelled->load(std::memory_order_acquire);
+}
+
+TaskScheduler::TaskScheduler(int threadCount, QObject *parent)
+    : QObject(parent)
+{
+    if (threadCount <= 0)
+    {
+        // One core is left to the GUI thread.
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    mWorkers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        mWorkers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < threadCount; ++i)
+    {
+        mWorkers[i]->thread = std::thread([this, i]() {
+            workerLoop(i);
+        });
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    for (auto &worker : mWorkers)
+    {
+        worker->thread.join();
+    }
+}
+
+void TaskScheduler::post(Priority priority, std::function<void()> job, const CancellationToken &token)
+{
+    const int index = tScheduler == this ? tWorkerIndex : static_cast<int>(mNextWorker++ % mWorkers.size());
+    {
+        Worker &worker = *mWorkers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.lanes[priority].push_back({std::move(job), token, nowNs()});
+    }
+    updateDepth(priority, 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        ++mPending;
+    }
+    mWake.notify_one();
+}
+
+int TaskScheduler::threadCount() const
+{
+    return static_cast<int>(mWorkers.size());
+}
+
+void TaskScheduler::workerLoop(int index)
+{
+    tScheduler = this;
+    tWorkerIndex = index;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait(lock, [this]() {
+                return mStopping || mPending > 0;
+            });
+            if (mStopping)
+            {
+                return;
+            }
+        }
+
+        Job job;
+        Priority priority = Interactive;
+        if (!takeJob(index, job, priority))
+        {
+            // Another worker got there first.
+            std::this_thread::yield();
+            continue;
+        }
+        --mPending;
+        updateDepth(priority, -1);
+
+        if (job.token.isCancelled())
+        {
+            Metrics::instance().increment(QStringLiteral("scheduler.cancelled"));
+            continue;
+        }
+
+        const qint64 started = nowNs();
+        Metrics::instance().recordDuration(metricName("wait", priority), (started - job.enqueuedNs) / 1000);
+        job.run();
+        Metrics::instance().recordDuration(metricName("run", priority), (nowNs() - started) / 1000);
+    }
+}
+
+bool TaskScheduler::takeJob(int index, Job &job, Priority &priority)
+{
+    const int count = static_cast<int>(mWorkers.size());
+    for (int lane = Interactive; lane < PriorityCount; ++lane)
+    {
+        // Own work is taken newest-first for locality; stolen work oldest-first.
+        {
+            Worker &own = *mWorkers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.lanes[lane].empty())
+            {
+                job = std::move(own.lanes[lane].back());
+                own.lanes[lane].pop_back();
+                priority = static_cast<Priority>(lane);
+                return true;
+            }
+        }
+        for (int offset = 1; offset < count; ++offset)
+        {
+            Worker &victim = *mWorkers[(index + offset) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.lanes[lane].empty())
+            {
+                job = std::move(victim.lanes[lane].front());
+                victim.lanes[lane].pop_front();
+                priority = static_cast<Priority>(lane);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::updateDepth(Priority priority, int delta)
+{
+    const int depth = mDepth[priority].fetch_add(delta) + delta;
+    Metrics::instance().setGauge(metricName("queueDepth", priority), depth);
+}
@@ -0,0 +1,159 @@
+#include "tasksortkeys.h"
+
+#include "metrics.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+namespace
+{
+qint64 toSecs(const QDateTime &time)
+{
+    return time.isValid() ? time.toSecsSinceEpoch() : TaskSortKeys::kNoTime;
+}
+
+qint64 firstOrNone(const QVector<qint64> &sortedTimes)
+{
+    return sortedTimes.isEmpty() ? TaskSortKeys::kNoTime : sortedTimes.first();
+}
+
+template <typename T>
+void sortByKey(QVector<int> &order, const QVector<T> &keys)
+{
+    const T *data = keys.constData();
+    std::stable_sort(order.begin(), order.end(), [data](int a, int b) {
+        return data[a] < data[b];
+    });
+}
+}
+
+void TaskSortKeys::rebuild(const QVector<Task> &tasks, const SubtaskStore &store)
+{
+    clear();
+    mIds.reserve(tasks.size());
+    mStartSecs.reserve(tasks.size());
+    mEndSecs.reserve(tasks.size());
+    mNextDueSecs.reserve(tasks.size());
+    mOpenDueSecs.reserve(tasks.size());
+
+    for (int i = 0; i < tasks.size(); ++i)
+    {
+        const Task &task = tasks.at(i);
+        mIds.append(task.id());
+        mStartSecs.append(toSecs(task.startTime()));
+        mEndSecs.append(toSecs(task.endTime()));
+        mOpenDueSecs.append(store.openDueTimes(i));
+        mNextDueSecs.append(firstOrNone(mOpenDueSecs.last()));
+    }
+    mProgress = store.progressAll();
+}
+
+void TaskSortKeys::updateTask(int taskIndex, const Task &task, const SubtaskStore &store)
+{
+    if (taskIndex < 0 || taskIndex >= size())
+    {
+        return;
+    }
+    mIds[taskIndex] = task.id();
+    mStartSecs[taskIndex] = toSecs(task.startTime());
+    mEndSecs[taskIndex] = toSecs(task.endTime());
+    mOpenDueSecs[taskIndex] = store.openDueTimes(taskIndex);
+    mNextDueSecs[taskIndex] = firstOrNone(mOpenDueSecs.at(taskIndex));
+    mProgress[taskIndex] = store.progress(taskIndex);
+}
+
+void TaskSortKeys::clear()
+{
+    mIds.clear();
+    mStartSecs.clear();
+    mEndSecs.clear();
+    mNextDueSecs.clear();
+    mOpenDueSecs.clear();
+    mProgress.clear();
+}
+
+int TaskSortKeys::size() const
+{
+    return mIds.size();
+}
+
+double TaskSortKeys::progress(int taskIndex) const
+{
+    return mProgress.at(taskIndex);
+}
+
+qint64 TaskSortKeys::nextDueSecs(int taskIndex) const
+{
+    return mNextDueSecs.at(taskIndex);
+}
+
+QVector<int> TaskSortKeys::rank(const Query &query) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<int> order;
+    order.reserve(size());
+    for (int i = 0; i < size(); ++i)
+    {
+        if (accepts(i, query))
+        {
+            order.append(i);
+        }
+    }
+
+    switch (query.order)
+    {
+    case Order::Manual:
+        break;
+    case Order::EndTime:
+        sortByKey(order, mEndSecs);
+        break;
+    case Order::NextDue:
+        sortByKey(order, mNextDueSecs);
+        break;
+    case Order::Progress:
+        sortByKey(order, mProgress);
+        break;
+    }
+
+    Metrics::instance().recordDuration(QStringLiteral("tasks.rank"), timer.nsecsElapsed() / 1000);
+    return order;
+}
+
+bool TaskSortKeys::accepts(int taskIndex, const Query &query) const
+{
+    if (query.ids && !query.ids->contains(mIds.at(taskIndex)))
+    {
+        return false;
+    }
+
+    const qint64 start = mStartSecs.at(taskIndex);
+    const qint64 end = mEndSecs.at(taskIndex);
+    const qint64 nextDue = mNextDueSecs.at(taskIndex);
+    const bool open = mProgress.at(taskIndex) < 100.0;
+
+    switch (query.filter)
+    {
+    case Filter::All:
+        return true;
+    case Filter::DueSoon:
+    {
+        const qint64 horizon = query.nowSecs + query.soonSecs;
+        const QVector<qint64> &openDue = mOpenDueSecs.at(taskIndex);
+        // The earliest open due time may already be overdue, so look for the
+        // first one at or after now rather than testing the minimum.
+        const auto firstUpcoming = std::lower_bound(openDue.begin(), openDue.end(), query.nowSecs);
+        const bool subtaskSoon = firstUpcoming != openDue.end() && *firstUpcoming <= horizon;
+        const bool taskSoon = open && end != kNoTime && end >= query.nowSecs && end <= horizon;
+        return subtaskSoon || taskSoon;
+    }
+    case Filter::Overdue:
+        return nextDue < query.nowSecs || (open && end < query.nowSecs);
+    case Filter::DateRange:
+        // Overlap of [start, end] with the range; a missing bound is open-ended.
+        return (start == kNoTime || start <= query.toSecs) && (end == kNoTime || end >= query.fromSecs);
+    }
+    return true;
+}
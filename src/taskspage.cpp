@@ -1,12 +1,18 @@
 #include "taskspage.h"
+#include "theme.h"
 
+#include <QApplication>
 #include <QBoxLayout>
-#include <QCheckBox>
+#include <QButtonGroup>
+#include <QComboBox>
+#include <QDateEdit>
 #include <QDateTimeEdit>
 #include <QDialog>
 #include <QDialogButtonBox>
-#include <QDoubleSpinBox>
 #include <QFormLayout>
+#include <QHeaderView>
+#include <QHideEvent>
+#include <QInputDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
@@ -16,6 +22,7 @@
 #include <QScrollArea>
 #include <QShowEvent>
 #include <QSizePolicy>
+#include <QTableView>
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QSignalBlocker>
@@ -31,12 +38,12 @@ double computeProgress(const Task &task)
 {
     double completedWeight = 0.0;
     double totalWeight = 0.0;
-    for (const auto &subtask : task.subtasks)
+    for (const auto &subtask : task.subtasks())
     {
-        totalWeight += std::max(0.0, subtask.weighting);
-        if (subtask.completed)
+        totalWeight += std::max(0.0, subtask.weighting());
+        if (subtask.isCompleted())
         {
-            completedWeight += std::max(0.0, subtask.weighting);
+            completedWeight += std::max(0.0, subtask.weighting());
         }
     }
     if (totalWeight <= 0.0)
@@ -103,21 +110,21 @@ public:
 
     void setTask(const Task &task)
     {
-        mTaskId = task.id;
-        mTitleEdit->setText(task.title);
-        mDescriptionEdit->setPlainText(task.description);
-        mStartEdit->setDateTime(task.startTime);
-        mEndEdit->setDateTime(task.endTime);
+        mTaskId = task.id();
+        mTitleEdit->setText(task.title());
+        mDescriptionEdit->setPlainText(task.description());
+        mStartEdit->setDateTime(task.startTime());
+        mEndEdit->setDateTime(task.endTime());
     }
 
     Task task() const
     {
         Task task;
-        task.id = mTaskId;
-        task.title = mTitleEdit->text().trimmed();
-        task.description = mDescriptionEdit->toPlainText();
-        task.startTime = mStartEdit->dateTime();
-        task.endTime = mEndEdit->dateTime();
+        task.setId(mTaskId);
+        task.setTitle(mTitleEdit->text().trimmed());
+        task.setDescription(mDescriptionEdit->toPlainText());
+        task.setStartTime(mStartEdit->dateTime());
+        task.setEndTime(mEndEdit->dateTime());
         return task;
     }
 
@@ -134,7 +141,6 @@ TaskCardWidget::TaskCardWidget(QWidget *parent)
     : QFrame(parent)
 {
     setObjectName(QStringLiteral("TaskCardWidget"));
-    setStyleSheet(QStringLiteral("#TaskCardWidget { background: #FFFFFF; border-radius: 16px; border: 1px solid #E0E0E0; }") );
     setCursor(Qt::PointingHandCursor);
 
     auto *layout = new QVBoxLayout(this);
@@ -142,17 +148,16 @@ TaskCardWidget::TaskCardWidget(QWidget *parent)
     layout->setSpacing(12);
 
     mTitle = new QLabel(this);
-    mTitle->setStyleSheet(QStringLiteral("font-size: 18px; font-weight: bold;"));
+    Theme::setRole(mTitle, "sectionTitle");
 
     mDescription = new QLabel(this);
     mDescription->setWordWrap(true);
-    mDescription->setStyleSheet(QStringLiteral("color: #666666;"));
+    Theme::setRole(mDescription, "secondary");
 
     mProgress = new QProgressBar(this);
     mProgress->setRange(0, 100);
     mProgress->setTextVisible(true);
-    mProgress->setStyleSheet(QStringLiteral("QProgressBar { background: #EEEEEE; border-radius: 10px; padding: 3px; }"
-                                             "QProgressBar::chunk { background: #000000; border-radius: 10px; }") );
+    Theme::setRole(mProgress, "progress");
 
     layout->addWidget(mTitle);
     layout->addWidget(mDescription);
@@ -161,116 +166,42 @@ TaskCardWidget::TaskCardWidget(QWidget *parent)
 
 void TaskCardWidget::setTask(const Task &task, double progress)
 {
-    mTask = task;
-    mTitle->setText(task.title);
-    mDescription->setText(task.description.isEmpty() ? tr("No description provided.") : task.description);
+    if (!task.isSharedWith(mTask))
+    {
+        mTask = task;
+        mTitle->setText(task.title());
+        mDescription->setText(task.description().isEmpty() ? tr("No description provided.") : task.description());
+    }
     mProgress->setValue(static_cast<int>(std::round(progress)));
     mProgress->setFormat(tr("%1% Completed").arg(QString::number(progress, 'f', 0)));
 }
 
 QString TaskCardWidget::taskId() const
 {
-    return mTask.id;
+    return mTask.id();
 }
 
 void TaskCardWidget::mousePressEvent(QMouseEvent *event)
 {
-    emit clicked(mTask.id);
+    emit clicked(mTask.id());
     QFrame::mousePressEvent(event);
 }
 
-SubtaskRowWidget::SubtaskRowWidget(QWidget *parent)
-    : QFrame(parent)
+TaskDetailView::TaskDetailView(QWidget *parent)
+    : QWidget(parent)
 {
-    setObjectName(QStringLiteral("SubtaskRowWidget"));
-    setStyleSheet(QStringLiteral("#SubtaskRowWidget { border: 1px solid #E0E0E0; border-radius: 12px; background: #FFFFFF; }") );
-
-    auto *layout = new QHBoxLayout(this);
-    layout->setContentsMargins(12, 12, 12, 12);
-    layout->setSpacing(12);
-
-    mCheck = new QCheckBox(this);
-    layout->addWidget(mCheck);
-
-    auto *infoLayout = new QVBoxLayout();
-    infoLayout->setSpacing(6);
-
-    mTitleEdit = new QLineEdit(this);
-    mTitleEdit->setPlaceholderText(tr("Subtask title"));
-    infoLayout->addWidget(mTitleEdit);
-
-    mDescriptionEdit = new QTextEdit(this);
-    mDescriptionEdit->setPlaceholderText(tr("Description"));
-    mDescriptionEdit->setFixedHeight(60);
-    infoLayout->addWidget(mDescriptionEdit);
-
-    layout->addLayout(infoLayout, 1);
-
-    mDueEdit = new QDateTimeEdit(QDateTime::currentDateTime(), this);
-    mDueEdit->setDisplayFormat("yyyy-MM-dd HH:mm");
-    layout->addWidget(mDueEdit);
-
-    mWeightSpin = new QDoubleSpinBox(this);
-    mWeightSpin->setRange(0.0, 1000.0);
-    mWeightSpin->setDecimals(2);
-    mWeightSpin->setValue(1.0);
-    layout->addWidget(mWeightSpin);
-
-    mDeleteButton = new QPushButton(tr("Delete"), this);
-    mDeleteButton->setCursor(Qt::PointingHandCursor);
-    layout->addWidget(mDeleteButton);
+    mSession = new TaskEditSession(this);
+    connect(mSession, &TaskEditSession::committed, this, &TaskDetailView::taskUpdated);
+    connect(mSession, &TaskEditSession::edited, this, &TaskDetailView::recalculateProgress);
 
-    connect(mCheck, &QCheckBox::toggled, this, [this]() {
-        mSubtask.completed = mCheck->isChecked();
-        emit subtaskChanged(mSubtask);
-    });
-    connect(mTitleEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
-        mSubtask.title = text;
-        emit subtaskChanged(mSubtask);
-    });
-    connect(mDescriptionEdit, &QTextEdit::textChanged, this, [this]() {
-        mSubtask.description = mDescriptionEdit->toPlainText();
-        emit subtaskChanged(mSubtask);
-    });
-    connect(mDueEdit, &QDateTimeEdit::dateTimeChanged, this, [this](const QDateTime &value) {
-        mSubtask.dueTime = value;
-        emit subtaskChanged(mSubtask);
-    });
-    connect(mWeightSpin, qOverload<double>(&QDoubleSpinBox::valueChanged), this, [this](double value) {
-        mSubtask.weighting = value;
-        emit subtaskChanged(mSubtask);
-    });
-    connect(mDeleteButton, &QPushButton::clicked, this, [this]() {
-        if (QMessageBox::question(this, tr("Delete Subtask"), tr("Are you sure you want to delete this subtask?")) == QMessageBox::Yes)
+    // Leaving the view's editors for anything outside it commits the session.
+    connect(qApp, &QApplication::focusChanged, this, [this](QWidget *old, QWidget *now) {
+        if (old && isAncestorOf(old) && !(now && isAncestorOf(now)))
         {
-            emit deleteRequested(mSubtask.id);
+            mSession->commit();
         }
     });
-}
-
-void SubtaskRowWidget::setSubtask(const Subtask &subtask)
-{
-    mSubtask = subtask;
-    updateUi();
-}
-
-Subtask SubtaskRowWidget::subtask() const
-{
-    return mSubtask;
-}
 
-void SubtaskRowWidget::updateUi()
-{
-    mCheck->setChecked(mSubtask.completed);
-    mTitleEdit->setText(mSubtask.title);
-    mDescriptionEdit->setText(mSubtask.description);
-    mDueEdit->setDateTime(mSubtask.dueTime);
-    mWeightSpin->setValue(mSubtask.weighting);
-}
-
-TaskDetailView::TaskDetailView(QWidget *parent)
-    : QWidget(parent)
-{
     auto *layout = new QHBoxLayout(this);
     layout->setContentsMargins(24, 24, 24, 24);
     layout->setSpacing(24);
@@ -278,8 +209,13 @@ TaskDetailView::TaskDetailView(QWidget *parent)
     auto *leftColumn = new QVBoxLayout();
     leftColumn->setSpacing(12);
 
+    auto *backButton = new QPushButton(tr("< Back"), this);
+    backButton->setCursor(Qt::PointingHandCursor);
+    Theme::setRole(backButton, "chip");
+    leftColumn->addWidget(backButton, 0, Qt::AlignLeft);
+
     mTitleEdit = new QLineEdit(this);
-    mTitleEdit->setStyleSheet(QStringLiteral("font-size: 24px; font-weight: bold;"));
+    Theme::setRole(mTitleEdit, "pageTitle");
     mDescriptionEdit = new QTextEdit(this);
     mDescriptionEdit->setFixedHeight(120);
     mStartEdit = new QDateTimeEdit(this);
@@ -291,8 +227,12 @@ TaskDetailView::TaskDetailView(QWidget *parent)
     mProgressBar->setRange(0, 100);
     mProgressBar->setTextVisible(true);
 
+    auto *planButton = new QPushButton(tr("Plan Study Time"), this);
+    Theme::setRole(planButton, "secondary");
+    planButton->setCursor(Qt::PointingHandCursor);
+
     mDeleteButton = new QPushButton(tr("Delete Task"), this);
-    mDeleteButton->setStyleSheet(QStringLiteral("QPushButton { background: #E53935; color: white; padding: 10px 16px; border-radius: 16px; }") );
+    Theme::setRole(mDeleteButton, "danger");
     mDeleteButton->setCursor(Qt::PointingHandCursor);
 
     leftColumn->addWidget(mTitleEdit);
@@ -300,6 +240,7 @@ TaskDetailView::TaskDetailView(QWidget *parent)
     leftColumn->addWidget(mStartEdit);
     leftColumn->addWidget(mEndEdit);
     leftColumn->addWidget(mProgressBar);
+    leftColumn->addWidget(planButton);
     leftColumn->addWidget(mDeleteButton);
     leftColumn->addStretch(1);
 
@@ -307,192 +248,266 @@ TaskDetailView::TaskDetailView(QWidget *parent)
     rightColumn->setSpacing(12);
 
     auto *subtaskHeader = new QLabel(tr("Subtasks"), this);
-    subtaskHeader->setStyleSheet(QStringLiteral("font-size: 18px; font-weight: bold;"));
+    Theme::setRole(subtaskHeader, "sectionTitle");
     rightColumn->addWidget(subtaskHeader);
 
-    auto *subtaskContainer = new QWidget(this);
-    mSubtaskLayout = new QVBoxLayout(subtaskContainer);
-    mSubtaskLayout->setSpacing(12);
-    mSubtaskLayout->setContentsMargins(0, 0, 0, 0);
-
-    auto *scroll = new QScrollArea(this);
-    scroll->setWidgetResizable(true);
-    scroll->setFrameShape(QFrame::NoFrame);
-    scroll->setWidget(subtaskContainer);
+    mSubtaskModel = new SubtaskTableModel(this);
+
+    mSubtaskTable = new QTableView(this);
+    mSubtaskTable->setObjectName(QStringLiteral("SubtaskTable"));
+    mSubtaskTable->setModel(mSubtaskModel);
+    mSubtaskTable->setItemDelegate(new SubtaskItemDelegate(mSubtaskTable));
+    mSubtaskTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    mSubtaskTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    mSubtaskTable->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed | QAbstractItemView::SelectedClicked);
+    mSubtaskTable->setWordWrap(false);
+    mSubtaskTable->setShowGrid(false);
+    mSubtaskTable->verticalHeader()->hide();
+    // Fixed row heights let the view skip measuring rows it never paints.
+    mSubtaskTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    mSubtaskTable->verticalHeader()->setDefaultSectionSize(36);
+    auto *header = mSubtaskTable->horizontalHeader();
+    header->setSectionResizeMode(QHeaderView::Interactive);
+    header->setSectionResizeMode(SubtaskTableModel::DoneColumn, QHeaderView::Fixed);
+    header->setSectionResizeMode(SubtaskTableModel::DescriptionColumn, QHeaderView::Stretch);
+    header->resizeSection(SubtaskTableModel::DoneColumn, 36);
+    header->resizeSection(SubtaskTableModel::TitleColumn, 180);
+    header->resizeSection(SubtaskTableModel::DueColumn, 140);
+    header->resizeSection(SubtaskTableModel::WeightColumn, 80);
+
+    mEmptyLabel = new QLabel(tr("No subtasks yet. Click 'New Subtask' to add one."), this);
+    Theme::setRole(mEmptyLabel, "muted");
+    mEmptyLabel->setWordWrap(true);
+
+    auto *subtaskActions = new QHBoxLayout();
+    subtaskActions->setSpacing(8);
+    mMoveUpButton = new QPushButton(tr("Move Up"), this);
+    mMoveDownButton = new QPushButton(tr("Move Down"), this);
+    mDeleteSubtaskButton = new QPushButton(tr("Delete Subtask"), this);
+    for (auto *button : {mMoveUpButton, mMoveDownButton, mDeleteSubtaskButton})
+    {
+        button->setCursor(Qt::PointingHandCursor);
+        Theme::setRole(button, "chip");
+        subtaskActions->addWidget(button);
+    }
+    subtaskActions->addStretch(1);
 
     auto *addSubtaskButton = new QPushButton(tr("New Subtask"), this);
     addSubtaskButton->setCursor(Qt::PointingHandCursor);
     addSubtaskButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     addSubtaskButton->setMinimumHeight(48);
-    addSubtaskButton->setStyleSheet(QStringLiteral(
-        "QPushButton { border: 1px dashed #E0E0E0; background: transparent; border-radius: 14px; font-weight: bold; }"
-        "QPushButton:hover { background: #F5F5F5; }"));
+    Theme::setRole(addSubtaskButton, "dashed");
 
-    rightColumn->addWidget(scroll, 1);
+    rightColumn->addWidget(mEmptyLabel);
+    rightColumn->addWidget(mSubtaskTable, 1);
+    rightColumn->addLayout(subtaskActions);
     rightColumn->addWidget(addSubtaskButton);
 
     layout->addLayout(leftColumn, 2);
     layout->addLayout(rightColumn, 3);
 
+    connect(backButton, &QPushButton::clicked, this, [this]() {
+        mSession->commit();
+        emit backRequested();
+    });
     connect(mTitleEdit, &QLineEdit::editingFinished, this, [this]() {
         const QString trimmed = mTitleEdit->text().trimmed();
         if (trimmed.isEmpty())
         {
             QMessageBox::warning(this, tr("Invalid Title"), tr("Task title cannot be empty."));
             const QSignalBlocker blocker(mTitleEdit);
-            mTitleEdit->setText(mTask.title);
+            mTitleEdit->setText(mSession->task().title());
             return;
         }
-        if (trimmed == mTask.title)
+        if (trimmed == mSession->task().title())
         {
             return;
         }
-        mTask.title = trimmed;
+        mSession->update([&](Task &task) {
+            task.setTitle(trimmed);
+        });
         mTitleEdit->setText(trimmed);
-        emit taskUpdated(mTask);
     });
     connect(mDescriptionEdit, &QTextEdit::textChanged, this, [this]() {
-        mTask.description = mDescriptionEdit->toPlainText();
-        emit taskUpdated(mTask);
+        mSession->update([this](Task &task) {
+            task.setDescription(mDescriptionEdit->toPlainText());
+        });
     });
     connect(mStartEdit, &QDateTimeEdit::dateTimeChanged, this, [this](const QDateTime &dt) {
-        if (dt >= mTask.endTime)
+        if (dt >= mSession->task().endTime())
         {
             QMessageBox::warning(this, tr("Invalid Range"), tr("Start time must be before the end time."));
             const QSignalBlocker blocker(mStartEdit);
-            mStartEdit->setDateTime(mTask.startTime);
+            mStartEdit->setDateTime(mSession->task().startTime());
             return;
         }
         if (dt < QDateTime::currentDateTime())
         {
             QMessageBox::warning(this, tr("Invalid Start"), tr("Start time cannot be in the past."));
             const QSignalBlocker blocker(mStartEdit);
-            mStartEdit->setDateTime(mTask.startTime);
+            mStartEdit->setDateTime(mSession->task().startTime());
             return;
         }
-        if (dt == mTask.startTime)
+        if (dt == mSession->task().startTime())
         {
             return;
         }
-        mTask.startTime = dt;
-        emit taskUpdated(mTask);
+        mSession->update([&](Task &task) {
+            task.setStartTime(dt);
+        });
     });
     connect(mEndEdit, &QDateTimeEdit::dateTimeChanged, this, [this](const QDateTime &dt) {
-        if (dt <= mTask.startTime)
+        if (dt <= mSession->task().startTime())
         {
             QMessageBox::warning(this, tr("Invalid Range"), tr("End time must be after the start time."));
             const QSignalBlocker blocker(mEndEdit);
-            mEndEdit->setDateTime(mTask.endTime);
+            mEndEdit->setDateTime(mSession->task().endTime());
             return;
         }
         if (dt <= QDateTime::currentDateTime())
         {
             QMessageBox::warning(this, tr("Invalid End"), tr("End time must be in the future."));
             const QSignalBlocker blocker(mEndEdit);
-            mEndEdit->setDateTime(mTask.endTime);
+            mEndEdit->setDateTime(mSession->task().endTime());
             return;
         }
-        if (dt == mTask.endTime)
+        if (dt == mSession->task().endTime())
         {
             return;
         }
-        mTask.endTime = dt;
-        emit taskUpdated(mTask);
+        mSession->update([&](Task &task) {
+            task.setEndTime(dt);
+        });
+    });
+    connect(planButton, &QPushButton::clicked, this, [this]() {
+        mSession->commit();
+        emit studyPlanRequested(mSession->task());
     });
     connect(mDeleteButton, &QPushButton::clicked, this, [this]() {
         if (QMessageBox::question(this, tr("Delete Task"), tr("Are you sure you want to delete this task and all its subtasks?")) == QMessageBox::Yes)
         {
-            emit taskDeleted(mTask.id);
+            mSession->discard();
+            emit taskDeleted(mSession->task().id());
         }
     });
     connect(addSubtaskButton, &QPushButton::clicked, this, [this]() {
         Subtask subtask;
-        subtask.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        subtask.dueTime = QDateTime::currentDateTime().addSecs(3600);
-        subtask.weighting = 1.0;
-        mTask.subtasks.append(subtask);
-        rebuildSubtasks();
-        emit taskUpdated(mTask);
+        subtask.setId(QUuid::createUuid().toString(QUuid::WithoutBraces));
+        subtask.setDueTime(QDateTime::currentDateTime().addSecs(3600));
+        subtask.setWeighting(1.0);
+
+        const int row = mSubtaskModel->rowCount();
+        mSubtaskModel->insertSubtask(row, subtask);
+        mSession->update([&](Task &task) {
+            QVector<Subtask> subtasks = task.subtasks();
+            subtasks.insert(row, subtask);
+            task.setSubtasks(subtasks);
+        });
+        const QModelIndex title = mSubtaskModel->index(row, SubtaskTableModel::TitleColumn);
+        mSubtaskTable->setCurrentIndex(title);
+        mSubtaskTable->edit(title);
+    });
+    connect(mDeleteSubtaskButton, &QPushButton::clicked, this, [this]() {
+        const int row = mSubtaskTable->currentIndex().row();
+        if (row < 0)
+        {
+            return;
+        }
+        if (QMessageBox::question(this, tr("Delete Subtask"), tr("Are you sure you want to delete this subtask?")) != QMessageBox::Yes)
+        {
+            return;
+        }
+        mSubtaskModel->removeSubtask(row);
+        mSession->update([&](Task &task) {
+            QVector<Subtask> subtasks = task.subtasks();
+            subtasks.removeAt(row);
+            task.setSubtasks(subtasks);
+        });
+    });
+    connect(mMoveUpButton, &QPushButton::clicked, this, [this]() {
+        moveCurrentSubtask(-1);
+    });
+    connect(mMoveDownButton, &QPushButton::clicked, this, [this]() {
+        moveCurrentSubtask(1);
+    });
+    connect(mSubtaskModel, &SubtaskTableModel::subtaskEdited, this, [this](int row, const Subtask &subtask) {
+        mSession->update([&](Task &task) {
+            QVector<Subtask> subtasks = task.subtasks();
+            subtasks[row] = subtask;
+            task.setSubtasks(subtasks);
+        });
     });
+    connect(mSubtaskModel, &QAbstractItemModel::rowsInserted, this, &TaskDetailView::updateSubtaskActions);
+    connect(mSubtaskModel, &QAbstractItemModel::rowsRemoved, this, &TaskDetailView::updateSubtaskActions);
+    connect(mSubtaskModel, &QAbstractItemModel::modelReset, this, &TaskDetailView::updateSubtaskActions);
+    connect(mSubtaskTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this, &TaskDetailView::updateSubtaskActions);
+    updateSubtaskActions();
 }
 
 void TaskDetailView::setTask(const Task &task)
 {
-    mTask = task;
-    mTitleEdit->setText(task.title);
-    mDescriptionEdit->setText(task.description);
-    mStartEdit->setDateTime(task.startTime);
-    mEndEdit->setDateTime(task.endTime);
+    mSession->begin(task);
+
+    const QSignalBlocker titleBlocker(mTitleEdit);
+    const QSignalBlocker descriptionBlocker(mDescriptionEdit);
+    const QSignalBlocker startBlocker(mStartEdit);
+    const QSignalBlocker endBlocker(mEndEdit);
+    mTitleEdit->setText(task.title());
+    mDescriptionEdit->setText(task.description());
+    mStartEdit->setDateTime(task.startTime());
+    mEndEdit->setDateTime(task.endTime());
     recalculateProgress();
-    rebuildSubtasks();
+    mSubtaskModel->setSubtasks(task.subtasks());
 }
 
-void TaskDetailView::rebuildSubtasks()
+void TaskDetailView::hideEvent(QHideEvent *event)
 {
-    if (!mSubtaskLayout)
-    {
-        return;
-    }
+    mSession->commit();
+    QWidget::hideEvent(event);
+}
 
-    QLayoutItem *item;
-    while ((item = mSubtaskLayout->takeAt(0)) != nullptr)
+void TaskDetailView::moveCurrentSubtask(int offset)
+{
+    const QModelIndex current = mSubtaskTable->currentIndex();
+    const int from = current.row();
+    const int to = from + offset;
+    if (from < 0 || !mSubtaskModel->moveSubtask(from, to))
     {
-        if (item->widget())
-        {
-            item->widget()->deleteLater();
-        }
-        delete item;
+        return;
     }
+    mSession->update([&](Task &task) {
+        QVector<Subtask> subtasks = task.subtasks();
+        subtasks.move(from, to);
+        task.setSubtasks(subtasks);
+    });
+    mSubtaskTable->setCurrentIndex(mSubtaskModel->index(to, current.column()));
+}
 
-    if (mTask.subtasks.isEmpty())
-    {
-        auto *placeholder = new QLabel(tr("No subtasks yet. Click 'New Subtask' to add one."), this);
-        placeholder->setStyleSheet(QStringLiteral("color: #888888;"));
-        placeholder->setWordWrap(true);
-        mSubtaskLayout->addWidget(placeholder);
-    }
-    else
-    {
-        for (auto &subtask : mTask.subtasks)
-        {
-            auto *row = new SubtaskRowWidget(this);
-            row->setSubtask(subtask);
-            connect(row, &SubtaskRowWidget::subtaskChanged, this, [this](const Subtask &updated) {
-                for (auto &existing : mTask.subtasks)
-                {
-                    if (existing.id == updated.id)
-                    {
-                        existing = updated;
-                        break;
-                    }
-                }
-                recalculateProgress();
-                emit taskUpdated(mTask);
-            });
-            connect(row, &SubtaskRowWidget::deleteRequested, this, [this](const QString &id) {
-                mTask.subtasks.erase(std::remove_if(mTask.subtasks.begin(), mTask.subtasks.end(), [&](const Subtask &subtask) {
-                                          return subtask.id == id;
-                                      }),
-                                      mTask.subtasks.end());
-                rebuildSubtasks();
-                recalculateProgress();
-                emit taskUpdated(mTask);
-            });
-            mSubtaskLayout->addWidget(row);
-        }
-    }
-    mSubtaskLayout->addStretch(1);
+void TaskDetailView::updateSubtaskActions()
+{
+    const int count = mSubtaskModel->rowCount();
+    const int row = mSubtaskTable->currentIndex().row();
+    mEmptyLabel->setVisible(count == 0);
+    mSubtaskTable->setVisible(count > 0);
+    mDeleteSubtaskButton->setEnabled(row >= 0);
+    mMoveUpButton->setEnabled(row > 0);
+    mMoveDownButton->setEnabled(row >= 0 && row < count - 1);
 }
 
 void TaskDetailView::recalculateProgress()
 {
-    const double progress = computeProgress(mTask);
+    const double progress = computeProgress(mSession->task());
     mProgressBar->setValue(static_cast<int>(std::round(progress)));
     mProgressBar->setFormat(tr("%1% completed").arg(QString::number(progress, 'f', 1)));
 }
 
 TasksPage::TasksPage(QWidget *parent)
     : QWidget(parent)
+    , mCardPool(QStringLiteral("pool.taskCard"), [this]() {
+        auto *card = new TaskCardWidget(this);
+        connect(card, &TaskCardWidget::clicked, this, &TasksPage::openTaskDetail);
+        return card;
+    })
 {
     createLayout();
 }
@@ -502,10 +517,23 @@ void TasksPage::setJsonManager(JsonManager *manager)
     mJsonManager = manager;
 }
 
+void TasksPage::setSearch(const SearchIndex *index, TaskScheduler *scheduler)
+{
+    // The hits filter the list, so every match is needed.
+    mSearchField->setSearch(index, scheduler, SearchIndex::TaskKind | SearchIndex::SubtaskKind, 0);
+}
+
+void TasksPage::refreshSearch()
+{
+    mSearchField->refresh();
+}
+
 void TasksPage::setTasks(const QVector<Task> &tasks)
 {
     mTasks = tasks;
-    rebuildList();
+    rebuildKeys();
+    mListStale = true;
+    showList();
 }
 
 void TasksPage::refreshFromHome(const QVector<Activity> &activities)
@@ -513,6 +541,11 @@ void TasksPage::refreshFromHome(const QVector<Activity> &activities)
     Q_UNUSED(activities);
 }
 
+void TasksPage::showTask(const QString &taskId)
+{
+    openTaskDetail(taskId);
+}
+
 void TasksPage::createLayout()
 {
     auto *layout = new QVBoxLayout(this);
@@ -523,15 +556,25 @@ void TasksPage::createLayout()
     headerLayout->setSpacing(12);
 
     auto *title = new QLabel(tr("Tasks"), this);
-    title->setStyleSheet(QStringLiteral("font-size: 24px; font-weight: bold;"));
+    Theme::setRole(title, "pageTitle");
 
     auto *addButton = new QPushButton(tr("+"), this);
     addButton->setFixedSize(40, 40);
-    addButton->setStyleSheet(QStringLiteral("QPushButton { border-radius: 20px; background: #000000; color: #FFFFFF; font-size: 20px; }") );
+    Theme::setRole(addButton, "round");
     addButton->setCursor(Qt::PointingHandCursor);
 
+    mSummaryLabel = new QLabel(this);
+    Theme::setRole(mSummaryLabel, "secondary");
+
+    mSearchField = new SearchField(this);
+    mSearchField->setPlaceholderText(tr("Search tasks and subtasks"));
+    mSearchField->setMinimumWidth(240);
+
     headerLayout->addWidget(title);
+    headerLayout->addSpacing(12);
+    headerLayout->addWidget(mSearchField);
     headerLayout->addStretch(1);
+    headerLayout->addWidget(mSummaryLabel);
     headerLayout->addWidget(addButton);
 
     layout->addLayout(headerLayout);
@@ -539,7 +582,7 @@ void TasksPage::createLayout()
     auto *divider = new QFrame(this);
     divider->setFrameShape(QFrame::HLine);
     divider->setFrameShadow(QFrame::Plain);
-    divider->setStyleSheet(QStringLiteral("QFrame { background: #E0E0E0; max-height: 1px; min-height: 1px; }"));
+    Theme::setRole(divider, "divider");
     layout->addWidget(divider);
 
     mStack = new QStackedWidget(this);
@@ -549,6 +592,7 @@ void TasksPage::createLayout()
     auto *listLayout = new QVBoxLayout(mListPage);
     listLayout->setContentsMargins(0, 0, 0, 0);
     listLayout->setSpacing(16);
+    listLayout->addWidget(createFilterBar(mListPage));
 
     auto *scroll = new QScrollArea(mListPage);
     scroll->setWidgetResizable(true);
@@ -559,6 +603,11 @@ void TasksPage::createLayout()
     mListLayout->setSpacing(16);
     mListLayout->setContentsMargins(0, 0, 0, 0);
 
+    mEmptyLabel = new QLabel(tr("No tasks yet. Click + to create your first task."), scrollContent);
+    Theme::setRole(mEmptyLabel, "muted");
+    mEmptyLabel->setAlignment(Qt::AlignCenter);
+    mEmptyLabel->setWordWrap(true);
+
     scroll->setWidget(scrollContent);
     listLayout->addWidget(scroll);
 
@@ -572,12 +621,14 @@ void TasksPage::createLayout()
         if (dialog.exec() == QDialog::Accepted)
         {
             Task task = dialog.task();
-            if (task.id.isEmpty())
+            if (task.id().isEmpty())
             {
-                task.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+                task.setId(QUuid::createUuid().toString(QUuid::WithoutBraces));
             }
             mTasks.append(task);
-            rebuildList();
+            rebuildKeys();
+            mListStale = true;
+            showList();
             emit tasksChanged(mTasks);
         }
     });
@@ -588,6 +639,19 @@ void TasksPage::createLayout()
     connect(mDetailPage, &TaskDetailView::taskDeleted, this, [this](const QString &id) {
         deleteTask(id);
     });
+    connect(mDetailPage, &TaskDetailView::backRequested, this, &TasksPage::showList);
+    connect(mDetailPage, &TaskDetailView::studyPlanRequested, this, [this](const Task &task) {
+        bool ok = false;
+        const double hours = QInputDialog::getDouble(this, tr("Plan Study Time"), tr("Hours of work to schedule before the deadline:"), 3.0, 0.5, 200.0, 1, &ok);
+        if (ok)
+        {
+            emit studyPlanRequested(task, qRound(hours * 60.0));
+        }
+    });
+    connect(mSearchField, &SearchField::resultsReady, this, &TasksPage::applySearch);
+    connect(mSearchField, &SearchField::cleared, this, [this]() {
+        applySearch({});
+    });
 }
 
 void TasksPage::rebuildList()
@@ -600,39 +664,165 @@ void TasksPage::rebuildList()
     QLayoutItem *item;
     while ((item = mListLayout->takeAt(0)) != nullptr)
     {
-        if (item->widget())
-        {
-            item->widget()->deleteLater();
-        }
         delete item;
     }
+    mCardPool.releaseAll();
+
+    TaskSortKeys::Query query;
+    query.order = mOrder;
+    query.filter = mFilter;
+    query.nowSecs = QDateTime::currentSecsSinceEpoch();
+    query.fromSecs = mRangeFromEdit->date().startOfDay().toSecsSinceEpoch();
+    query.toSecs = mRangeToEdit->date().endOfDay().toSecsSinceEpoch();
+    query.ids = mSearchActive ? &mSearchMatches : nullptr;
+
+    const QVector<int> order = mSortKeys.rank(query);
+    for (const int i : order)
+    {
+        auto *card = mCardPool.acquire();
+        card->setTask(mTasks.at(i), mSortKeys.progress(i));
+        mListLayout->addWidget(card);
+    }
+
+    const bool narrowed = mSearchActive || mFilter != TaskSortKeys::Filter::All;
+    mEmptyLabel->setText(narrowed && !mTasks.isEmpty() ? tr("No tasks match the current search and filter.") : tr("No tasks yet. Click + to create your first task."));
+    mEmptyLabel->setVisible(order.isEmpty());
+    mListLayout->insertWidget(0, mEmptyLabel);
+    mListLayout->addStretch(1);
+    mListStale = false;
+    updateSummary();
+}
+
+void TasksPage::rebuildKeys()
+{
+    mSubtaskStore.rebuild(mTasks);
+    mSortKeys.rebuild(mTasks, mSubtaskStore);
+}
 
-    if (mTasks.isEmpty())
+QWidget *TasksPage::createFilterBar(QWidget *parent)
+{
+    auto *bar = new QWidget(parent);
+    auto *layout = new QHBoxLayout(bar);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(8);
+
+    mFilterGroup = new QButtonGroup(bar);
+    const QList<QPair<TaskSortKeys::Filter, QString>> filters = {
+        {TaskSortKeys::Filter::All, tr("All")},
+        {TaskSortKeys::Filter::DueSoon, tr("Due soon")},
+        {TaskSortKeys::Filter::Overdue, tr("Overdue")},
+        {TaskSortKeys::Filter::DateRange, tr("Date range")},
+    };
+    for (const auto &filter : filters)
     {
-        auto *placeholder = new QLabel(tr("No tasks yet. Click + to create your first task."), this);
-        placeholder->setStyleSheet(QStringLiteral("color: #888888;"));
-        placeholder->setAlignment(Qt::AlignCenter);
-        placeholder->setWordWrap(true);
-        mListLayout->addWidget(placeholder);
+        auto *chip = new QPushButton(filter.second, bar);
+        chip->setCheckable(true);
+        chip->setCursor(Qt::PointingHandCursor);
+        Theme::setRole(chip, "chip");
+        chip->setChecked(filter.first == mFilter);
+        mFilterGroup->addButton(chip, static_cast<int>(filter.first));
+        layout->addWidget(chip);
     }
-    else
+
+    mRangeControls = new QWidget(bar);
+    auto *rangeLayout = new QHBoxLayout(mRangeControls);
+    rangeLayout->setContentsMargins(0, 0, 0, 0);
+    rangeLayout->setSpacing(6);
+    const QDate today = QDate::currentDate();
+    mRangeFromEdit = new QDateEdit(today, mRangeControls);
+    mRangeToEdit = new QDateEdit(today.addDays(30), mRangeControls);
+    for (auto *edit : {mRangeFromEdit, mRangeToEdit})
     {
-        for (const auto &task : mTasks)
+        edit->setCalendarPopup(true);
+        edit->setDisplayFormat(QStringLiteral("yyyy-MM-dd"));
+    }
+    rangeLayout->addWidget(mRangeFromEdit);
+    rangeLayout->addWidget(new QLabel(tr("to"), mRangeControls));
+    rangeLayout->addWidget(mRangeToEdit);
+    mRangeControls->setVisible(mFilter == TaskSortKeys::Filter::DateRange);
+    layout->addWidget(mRangeControls);
+
+    layout->addStretch(1);
+
+    auto *sortLabel = new QLabel(tr("Sort by"), bar);
+    Theme::setRole(sortLabel, "secondary");
+    mSortCombo = new QComboBox(bar);
+    mSortCombo->addItem(tr("Created"), static_cast<int>(TaskSortKeys::Order::Manual));
+    mSortCombo->addItem(tr("End date"), static_cast<int>(TaskSortKeys::Order::EndTime));
+    mSortCombo->addItem(tr("Next subtask due"), static_cast<int>(TaskSortKeys::Order::NextDue));
+    mSortCombo->addItem(tr("Least progress"), static_cast<int>(TaskSortKeys::Order::Progress));
+    layout->addWidget(sortLabel);
+    layout->addWidget(mSortCombo);
+
+    // Changing the view only re-ranks the stored keys.
+    connect(mFilterGroup, &QButtonGroup::idToggled, this, [this](int id, bool checked) {
+        if (!checked)
         {
-            auto *card = new TaskCardWidget(this);
-            card->setTask(task, computeProgress(task));
-            connect(card, &TaskCardWidget::clicked, this, &TasksPage::openTaskDetail);
-            mListLayout->addWidget(card);
+            return;
         }
+        mFilter = static_cast<TaskSortKeys::Filter>(id);
+        mRangeControls->setVisible(mFilter == TaskSortKeys::Filter::DateRange);
+        rebuildList();
+    });
+    connect(mSortCombo, &QComboBox::currentIndexChanged, this, [this]() {
+        mOrder = static_cast<TaskSortKeys::Order>(mSortCombo->currentData().toInt());
+        rebuildList();
+    });
+    for (auto *edit : {mRangeFromEdit, mRangeToEdit})
+    {
+        connect(edit, &QDateEdit::dateChanged, this, [this]() {
+            if (mFilter == TaskSortKeys::Filter::DateRange)
+            {
+                rebuildList();
+            }
+        });
+    }
+
+    return bar;
+}
+
+void TasksPage::showList()
+{
+    if (mListStale)
+    {
+        rebuildList();
     }
-    mListLayout->addStretch(1);
     mStack->setCurrentWidget(mListPage);
 }
 
+void TasksPage::applySearch(const QVector<SearchIndex::Hit> &hits)
+{
+    mSearchActive = mSearchField->isActive();
+    mSearchMatches.clear();
+    for (const auto &hit : hits)
+    {
+        mSearchMatches.insert(hit.taskId);
+    }
+    mListStale = true;
+    // Results also arrive after every index sync; never leave a task being edited.
+    if (mStack->currentWidget() == mListPage)
+    {
+        rebuildList();
+    }
+}
+
+void TasksPage::updateSummary()
+{
+    if (!mSummaryLabel)
+    {
+        return;
+    }
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const int overdue = mSubtaskStore.overdueCount(now);
+    const int dueThisWeek = mSubtaskStore.dueBetweenCount(now, now + 7 * 24 * 3600);
+    mSummaryLabel->setText(tr("%1 overdue, %2 due in the next 7 days").arg(overdue).arg(dueThisWeek));
+}
+
 void TasksPage::openTaskDetail(const QString &taskId)
 {
     auto it = std::find_if(mTasks.begin(), mTasks.end(), [&](const Task &task) {
-        return task.id == taskId;
+        return task.id() == taskId;
     });
     if (it == mTasks.end())
     {
@@ -644,12 +834,24 @@ void TasksPage::openTaskDetail(const QString &taskId)
 
 void TasksPage::saveTask(const Task &task)
 {
-    for (auto &existing : mTasks)
+    for (int i = 0; i < mTasks.size(); ++i)
     {
-        if (existing.id == task.id)
+        if (mTasks.at(i).id() == task.id())
         {
-            existing = task;
-            rebuildList();
+            mTasks[i] = task;
+            mSubtaskStore.replaceTask(i, task);
+            mSortKeys.updateTask(i, task, mSubtaskStore);
+            // The cards are only rebuilt once the list is shown again. With a search
+            // active, its re-run after the index sync rebuilds the list anyway.
+            mListStale = true;
+            if (mStack->currentWidget() == mListPage && !mSearchField->isActive())
+            {
+                rebuildList();
+            }
+            else
+            {
+                updateSummary();
+            }
             emit tasksChanged(mTasks);
             return;
         }
@@ -659,10 +861,12 @@ void TasksPage::saveTask(const Task &task)
 void TasksPage::deleteTask(const QString &taskId)
 {
     mTasks.erase(std::remove_if(mTasks.begin(), mTasks.end(), [&](const Task &task) {
-                      return task.id == taskId;
+                      return task.id() == taskId;
                   }),
                   mTasks.end());
-    rebuildList();
+    rebuildKeys();
+    mListStale = true;
+    showList();
     emit tasksChanged(mTasks);
 }
 
@@ -676,6 +880,6 @@ void TasksPage::showEvent(QShowEvent *event)
     QWidget::showEvent(event);
     if (mStack && mListPage)
     {
-        mStack->setCurrentWidget(mListPage);
+        showList();
     }
 }
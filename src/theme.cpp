@@ -0,0 +1,52 @@
+#include "theme.h"
+
+#include <QApplication>
+#include <QFile>
+#include <QHash>
+#include <QPainter>
+#include <QPixmap>
+#include <QWidget>
+
+namespace
+{
+constexpr int kSwatchSize = 16;
+constexpr qreal kSwatchRadius = 4.0;
+}
+
+void Theme::apply(QApplication &app)
+{
+    QFile styleFile(QStringLiteral(":/styles/app.qss"));
+    if (styleFile.open(QIODevice::ReadOnly))
+    {
+        app.setStyleSheet(QString::fromUtf8(styleFile.readAll()));
+    }
+}
+
+void Theme::setRole(QWidget *widget, const char *role)
+{
+    widget->setProperty("role", QString::fromLatin1(role));
+}
+
+QIcon Theme::swatch(const QColor &color)
+{
+    static QHash<QRgb, QIcon> cache;
+    const QRgb key = color.rgba();
+    const auto found = cache.constFind(key);
+    if (found != cache.cend())
+    {
+        return found.value();
+    }
+
+    QPixmap pixmap(kSwatchSize, kSwatchSize);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QColor(0, 0, 0, 40));
+    painter.setBrush(color);
+    painter.drawRoundedRect(QRectF(0.5, 0.5, kSwatchSize - 1.0, kSwatchSize - 1.0), kSwatchRadius, kSwatchRadius);
+    painter.end();
+
+    QIcon icon(pixmap);
+    cache.insert(key, icon);
+    return icon;
+}
@@ -0,0 +1,194 @@
+#include "timelineindex.h"
+
+#include "metrics.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+constexpr qint64 kMinuteMsecs = 60 * 1000;
+const QColor kBreakColor(0xBD, 0xBD, 0xBD);
+
+using Span = TimelineIndex::Span;
+
+// The subtree over [first, last) is rooted at its midpoint; returns its latest end.
+qint64 buildSubtreeEnds(const QVector<Span> &spans, QVector<qint64> &subtreeEnd, int first, int last)
+{
+    if (first >= last)
+    {
+        return std::numeric_limits<qint64>::min();
+    }
+    const int mid = first + (last - first) / 2;
+    const qint64 end = std::max({spans.at(mid).end, buildSubtreeEnds(spans, subtreeEnd, first, mid), buildSubtreeEnds(spans, subtreeEnd, mid + 1, last)});
+    subtreeEnd[mid] = end;
+    return end;
+}
+
+// In-order walk, so overlapping spans are visited by start. A subtree is skipped
+// when nothing in it ends after from, and the right side once starts reach to.
+void visitOverlapping(const QVector<Span> &spans, const QVector<qint64> &subtreeEnd, int first, int last, qint64 from, qint64 to, const std::function<void(const Span &)> &visit)
+{
+    if (first >= last)
+    {
+        return;
+    }
+    const int mid = first + (last - first) / 2;
+    if (subtreeEnd.at(mid) <= from)
+    {
+        return;
+    }
+    visitOverlapping(spans, subtreeEnd, first, mid, from, to, visit);
+    const Span &span = spans.at(mid);
+    if (span.start >= to)
+    {
+        return;
+    }
+    if (span.end > from)
+    {
+        visit(span);
+    }
+    visitOverlapping(spans, subtreeEnd, mid + 1, last, from, to, visit);
+}
+}
+
+void TimelineIndex::rebuild(const AppSnapshot &snapshot)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    mActivities.clear();
+    mActivities.reserve(snapshot.activities.size());
+    for (const Activity &activity : snapshot.activities)
+    {
+        if (activity.startTime().isValid() && activity.endTime() > activity.startTime())
+        {
+            mActivities.append({activity.startTime().toMSecsSinceEpoch(), activity.endTime().toMSecsSinceEpoch(), activity.color(), activity.title()});
+        }
+    }
+    std::sort(mActivities.begin(), mActivities.end(), [](const Span &a, const Span &b) {
+        return a.start < b.start;
+    });
+    mSubtreeEnd.resize(mActivities.size());
+    buildSubtreeEnds(mActivities, mSubtreeEnd, 0, mActivities.size());
+
+    mDeadlines.clear();
+    for (const Task &task : snapshot.tasks)
+    {
+        const bool allDone = !task.subtasks().isEmpty() && std::all_of(task.subtasks().cbegin(), task.subtasks().cend(), [](const Subtask &subtask) {
+            return subtask.isCompleted();
+        });
+        if (task.endTime().isValid() && !allDone)
+        {
+            mDeadlines.append({task.endTime().toMSecsSinceEpoch(), task.title()});
+        }
+        for (const Subtask &subtask : task.subtasks())
+        {
+            if (!subtask.isCompleted() && subtask.dueTime().isValid())
+            {
+                mDeadlines.append({subtask.dueTime().toMSecsSinceEpoch(), subtask.title()});
+            }
+        }
+    }
+    std::sort(mDeadlines.begin(), mDeadlines.end(), [](const Mark &a, const Mark &b) {
+        return a.time < b.time;
+    });
+
+    mSchedule = snapshot.schedule;
+    mSettings = snapshot.settings;
+    mVersion = snapshot.version;
+    Metrics::instance().recordDuration(QStringLiteral("timeline.rebuild"), timer.nsecsElapsed() / 1000);
+}
+
+quint64 TimelineIndex::version() const
+{
+    return mVersion;
+}
+
+qint64 TimelineIndex::firstTime() const
+{
+    qint64 first = 0;
+    if (!mActivities.isEmpty())
+    {
+        first = mActivities.first().start;
+    }
+    if (!mDeadlines.isEmpty())
+    {
+        first = first == 0 ? mDeadlines.first().time : std::min(first, mDeadlines.first().time);
+    }
+    return first;
+}
+
+qint64 TimelineIndex::lastTime() const
+{
+    qint64 last = 0;
+    if (!mSubtreeEnd.isEmpty())
+    {
+        last = mSubtreeEnd.at(mSubtreeEnd.size() / 2);
+    }
+    if (!mDeadlines.isEmpty())
+    {
+        last = std::max(last, mDeadlines.last().time);
+    }
+    return last;
+}
+
+void TimelineIndex::forEachActivity(qint64 from, qint64 to, const std::function<void(const Span &)> &visit) const
+{
+    visitOverlapping(mActivities, mSubtreeEnd, 0, mActivities.size(), from, to, visit);
+}
+
+void TimelineIndex::forEachPeriod(qint64 from, qint64 to, const std::function<void(const Span &)> &visit) const
+{
+    if (mSchedule.isEmpty() || to <= from)
+    {
+        return;
+    }
+
+    const int year = mSchedule.yearIndex(mSettings.yearLevel);
+    const QDate lastDate = QDateTime::fromMSecsSinceEpoch(to - 1).date();
+    for (QDate date = QDateTime::fromMSecsSinceEpoch(from).date(); date <= lastDate; date = date.addDays(1))
+    {
+        const qint64 dayStart = date.startOfDay().toMSecsSinceEpoch();
+        const int week = mSchedule.rotationWeekFor(date, mSettings.currentWeek);
+        const ScheduleIndex::DayRange range = mSchedule.dayRange(week, date.dayOfWeek(), year);
+        for (int i = range.first; i < range.first + range.count; ++i)
+        {
+            const ScheduledPeriod &period = mSchedule.period(i);
+            Span span;
+            span.start = dayStart + period.startMinute * kMinuteMsecs;
+            span.end = dayStart + period.endMinute * kMinuteMsecs;
+            if (span.end <= from || span.start >= to)
+            {
+                continue;
+            }
+            if (period.subject >= 0)
+            {
+                const SubjectDefinition &subject = mSchedule.subject(period.subject);
+                span.color = subject.color;
+                span.title = subject.name;
+            }
+            else
+            {
+                span.color = kBreakColor;
+                span.title = period.label;
+            }
+            visit(span);
+        }
+    }
+}
+
+void TimelineIndex::forEachDeadline(qint64 from, qint64 to, const std::function<void(const Mark &)> &visit) const
+{
+    auto it = std::lower_bound(mDeadlines.cbegin(), mDeadlines.cend(), from, [](const Mark &mark, qint64 time) {
+        return mark.time < time;
+    });
+    for (; it != mDeadlines.cend() && it->time < to; ++it)
+    {
+        visit(*it);
+    }
+}
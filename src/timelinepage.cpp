@@ -0,0 +1,555 @@
+#include "timelinepage.h"
+#include "theme.h"
+
+#include <QBoxLayout>
+#include <QDateTime>
+#include <QFontMetricsF>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QStringList>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr qint64 kHourMsecs = 60 * 60 * 1000;
+constexpr qint64 kDayMsecs = 24 * kHourMsecs;
+constexpr qint64 kMinSpan = kHourMsecs;
+constexpr qint64 kMaxSpan = 366 * kDayMsecs;
+// How far the scroll bar reaches beyond the data on either side.
+constexpr qint64 kScrollMargin = 365 * kDayMsecs;
+
+constexpr qreal kTickHeight = 28.0;
+constexpr qreal kLaneLabelHeight = 18.0;
+constexpr qreal kLaneSpacing = 12.0;
+constexpr qreal kDeadlineLaneHeight = 44.0;
+constexpr qreal kMinTickSpacing = 72.0;
+// Items narrower than this are binned into the density strip instead of drawn.
+constexpr qreal kDetailMinWidth = 3.0;
+constexpr qreal kTitleMinWidth = 40.0;
+constexpr qreal kMarkerMergeWidth = 6.0;
+constexpr qreal kRadius = 4.0;
+constexpr qreal kPadding = 6.0;
+
+const QColor kGridColor(0xE0, 0xE0, 0xE0);
+const QColor kLabelColor(0x66, 0x66, 0x66);
+const QColor kDensityColor(0x75, 0x75, 0x75);
+const QColor kDeadlineColor(0xE5, 0x39, 0x35);
+const QColor kNowColor(0x1E, 0x88, 0xE5);
+
+qint64 zoomSpan(TimelinePage::Zoom zoom)
+{
+    switch (zoom)
+    {
+    case TimelinePage::Day:
+        return kDayMsecs;
+    case TimelinePage::Week:
+        return 7 * kDayMsecs;
+    case TimelinePage::Month:
+        return 31 * kDayMsecs;
+    }
+    return 7 * kDayMsecs;
+}
+}
+
+TimelineWidget::TimelineWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setCursor(Qt::OpenHandCursor);
+
+    mLabelFont = font();
+    mLabelFont.setPixelSize(12);
+
+    mItemFont = font();
+    mItemFont.setPixelSize(12);
+    mItemFont.setBold(true);
+}
+
+void TimelineWidget::setIndex(const TimelineIndex *index)
+{
+    mIndex = index;
+    update();
+}
+
+void TimelineWidget::setView(qint64 start, qint64 span)
+{
+    span = std::clamp(span, kMinSpan, kMaxSpan);
+    if (start == mViewStart && span == mViewSpan)
+    {
+        return;
+    }
+    mViewStart = start;
+    mViewSpan = span;
+    update();
+    emit viewChanged(mViewStart, mViewSpan);
+}
+
+qint64 TimelineWidget::viewStart() const
+{
+    return mViewStart;
+}
+
+qint64 TimelineWidget::viewSpan() const
+{
+    return mViewSpan;
+}
+
+void TimelineWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    if (!mIndex || mViewSpan <= 0 || width() <= 0)
+    {
+        return;
+    }
+
+    drawTicks(painter);
+
+    const qreal laneHeight = std::max((height() - kTickHeight - kDeadlineLaneHeight - 3 * kLaneSpacing) / 2.0, kLaneLabelHeight * 2);
+    QRectF lane(0.0, kTickHeight + kLaneSpacing, width(), laneHeight);
+    drawSpanLane(painter, lane, tr("Classes"), true);
+    lane.translate(0.0, laneHeight + kLaneSpacing);
+    drawSpanLane(painter, lane, tr("Activities"), false);
+    drawDeadlineLane(painter, QRectF(0.0, lane.bottom() + kLaneSpacing, width(), kDeadlineLaneHeight));
+
+    const qreal now = xFor(QDateTime::currentMSecsSinceEpoch());
+    if (now >= 0.0 && now <= width())
+    {
+        painter.setPen(QPen(kNowColor, 2.0));
+        painter.drawLine(QPointF(now, kTickHeight), QPointF(now, height()));
+    }
+}
+
+void TimelineWidget::wheelEvent(QWheelEvent *event)
+{
+    const qreal steps = event->angleDelta().y() / 120.0;
+    if (event->modifiers() & Qt::ControlModifier)
+    {
+        // Zoom around the time under the pointer.
+        const qint64 anchor = timeAt(event->position().x());
+        const qint64 span = std::clamp(static_cast<qint64>(mViewSpan * std::pow(0.8, steps)), kMinSpan, kMaxSpan);
+        const qreal ratio = width() > 0 ? event->position().x() / width() : 0.5;
+        setView(anchor - static_cast<qint64>(span * ratio), span);
+    }
+    else
+    {
+        const qreal delta = event->angleDelta().x() != 0 ? event->angleDelta().x() / 120.0 : steps;
+        setView(mViewStart - static_cast<qint64>(mViewSpan * delta / 10.0), mViewSpan);
+    }
+    event->accept();
+}
+
+void TimelineWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        mDragging = true;
+        mDragX = event->position().x();
+        mDragStart = mViewStart;
+        setCursor(Qt::ClosedHandCursor);
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void TimelineWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (mDragging && width() > 0)
+    {
+        const qreal dx = event->position().x() - mDragX;
+        setView(mDragStart - static_cast<qint64>(dx / width() * mViewSpan), mViewSpan);
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void TimelineWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        mDragging = false;
+        setCursor(Qt::OpenHandCursor);
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void TimelineWidget::drawTicks(QPainter &painter) const
+{
+    // Pick the smallest step that leaves room for a label.
+    static const qint64 kSteps[] = {kHourMsecs, 3 * kHourMsecs, 6 * kHourMsecs, 12 * kHourMsecs, kDayMsecs, 7 * kDayMsecs};
+    qint64 step = 0;
+    for (const qint64 candidate : kSteps)
+    {
+        if (candidate * width() / mViewSpan >= kMinTickSpacing)
+        {
+            step = candidate;
+            break;
+        }
+    }
+
+    QVector<QDateTime> ticks;
+    const QDateTime viewEnd = QDateTime::fromMSecsSinceEpoch(mViewStart + mViewSpan);
+    const QDate firstDate = QDateTime::fromMSecsSinceEpoch(mViewStart).date();
+    if (step == 0)
+    {
+        // Wider than a week per label: one tick per month.
+        for (QDate date(firstDate.year(), firstDate.month(), 1); date.startOfDay() <= viewEnd; date = date.addMonths(1))
+        {
+            ticks.append(date.startOfDay());
+        }
+    }
+    else if (step < kDayMsecs)
+    {
+        for (QDateTime time = firstDate.startOfDay(); time <= viewEnd; time = time.addMSecs(step))
+        {
+            ticks.append(time);
+        }
+    }
+    else
+    {
+        const int days = static_cast<int>(step / kDayMsecs);
+        const QDate first = days == 7 ? firstDate.addDays(1 - firstDate.dayOfWeek()) : firstDate;
+        for (QDate date = first; date.startOfDay() <= viewEnd; date = date.addDays(days))
+        {
+            ticks.append(date.startOfDay());
+        }
+    }
+
+    painter.setFont(mLabelFont);
+    const QFontMetricsF metrics(mLabelFont);
+    for (const QDateTime &tick : ticks)
+    {
+        const qreal x = xFor(tick.toMSecsSinceEpoch());
+        if (x < 0.0)
+        {
+            continue;
+        }
+        const bool midnight = tick.time() == QTime(0, 0);
+        painter.setPen(kGridColor);
+        painter.drawLine(QPointF(x, kTickHeight - 6.0), QPointF(x, height()));
+
+        QString label;
+        if (step == 0)
+        {
+            label = tick.toString(QStringLiteral("MMM yyyy"));
+        }
+        else if (step < kDayMsecs && !midnight)
+        {
+            label = tick.toString(QStringLiteral("HH:mm"));
+        }
+        else
+        {
+            label = tick.toString(QStringLiteral("ddd d MMM"));
+        }
+        painter.setPen(kLabelColor);
+        painter.drawText(QPointF(x + 4.0, metrics.ascent() + 4.0), label);
+    }
+}
+
+void TimelineWidget::drawSpanLane(QPainter &painter, const QRectF &lane, const QString &title, bool periods) const
+{
+    const QFontMetricsF labelMetrics(mLabelFont);
+    painter.setFont(mLabelFont);
+    painter.setPen(kLabelColor);
+    painter.drawText(QPointF(lane.left() + kPadding, lane.top() + labelMetrics.ascent()), title);
+
+    const QRectF bars = lane.adjusted(0.0, kLaneLabelHeight, 0.0, 0.0);
+    const int columns = width();
+    QVector<quint16> density(columns, 0);
+    const QFontMetricsF itemMetrics(mItemFont);
+    painter.setFont(mItemFont);
+
+    const auto draw = [&](const TimelineIndex::Span &span) {
+        const qreal x0 = std::max(xFor(span.start), 0.0);
+        const qreal x1 = std::min(xFor(span.end), qreal(columns));
+        if (x1 - x0 < kDetailMinWidth)
+        {
+            const int first = std::clamp(static_cast<int>(x0), 0, columns - 1);
+            const int last = std::clamp(static_cast<int>(x1), first, columns - 1);
+            for (int column = first; column <= last; ++column)
+            {
+                density[column] = std::min<int>(density.at(column) + 1, 0xFFFF);
+            }
+            return;
+        }
+
+        const QRectF rect(x0, bars.top(), x1 - x0, bars.height());
+        QColor fill = span.color.isValid() ? span.color : kDensityColor;
+        fill.setAlpha(periods ? 255 : 210);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(fill);
+        painter.drawRoundedRect(rect.adjusted(0.5, 0.0, -0.5, 0.0), kRadius, kRadius);
+        if (rect.width() >= kTitleMinWidth)
+        {
+            painter.setPen(Qt::black);
+            painter.drawText(rect.adjusted(kPadding, kPadding, -kPadding, 0.0).topLeft() + QPointF(0.0, itemMetrics.ascent()),
+                             itemMetrics.elidedText(span.title, Qt::ElideRight, rect.width() - 2 * kPadding));
+        }
+    };
+    if (periods)
+    {
+        mIndex->forEachPeriod(mViewStart, mViewStart + mViewSpan, draw);
+    }
+    else
+    {
+        mIndex->forEachActivity(mViewStart, mViewStart + mViewSpan, draw);
+    }
+
+    // One rectangle per run of equal density, shaded by how many items it holds.
+    painter.setPen(Qt::NoPen);
+    for (int column = 0; column < columns;)
+    {
+        const quint16 count = density.at(column);
+        int end = column + 1;
+        while (end < columns && density.at(end) == count)
+        {
+            ++end;
+        }
+        if (count > 0)
+        {
+            QColor shade = kDensityColor;
+            shade.setAlpha(std::min(60 + 40 * count, 255));
+            painter.setBrush(shade);
+            painter.drawRect(QRectF(column, bars.top(), end - column, bars.height()));
+        }
+        column = end;
+    }
+}
+
+void TimelineWidget::drawDeadlineLane(QPainter &painter, const QRectF &lane) const
+{
+    const QFontMetricsF metrics(mLabelFont);
+    painter.setFont(mLabelFont);
+    painter.setPen(kLabelColor);
+    painter.drawText(QPointF(lane.left() + kPadding, lane.top() + metrics.ascent()), tr("Deadlines"));
+
+    struct Cluster
+    {
+        qreal x = 0.0;
+        int count = 0;
+        QString title;
+    };
+    // Bounded by the width in marker slots, however many deadlines are in view.
+    QVector<Cluster> clusters;
+    mIndex->forEachDeadline(mViewStart, mViewStart + mViewSpan, [&](const TimelineIndex::Mark &mark) {
+        const qreal x = xFor(mark.time);
+        if (!clusters.isEmpty() && x - clusters.last().x < kMarkerMergeWidth)
+        {
+            ++clusters.last().count;
+            return;
+        }
+        clusters.append({x, 1, mark.title});
+    });
+
+    const qreal markerY = lane.top() + kLaneLabelHeight + 6.0;
+    for (int i = 0; i < clusters.size(); ++i)
+    {
+        const Cluster &cluster = clusters.at(i);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(kDeadlineColor);
+        const qreal size = cluster.count > 1 ? 6.0 : 4.5;
+        const QPointF diamond[] = {{cluster.x, markerY - size}, {cluster.x + size, markerY}, {cluster.x, markerY + size}, {cluster.x - size, markerY}};
+        painter.drawPolygon(diamond, 4);
+
+        const qreal room = (i + 1 < clusters.size() ? clusters.at(i + 1).x : lane.right()) - cluster.x - 2 * kPadding;
+        const QString label = cluster.count > 1 ? QString::number(cluster.count) : cluster.title;
+        if (room >= kTitleMinWidth || cluster.count > 1)
+        {
+            painter.setPen(kLabelColor);
+            painter.drawText(QPointF(cluster.x + kPadding + 2.0, markerY + metrics.ascent() / 2.0 - 1.0),
+                             metrics.elidedText(label, Qt::ElideRight, std::max(room, metrics.horizontalAdvance(label))));
+        }
+    }
+}
+
+qreal TimelineWidget::xFor(qint64 time) const
+{
+    return static_cast<qreal>(time - mViewStart) * width() / mViewSpan;
+}
+
+qint64 TimelineWidget::timeAt(qreal x) const
+{
+    return mViewStart + static_cast<qint64>(x / std::max(width(), 1) * mViewSpan);
+}
+
+TimelinePage::TimelinePage(QWidget *parent)
+    : QWidget(parent)
+{
+    createLayout();
+    mTimeline->setIndex(&mIndex);
+    mHeatmap->setIndex(&mWorkload);
+    showToday();
+}
+
+void TimelinePage::setSnapshot(const AppSnapshotPtr &snapshot)
+{
+    mSnapshot = snapshot;
+    if (isVisible())
+    {
+        rebuildIndex();
+    }
+}
+
+void TimelinePage::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (mSnapshot && mSnapshot->version != mIndex.version())
+    {
+        rebuildIndex();
+    }
+}
+
+void TimelinePage::createLayout()
+{
+    auto *mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(24, 24, 24, 24);
+    mainLayout->setSpacing(16);
+
+    auto *headerLayout = new QHBoxLayout();
+    headerLayout->setSpacing(12);
+
+    auto *title = new QLabel(tr("Timeline"), this);
+    Theme::setRole(title, "pageTitle");
+    headerLayout->addWidget(title);
+    headerLayout->addStretch(1);
+
+    mZoomGroup = new QButtonGroup(this);
+    mZoomGroup->setExclusive(true);
+    const QList<QPair<Zoom, QString>> zooms = {{Day, tr("Day")}, {Week, tr("Week")}, {Month, tr("Month")}};
+    for (const auto &zoom : zooms)
+    {
+        auto *button = new QPushButton(zoom.second, this);
+        button->setCheckable(true);
+        button->setChecked(zoom.first == mZoom);
+        button->setCursor(Qt::PointingHandCursor);
+        Theme::setRole(button, "chip");
+        mZoomGroup->addButton(button, zoom.first);
+        headerLayout->addWidget(button);
+    }
+
+    auto *todayButton = new QPushButton(tr("Today"), this);
+    todayButton->setCursor(Qt::PointingHandCursor);
+    Theme::setRole(todayButton, "chip");
+    headerLayout->addSpacing(8);
+    headerLayout->addWidget(todayButton);
+
+    mainLayout->addLayout(headerLayout);
+
+    mRangeLabel = new QLabel(this);
+    Theme::setRole(mRangeLabel, "secondary");
+    mainLayout->addWidget(mRangeLabel);
+
+    auto *workloadTitle = new QLabel(tr("Workload"), this);
+    Theme::setRole(workloadTitle, "sectionTitle");
+    mainLayout->addWidget(workloadTitle);
+
+    mHeatmap = new WorkloadHeatmap(this);
+    mainLayout->addWidget(mHeatmap);
+
+    mWorkloadLabel = new QLabel(this);
+    Theme::setRole(mWorkloadLabel, "muted");
+    mainLayout->addWidget(mWorkloadLabel);
+
+    mTimeline = new TimelineWidget(this);
+    mainLayout->addWidget(mTimeline, 1);
+
+    mScrollBar = new QScrollBar(Qt::Horizontal, this);
+    mainLayout->addWidget(mScrollBar);
+
+    connect(mZoomGroup, &QButtonGroup::idClicked, this, [this](int id) {
+        setZoom(static_cast<Zoom>(id));
+    });
+    connect(todayButton, &QPushButton::clicked, this, &TimelinePage::showToday);
+    connect(mScrollBar, &QScrollBar::valueChanged, this, [this](int value) {
+        mTimeline->setView(mScrollOrigin + value * kHourMsecs, mTimeline->viewSpan());
+    });
+    connect(mHeatmap, &WorkloadHeatmap::dayActivated, this, [this](const QDate &day) {
+        mTimeline->setView(day.startOfDay().toMSecsSinceEpoch(), mTimeline->viewSpan());
+    });
+    connect(mTimeline, &TimelineWidget::viewChanged, this, [this]() {
+        updateScrollBar();
+        updateRangeLabel();
+    });
+}
+
+void TimelinePage::rebuildIndex()
+{
+    mIndex.rebuild(*mSnapshot);
+    mWorkload.sync(*mSnapshot);
+    updateScrollBar();
+    updateWorkloadSummary();
+    mTimeline->update();
+    mHeatmap->update();
+}
+
+void TimelinePage::setZoom(Zoom zoom)
+{
+    mZoom = zoom;
+    const qint64 span = zoomSpan(zoom);
+    const qint64 center = mTimeline->viewStart() + mTimeline->viewSpan() / 2;
+    mTimeline->setView(center - span / 2, span);
+}
+
+void TimelinePage::showToday()
+{
+    const QDate today = QDate::currentDate();
+    QDate first = today;
+    if (mZoom == Week)
+    {
+        first = today.addDays(1 - today.dayOfWeek());
+    }
+    else if (mZoom == Month)
+    {
+        first = QDate(today.year(), today.month(), 1);
+    }
+    mTimeline->setView(first.startOfDay().toMSecsSinceEpoch(), zoomSpan(mZoom));
+}
+
+void TimelinePage::updateScrollBar()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 start = mTimeline->viewStart();
+    const qint64 span = mTimeline->viewSpan();
+    qint64 first = now;
+    qint64 last = now;
+    if (mIndex.lastTime() != 0)
+    {
+        first = std::min(first, mIndex.firstTime());
+        last = std::max(last, mIndex.lastTime());
+    }
+    // The view itself may have been dragged past the data.
+    mScrollOrigin = std::min(first - kScrollMargin, start);
+    const qint64 end = std::max(last + kScrollMargin, start + span);
+
+    const QSignalBlocker blocker(mScrollBar);
+    mScrollBar->setRange(0, static_cast<int>((end - span - mScrollOrigin) / kHourMsecs));
+    mScrollBar->setPageStep(static_cast<int>(std::max<qint64>(span / kHourMsecs, 1)));
+    mScrollBar->setSingleStep(static_cast<int>(std::max<qint64>(span / kHourMsecs / 10, 1)));
+    mScrollBar->setValue(static_cast<int>((start - mScrollOrigin) / kHourMsecs));
+}
+
+void TimelinePage::updateRangeLabel()
+{
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(mTimeline->viewStart());
+    const QDateTime to = QDateTime::fromMSecsSinceEpoch(mTimeline->viewStart() + mTimeline->viewSpan());
+    mRangeLabel->setText(tr("%1 - %2").arg(from.toString(QStringLiteral("ddd d MMM yyyy HH:mm")), to.toString(QStringLiteral("ddd d MMM yyyy HH:mm"))));
+}
+
+void TimelinePage::updateWorkloadSummary()
+{
+    const QDate today = QDate::currentDate();
+    QStringList parts;
+    for (const int days : {7, 30})
+    {
+        const QDate last = today.addDays(days - 1);
+        parts << tr("Next %1 days: %2 weighting due, %3 h of activities")
+                     .arg(days)
+                     .arg(mWorkload.dueWeighting(today, last), 0, 'f', 1)
+                     .arg(mWorkload.activityMinutes(today, last) / 60.0, 0, 'f', 1);
+    }
+    mWorkloadLabel->setText(parts.join(QStringLiteral("   ")));
+}
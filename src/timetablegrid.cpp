@@ -0,0 +1,360 @@
+#include "timetablegrid.h"
+
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QToolTip>
+
+#include <algorithm>
+
+namespace
+{
+constexpr qreal kSpacing = 16.0;
+constexpr qreal kHeaderHeight = 28.0;
+constexpr qreal kMinCellHeight = 72.0;
+constexpr qreal kPadding = 16.0;
+constexpr qreal kTextSpacing = 8.0;
+constexpr qreal kRadius = 12.0;
+constexpr int kMaxCachedModels = 24;
+
+const QColor kBorderColor(0xE0, 0xE0, 0xE0);
+const QColor kHoverBorderColor(0x9E, 0x9E, 0x9E);
+const QColor kSubtitleColor(0x66, 0x66, 0x66);
+const QColor kPlaceholderColor(0xFA, 0xFA, 0xFA);
+
+QString periodSubtitle(const TimetablePeriod &period)
+{
+    const QString range = QStringLiteral("%1 - %2").arg(period.startTime.toString("HH:mm"), period.endTime.toString("HH:mm"));
+    if (period.room.isEmpty())
+    {
+        return range;
+    }
+    return period.room + QChar(QChar::LineSeparator) + range;
+}
+}
+
+TimetableGridWidget::TimetableGridWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMouseTracking(true);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    mCache.setMaxCost(kMaxCachedModels);
+
+    mHeaderFont = font();
+    mHeaderFont.setPixelSize(16);
+    mHeaderFont.setBold(true);
+
+    mTitleFont = font();
+    mTitleFont.setPixelSize(15);
+    mTitleFont.setBold(true);
+
+    mSpecialTitleFont = mTitleFont;
+    mSpecialTitleFont.setItalic(true);
+
+    mSubtitleFont = font();
+}
+
+TimetableGridWidget::Style TimetableGridWidget::gridStyle() const
+{
+    return {mHeaderFont, mTitleFont, mSpecialTitleFont, mSubtitleFont, QSizeF(size())};
+}
+
+void TimetableGridWidget::setColumns(const QVector<TimetableGridColumn> &columns, const QString &cacheKey)
+{
+    installModel(buildModel(columns, gridStyle()), cacheKey);
+}
+
+void TimetableGridWidget::cacheModel(const QString &cacheKey, Model model)
+{
+    if (cacheKey.isEmpty() || cacheKey == mModelKey)
+    {
+        return;
+    }
+
+    // A resize since the model was laid out only moves rects; text is re-shaped
+    // only if the wrap width changed.
+    auto *cached = new Model(std::move(model));
+    layoutModel(*cached, gridStyle());
+    mCache.insert(cacheKey, cached);
+}
+
+bool TimetableGridWidget::hasCachedModel(const QString &cacheKey) const
+{
+    return !cacheKey.isEmpty() && (cacheKey == mModelKey || mCache.contains(cacheKey));
+}
+
+bool TimetableGridWidget::showCachedModel(const QString &cacheKey)
+{
+    if (cacheKey.isEmpty())
+    {
+        return false;
+    }
+    if (cacheKey == mModelKey)
+    {
+        return true;
+    }
+
+    Model *cached = mCache.take(cacheKey);
+    if (!cached)
+    {
+        return false;
+    }
+
+    Model model = std::move(*cached);
+    delete cached;
+    installModel(std::move(model), cacheKey);
+    return true;
+}
+
+void TimetableGridWidget::clearCache()
+{
+    mCache.clear();
+    mModelKey.clear();
+}
+
+int TimetableGridWidget::cellAt(const QPointF &pos) const
+{
+    for (int i = 0; i < mModel.cells.size(); ++i)
+    {
+        if (mModel.cells.at(i).rect.contains(pos))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TimetableGridWidget::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        auto *helpEvent = static_cast<QHelpEvent *>(event);
+        const int index = cellAt(helpEvent->pos());
+        if (index < 0 || mModel.cells.at(index).placeholder)
+        {
+            QToolTip::hideText();
+            event->ignore();
+            return true;
+        }
+
+        const auto &period = mModel.cells.at(index).period;
+        QStringList lines;
+        lines << (period.subjectName.isEmpty() ? period.periodKey : period.subjectName);
+        if (!period.teacher.isEmpty())
+        {
+            lines << tr("Teacher: %1").arg(period.teacher);
+        }
+        if (!period.room.isEmpty())
+        {
+            lines << tr("Room: %1").arg(period.room);
+        }
+        QToolTip::showText(helpEvent->globalPos(), lines.join('\n'), this, mModel.cells.at(index).rect.toRect());
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void TimetableGridWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    painter.setFont(mHeaderFont);
+    painter.setPen(Qt::black);
+    for (int i = 0; i < mModel.headers.size(); ++i)
+    {
+        if (mModel.headerRects.at(i).intersects(event->rect()))
+        {
+            painter.drawStaticText(mModel.headerRects.at(i).topLeft(), mModel.headers.at(i));
+        }
+    }
+
+    for (int i = 0; i < mModel.cells.size(); ++i)
+    {
+        const Cell &cell = mModel.cells.at(i);
+        if (!cell.rect.intersects(event->rect()))
+        {
+            continue;
+        }
+
+        // Inset by half a pixel so the 1px border lands on pixel centres.
+        const QRectF frame = cell.rect.adjusted(0.5, 0.5, -0.5, -0.5);
+        QPen border(i == mHoverIndex ? kHoverBorderColor : kBorderColor);
+        border.setWidthF(1.0);
+        border.setStyle(cell.placeholder ? Qt::DashLine : Qt::SolidLine);
+        painter.setPen(border);
+        painter.setBrush(cell.background);
+        painter.drawRoundedRect(frame, kRadius, kRadius);
+
+        const QPointF titlePos = cell.rect.topLeft() + QPointF(kPadding, kPadding);
+        painter.setPen(Qt::black);
+        painter.setFont(cell.period.isSpecial ? mSpecialTitleFont : mTitleFont);
+        painter.drawStaticText(titlePos, cell.title);
+
+        painter.setPen(kSubtitleColor);
+        painter.setFont(mSubtitleFont);
+        painter.drawStaticText(titlePos + QPointF(0.0, cell.title.size().height() + kTextSpacing), cell.subtitle);
+    }
+}
+
+void TimetableGridWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    layoutModel(mModel, gridStyle());
+}
+
+void TimetableGridWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    setHoverIndex(cellAt(event->position()));
+    QWidget::mouseMoveEvent(event);
+}
+
+void TimetableGridWidget::mousePressEvent(QMouseEvent *event)
+{
+    const int index = cellAt(event->position());
+    if (event->button() == Qt::LeftButton && index >= 0 && !mModel.cells.at(index).placeholder)
+    {
+        emit periodActivated(mModel.cells.at(index).period);
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void TimetableGridWidget::leaveEvent(QEvent *event)
+{
+    setHoverIndex(-1);
+    QWidget::leaveEvent(event);
+}
+
+TimetableGridWidget::Model TimetableGridWidget::buildModel(const QVector<TimetableGridColumn> &columns, const Style &style)
+{
+    Model model;
+    model.columnCount = columns.size();
+
+    for (int column = 0; column < columns.size(); ++column)
+    {
+        const auto &source = columns.at(column);
+
+        QStaticText header(source.title);
+        header.setTextFormat(Qt::PlainText);
+        model.headers.append(header);
+
+        if (source.periods.isEmpty())
+        {
+            Cell cell;
+            cell.column = column;
+            cell.placeholder = true;
+            cell.background = kPlaceholderColor;
+            cell.title.setText(tr("No Periods"));
+            cell.subtitle.setText(tr("No Period"));
+            model.cells.append(cell);
+            model.rowCount = std::max(model.rowCount, 1);
+            continue;
+        }
+
+        int row = 0;
+        for (const auto &period : source.periods)
+        {
+            Cell cell;
+            cell.column = column;
+            cell.row = row++;
+            cell.period = period;
+
+            QColor background = period.color.isValid() ? period.color : QColor("#F5F5F5");
+            cell.background = period.isSpecial ? background.lighter(140) : background;
+
+            cell.title.setText(period.subjectName.isEmpty() ? period.periodKey : period.subjectName);
+            cell.subtitle.setText(periodSubtitle(period));
+            model.cells.append(cell);
+        }
+        model.rowCount = std::max(model.rowCount, row);
+    }
+
+    for (auto &cell : model.cells)
+    {
+        cell.title.setTextFormat(Qt::PlainText);
+        cell.subtitle.setTextFormat(Qt::PlainText);
+    }
+    layoutModel(model, style);
+    return model;
+}
+
+void TimetableGridWidget::layoutModel(Model &model, const Style &style)
+{
+    const int columns = model.columnCount;
+    if (columns == 0)
+    {
+        model.headerRects.clear();
+        return;
+    }
+
+    const qreal columnWidth = std::max(1.0, (style.size.width() - kSpacing * (columns - 1)) / columns);
+    const qreal bodyTop = kHeaderHeight + kSpacing;
+    const int rows = std::max(1, model.rowCount);
+    const qreal rowHeight = std::max(kMinCellHeight, (style.size.height() - bodyTop - kSpacing * (rows - 1)) / rows);
+    const qreal textWidth = std::max(1.0, columnWidth - 2.0 * kPadding);
+
+    model.headerRects.resize(columns);
+    for (int column = 0; column < columns; ++column)
+    {
+        const qreal x = column * (columnWidth + kSpacing);
+        model.headerRects[column] = QRectF(x, 0.0, columnWidth, kHeaderHeight);
+        if (!qFuzzyCompare(model.headers.at(column).textWidth(), columnWidth))
+        {
+            model.headers[column].setTextWidth(columnWidth);
+            model.headers[column].prepare(QTransform(), style.headerFont);
+        }
+    }
+
+    for (auto &cell : model.cells)
+    {
+        const qreal x = cell.column * (columnWidth + kSpacing);
+        const qreal y = bodyTop + cell.row * (rowHeight + kSpacing);
+        cell.rect = QRectF(x, y, columnWidth, rowHeight);
+
+        // Only re-shape text when the wrap width actually changes.
+        if (!qFuzzyCompare(cell.title.textWidth(), textWidth))
+        {
+            cell.title.setTextWidth(textWidth);
+            cell.subtitle.setTextWidth(textWidth);
+            cell.title.prepare(QTransform(), cell.period.isSpecial ? style.specialTitleFont : style.titleFont);
+            cell.subtitle.prepare(QTransform(), style.subtitleFont);
+        }
+    }
+}
+
+void TimetableGridWidget::installModel(Model model, const QString &cacheKey)
+{
+    if (!mModelKey.isEmpty() && mModelKey != cacheKey)
+    {
+        mCache.insert(mModelKey, new Model(std::move(mModel)));
+    }
+
+    mModel = std::move(model);
+    mModelKey = cacheKey;
+    mHoverIndex = -1;
+
+    const int rows = mModel.rowCount;
+    const int minimumHeight = static_cast<int>(kHeaderHeight + kSpacing + rows * kMinCellHeight + std::max(0, rows - 1) * kSpacing);
+    setMinimumHeight(minimumHeight);
+    layoutModel(mModel, gridStyle());
+    update();
+}
+
+void TimetableGridWidget::setHoverIndex(int index)
+{
+    if (index == mHoverIndex)
+    {
+        return;
+    }
+
+    if (mHoverIndex >= 0 && mHoverIndex < mModel.cells.size())
+    {
+        update(mModel.cells.at(mHoverIndex).rect.toAlignedRect());
+    }
+    mHoverIndex = index;
+    if (mHoverIndex >= 0)
+    {
+        update(mModel.cells.at(mHoverIndex).rect.toAlignedRect());
+    }
+}
@@ -1,12 +1,19 @@
 #include "timetablepage.h"
+#include "theme.h"
 
 #include <QBoxLayout>
 #include <QButtonGroup>
+#include <QCompleter>
 #include <QDate>
+#include <QDateTime>
+#include <QHideEvent>
 #include <QLabel>
+#include <QLineEdit>
 #include <QPushButton>
-#include <QScrollArea>
-#include <QStyleOption>
+#include <QShowEvent>
+#include <QSignalBlocker>
+#include <QStringList>
+#include <QStringListModel>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -14,95 +21,75 @@
 
 namespace
 {
-const QStringList kDays = {QStringLiteral("Monday"), QStringLiteral("Tuesday"), QStringLiteral("Wednesday"), QStringLiteral("Thursday"), QStringLiteral("Friday")};
+constexpr int kSaveDelayMs = 400;
+constexpr int kMinuteMs = 60 * 1000;
 }
 
-TimetableCard::TimetableCard(QWidget *parent)
-    : QFrame(parent)
+TimetablePage::TimetablePage(QWidget *parent)
+    : QWidget(parent)
 {
-    setObjectName(QStringLiteral("TimetableCard"));
-    setFrameShape(QFrame::NoFrame);
-    setStyleSheet(QStringLiteral("#TimetableCard { border-radius: 12px; background: #FFFFFF; border: 1px solid #E0E0E0; }") );
-
-    auto *layout = new QVBoxLayout(this);
-    layout->setContentsMargins(16, 16, 16, 16);
-    layout->setSpacing(8);
-
-    mTitle = new QLabel(this);
-    mTitle->setWordWrap(true);
-    mTitle->setStyleSheet(QStringLiteral("font-size: 15px; font-weight: bold;"));
+    mSaveTimer = new QTimer(this);
+    mSaveTimer->setSingleShot(true);
+    mSaveTimer->setInterval(kSaveDelayMs);
+    connect(mSaveTimer, &QTimer::timeout, this, [this]() {
+        emit settingsChanged(mSettings);
+    });
 
-    mSubtitle = new QLabel(this);
-    mSubtitle->setStyleSheet(QStringLiteral("color: #666666;"));
-    mSubtitle->setWordWrap(true);
+    createLayout();
 
-    layout->addWidget(mTitle);
-    layout->addWidget(mSubtitle);
+    // "Next" times are relative to now, so they move on without a schedule change.
+    // The timer only runs while the page is shown.
+    mMinuteTimer = new QTimer(this);
+    mMinuteTimer->setInterval(kMinuteMs);
+    connect(mMinuteTimer, &QTimer::timeout, this, [this]() {
+        rebuildSubjectSummary();
+        updateFacetLookup();
+    });
 }
 
-void TimetableCard::setPeriod(const TimetablePeriod &period)
+void TimetablePage::showEvent(QShowEvent *event)
 {
-    QString subtitle;
-    if (!period.room.isEmpty())
-    {
-        subtitle = QStringLiteral("%1\n%2 - %3")
-                       .arg(period.room, period.startTime.toString("HH:mm"), period.endTime.toString("HH:mm"));
-    }
-    else
-    {
-        subtitle = QStringLiteral("%1 - %2")
-                       .arg(period.startTime.toString("HH:mm"), period.endTime.toString("HH:mm"));
-    }
-
-    mTitle->setText(period.subjectName.isEmpty() ? period.periodKey : period.subjectName);
-    mSubtitle->setText(subtitle);
-
-    QColor background = period.color.isValid() ? period.color : QColor("#F5F5F5");
-    if (period.isSpecial)
-    {
-        background = background.lighter(140);
-        QFont font = mTitle->font();
-        font.setItalic(true);
-        mTitle->setFont(font);
-    }
-    else
-    {
-        QFont font = mTitle->font();
-        font.setItalic(false);
-        mTitle->setFont(font);
-    }
-
-    setStyleSheet(QStringLiteral("#TimetableCard { border-radius: 12px; border: 1px solid #E0E0E0; background: %1; }")
-                      .arg(background.name(QColor::HexRgb)));
+    QWidget::showEvent(event);
+    rebuildSubjectSummary();
+    updateFacetLookup();
+    mMinuteTimer->start();
 }
 
-void TimetableCard::setEmptyLabel(const QString &label)
+void TimetablePage::hideEvent(QHideEvent *event)
 {
-    mTitle->setText(label);
-    mSubtitle->setText(tr("No Period"));
-    setStyleSheet(QStringLiteral("#TimetableCard { border-radius: 12px; border: 1px dashed #E0E0E0; background: #FAFAFA; }") );
+    QWidget::hideEvent(event);
+    mMinuteTimer->stop();
 }
 
-TimetablePage::TimetablePage(QWidget *parent)
-    : QWidget(parent)
+void TimetablePage::setJsonManager(JsonManager *manager)
 {
-    createLayout();
+    mJsonManager = manager;
 }
 
-void TimetablePage::setJsonManager(JsonManager *manager)
+void TimetablePage::setScheduler(TaskScheduler *scheduler)
 {
-    mJsonManager = manager;
+    mScheduler = scheduler;
 }
 
-void TimetablePage::setSchoolPeriods(const SchoolPeriodsData &data)
+void TimetablePage::setSchedule(const ScheduleIndex &schedule)
 {
-    mData = data;
-    rebuildTimetable();
+    mSchedule = schedule;
 }
 
 void TimetablePage::setSettings(const SettingsData &settings)
 {
     mSettings = settings;
+}
+
+void TimetablePage::refreshSchedule()
+{
+    rebuildWeekButtons();
+    rebuildVariants();
+    rebuildFacetCompleter();
+}
+
+void TimetablePage::refreshWeek()
+{
     rebuildTimetable();
 }
 
@@ -116,7 +103,7 @@ void TimetablePage::createLayout()
     headerLayout->setSpacing(12);
 
     auto *title = new QLabel(tr("Timetable"), this);
-    title->setStyleSheet(QStringLiteral("font-size: 24px; font-weight: bold;"));
+    Theme::setRole(title, "pageTitle");
 
     headerLayout->addWidget(title);
     headerLayout->addStretch(1);
@@ -125,166 +112,362 @@ void TimetablePage::createLayout()
     headerLayout->addWidget(mWeekLabel);
 
     mWeekGroup = new QButtonGroup(this);
-    auto *weekALabel = new QPushButton(tr("A Week"), this);
-    weekALabel->setCheckable(true);
-    auto *weekBLabel = new QPushButton(tr("B Week"), this);
-    weekBLabel->setCheckable(true);
-    weekALabel->setStyleSheet(QStringLiteral("QPushButton { padding: 6px 12px; border-radius: 16px; border: 1px solid #E0E0E0; }"
-                                          "QPushButton:checked { background: #000000; color: #FFFFFF; }"));
-    weekBLabel->setStyleSheet(weekALabel->styleSheet());
+    mWeekButtonLayout = new QHBoxLayout();
+    mWeekButtonLayout->setSpacing(12);
+    headerLayout->addLayout(mWeekButtonLayout);
 
-    mWeekGroup->addButton(weekALabel, 0);
-    mWeekGroup->addButton(weekBLabel, 1);
+    mainLayout->addLayout(headerLayout);
 
-    headerLayout->addWidget(weekALabel);
-    headerLayout->addWidget(weekBLabel);
+    auto *navigationLayout = new QHBoxLayout();
+    navigationLayout->setSpacing(8);
 
-    mainLayout->addLayout(headerLayout);
+    auto *previousButton = new QPushButton(tr("< Previous"), this);
+    auto *todayButton = new QPushButton(tr("This Week"), this);
+    auto *nextButton = new QPushButton(tr("Next >"), this);
+    for (auto *button : {previousButton, todayButton, nextButton})
+    {
+        button->setCursor(Qt::PointingHandCursor);
+        Theme::setRole(button, "chip");
+    }
+
+    mRangeLabel = new QLabel(this);
+    Theme::setRole(mRangeLabel, "secondary");
+
+    navigationLayout->addWidget(previousButton);
+    navigationLayout->addWidget(todayButton);
+    navigationLayout->addWidget(nextButton);
+    navigationLayout->addSpacing(8);
+    navigationLayout->addWidget(mRangeLabel);
+    navigationLayout->addStretch(1);
 
-    auto *gridWidget = new QWidget(this);
-    mGridLayout = new QGridLayout(gridWidget);
-    mGridLayout->setSpacing(16);
-    mGridLayout->setContentsMargins(0, 0, 0, 0);
+    mainLayout->addLayout(navigationLayout);
 
-    mainLayout->addWidget(gridWidget);
+    mSubjectSummary = new QLabel(this);
+    mSubjectSummary->setWordWrap(true);
+    Theme::setRole(mSubjectSummary, "muted");
+    mainLayout->addWidget(mSubjectSummary);
+
+    auto *lookupLayout = new QHBoxLayout();
+    lookupLayout->setSpacing(12);
+
+    mFacetEdit = new QLineEdit(this);
+    mFacetEdit->setPlaceholderText(tr("Find a subject, room or teacher"));
+    mFacetEdit->setClearButtonEnabled(true);
+    mFacetEdit->setMaximumWidth(280);
+    mFacetCompleter = new QCompleter(new QStringListModel(this), this);
+    mFacetCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+    mFacetCompleter->setFilterMode(Qt::MatchContains);
+    mFacetEdit->setCompleter(mFacetCompleter);
+
+    mFacetResult = new QLabel(this);
+    mFacetResult->setWordWrap(true);
+    Theme::setRole(mFacetResult, "secondary");
+
+    lookupLayout->addWidget(mFacetEdit);
+    lookupLayout->addWidget(mFacetResult, 1);
+    mainLayout->addLayout(lookupLayout);
+
+    mGrid = new TimetableGridWidget(this);
+    mainLayout->addWidget(mGrid, 1);
 
     connect(mWeekGroup, &QButtonGroup::idToggled, this, [this](int id, bool checked) {
-        if (!checked)
+        const int count = mSchedule.weekCount();
+        if (!checked || count == 0)
         {
             return;
         }
-        mSettings.currentWeek = id == 0 ? QStringLiteral("A") : QStringLiteral("B");
-        rebuildTimetable();
-        if (mJsonManager)
+        // The button names the rotation week of the week on screen; the setting
+        // stores the rotation week of this week, mWeekOffset weeks earlier.
+        const int base = ((id - mWeekOffset) % count + count) % count;
+        const QString week = mSchedule.weekNames().value(base);
+        if (week.isEmpty() || week.compare(mSettings.currentWeek, Qt::CaseInsensitive) == 0)
         {
-            mJsonManager->saveSettings(mSettings);
+            return;
         }
+        mSettings.currentWeek = week;
+        rebuildTimetable();
+        mSaveTimer->start();
+    });
+    connect(mFacetEdit, &QLineEdit::textChanged, this, &TimetablePage::updateFacetLookup);
+    connect(previousButton, &QPushButton::clicked, this, [this]() {
+        showWeek(mWeekOffset - 1);
+    });
+    connect(todayButton, &QPushButton::clicked, this, [this]() {
+        showWeek(0);
+    });
+    connect(nextButton, &QPushButton::clicked, this, [this]() {
+        showWeek(mWeekOffset + 1);
     });
 }
 
+void TimetablePage::rebuildWeekButtons()
+{
+    const auto buttons = mWeekGroup->buttons();
+    for (auto *button : buttons)
+    {
+        mWeekGroup->removeButton(button);
+        button->deleteLater();
+    }
+
+    const auto &weeks = mSchedule.weekNames();
+    for (int i = 0; i < weeks.size(); ++i)
+    {
+        auto *button = new QPushButton(tr("%1 Week").arg(weeks.at(i)), this);
+        button->setCheckable(true);
+        button->setCursor(Qt::PointingHandCursor);
+        Theme::setRole(button, "chip");
+        mWeekGroup->addButton(button, i);
+        mWeekButtonLayout->addWidget(button);
+    }
+}
+
+void TimetablePage::rebuildVariants()
+{
+    // Prefetches still queued or running were built from the previous schedule.
+    mPrefetchToken.cancel();
+    mPrefetchToken = CancellationToken();
+    mVariants.clear();
+    mPendingPrefetch.clear();
+    if (mGrid)
+    {
+        mGrid->clearCache();
+    }
+
+    const QDate monday = mondayForOffset(0);
+    const int yearCount = mSchedule.yearLevels().size();
+    mVariants.reserve(mSchedule.weekCount() * yearCount);
+    for (int week = 0; week < mSchedule.weekCount(); ++week)
+    {
+        for (int year = 0; year < yearCount; ++year)
+        {
+            QVector<TimetableGridColumn> columns;
+            columns.reserve(mSchedule.days().size());
+            for (const int dayOfWeek : mSchedule.days())
+            {
+                columns.append({ScheduleIndex::dayName(dayOfWeek), mSchedule.periodsOn(monday.addDays(dayOfWeek - 1), week, year)});
+            }
+            mVariants.append(columns);
+        }
+    }
+}
+
 void TimetablePage::rebuildTimetable()
 {
-    if (!mGridLayout)
+    if (!mGrid)
     {
         return;
     }
 
-    const QString weekKey = mSettings.currentWeek.isEmpty() ? QStringLiteral("A") : mSettings.currentWeek;
+    const QString weekKey = mSettings.currentWeek.isEmpty() ? QStringLiteral("A") : mSettings.currentWeek.toUpper();
 
     mWeekLabel->setText(tr("Current Week: %1").arg(weekKey));
 
-    if (mWeekGroup)
+    showWeek(mWeekOffset);
+    rebuildSubjectSummary();
+}
+
+void TimetablePage::rebuildSubjectSummary()
+{
+    const int year = mSchedule.yearIndex(mSettings.yearLevel);
+    const QDateTime now = QDateTime::currentDateTime();
+    QStringList entries;
+    for (int subject = 0; subject < mSchedule.subjectCount(); ++subject)
     {
-        const int id = weekKey.compare(QStringLiteral("B"), Qt::CaseInsensitive) == 0 ? 1 : 0;
-        if (auto *button = mWeekGroup->button(id))
+        const int minutes = mSchedule.cycleMinutes(subject, year);
+        if (minutes <= 0)
         {
-            button->setChecked(true);
+            continue;
         }
+        QString entry = tr("%1 %2 h").arg(mSchedule.subject(subject).name).arg(minutes / 60.0, 0, 'f', 1);
+        const TimetablePeriod next = mSchedule.nextOccurrence(ScheduleIndex::Facet::Subject, subject, now, mSettings);
+        if (next.startTime.isValid())
+        {
+            entry += tr(" · next %1").arg(next.startTime.toString(QStringLiteral("ddd HH:mm")));
+        }
+        entries.append(entry);
     }
 
-    while (mGridLayout->count() > 0)
+    mSubjectSummary->setText(entries.isEmpty() ? QString() : tr("Per rotation: %1").arg(entries.join(QStringLiteral("   "))));
+    mSubjectSummary->setVisible(!entries.isEmpty());
+}
+
+void TimetablePage::rebuildFacetCompleter()
+{
+    QStringList names;
+    for (const auto facet : {ScheduleIndex::Facet::Subject, ScheduleIndex::Facet::Room, ScheduleIndex::Facet::Teacher})
     {
-        QLayoutItem *item = mGridLayout->takeAt(0);
-        if (item->widget())
+        for (int id = 0; id < mSchedule.facetCount(facet); ++id)
         {
-            item->widget()->deleteLater();
+            names.append(mSchedule.facetName(facet, id));
         }
-        delete item;
     }
+    names.removeAll(QString());
+    names.removeDuplicates();
+    names.sort(Qt::CaseInsensitive);
+    static_cast<QStringListModel *>(mFacetCompleter->model())->setStringList(names);
+    updateFacetLookup();
+}
 
-    int column = 0;
-    for (const auto &day : kDays)
+void TimetablePage::updateFacetLookup()
+{
+    const QString query = mFacetEdit->text();
+    auto facet = ScheduleIndex::Facet::Subject;
+    int id = -1;
+    for (const auto candidate : {ScheduleIndex::Facet::Subject, ScheduleIndex::Facet::Room, ScheduleIndex::Facet::Teacher})
+    {
+        id = mSchedule.facetIndex(candidate, query);
+        if (id >= 0)
+        {
+            facet = candidate;
+            break;
+        }
+    }
+    if (id < 0)
     {
-        auto *dayLabel = new QLabel(day, this);
-        dayLabel->setStyleSheet(QStringLiteral("font-weight: bold; font-size: 16px;"));
-        mGridLayout->addWidget(dayLabel, 0, column);
+        mFacetResult->setText(query.trimmed().isEmpty() ? QString() : tr("No subject, room or teacher with that name"));
+        return;
+    }
 
-        const auto periods = buildDay(weekKey, day);
-        int row = 1;
-        if (periods.isEmpty())
+    // The shown week, day by day, followed by the next occurrence from now.
+    const int year = mSchedule.yearIndex(mSettings.yearLevel);
+    const int week = weekForOffset(mWeekOffset);
+    QStringList days;
+    for (const int dayOfWeek : mSchedule.days())
+    {
+        QStringList times;
+        for (const int index : mSchedule.occurrencesOn(facet, id, week, dayOfWeek, year))
         {
-            auto *card = new TimetableCard(this);
-            card->setEmptyLabel(tr("No Periods"));
-            mGridLayout->addWidget(card, row, column);
+            const ScheduledPeriod &period = mSchedule.period(index);
+            const QString time = QTime(0, 0).addSecs(period.startMinute * 60).toString(QStringLiteral("HH:mm"));
+            // Subjects name themselves; rooms and teachers say which class it is.
+            times.append(facet == ScheduleIndex::Facet::Subject || period.subject < 0
+                             ? time
+                             : tr("%1 %2").arg(time, mSchedule.subject(period.subject).name));
         }
-        else
+        if (!times.isEmpty())
         {
-            for (const auto &period : periods)
-            {
-                auto *card = new TimetableCard(this);
-                card->setPeriod(period);
-                mGridLayout->addWidget(card, row, column);
-                ++row;
-            }
+            days.append(tr("%1 %2").arg(ScheduleIndex::dayName(dayOfWeek).left(3), times.join(QStringLiteral(", "))));
         }
-        ++column;
     }
+
+    QString text = days.isEmpty() ? tr("Not this week") : days.join(QStringLiteral(" · "));
+    const TimetablePeriod next = mSchedule.nextOccurrence(facet, id, QDateTime::currentDateTime(), mSettings);
+    if (next.startTime.isValid())
+    {
+        text += tr("   Next: %1").arg(next.startTime.toString(QStringLiteral("ddd d MMM HH:mm")));
+    }
+    mFacetResult->setText(text);
 }
 
-QVector<TimetablePeriod> TimetablePage::buildDay(const QString &weekKey, const QString &dayName) const
+void TimetablePage::showWeek(int offset)
 {
-    QVector<TimetablePeriod> result;
-    if (!mData.weeks.contains(weekKey))
+    if (!mGrid)
     {
-        return result;
+        return;
     }
 
-    const WeekSchedule &week = mData.weeks.value(weekKey);
-    if (!week.days.contains(dayName))
+    mWeekOffset = offset;
+    const QDate monday = mondayForOffset(offset);
+    const int week = weekForOffset(offset);
+    const QString key = modelKey(offset);
+
+    if (auto *button = mWeekGroup->button(week))
     {
-        return result;
+        const QSignalBlocker blocker(mWeekGroup);
+        button->setChecked(true);
     }
 
-    const DaySchedule &day = week.days.value(dayName);
-    QString templateName = day.templateName;
-    if (templateName.contains(QStringLiteral("wednesday"), Qt::CaseInsensitive))
+    if (!mGrid->showCachedModel(key))
     {
-        templateName = mSettings.yearLevel >= 11 ? QStringLiteral("wednesday_year11") : QStringLiteral("wednesday_year10");
+        mGrid->setColumns(datedColumns(variant(week, mSchedule.yearIndex(mSettings.yearLevel)), mSchedule.days(), monday), key);
     }
 
-    if (!mData.templates.contains(templateName))
+    const int lastDay = mSchedule.days().isEmpty() ? 5 : *std::max_element(mSchedule.days().cbegin(), mSchedule.days().cend());
+    mRangeLabel->setText(tr("%1 - %2 (%3 Week)")
+                             .arg(monday.toString(QStringLiteral("d MMM")),
+                                  monday.addDays(lastDay - 1).toString(QStringLiteral("d MMM yyyy")),
+                                  mSchedule.weekNames().value(week)));
+
+    updateFacetLookup();
+    prefetchWeek(offset - 1);
+    prefetchWeek(offset + 1);
+}
+
+void TimetablePage::prefetchWeek(int offset)
+{
+    const QString key = modelKey(offset);
+    if (!mScheduler || mGrid->hasCachedModel(key) || mPendingPrefetch.contains(key))
     {
-        return result;
+        return;
     }
+    mPendingPrefetch.insert(key);
+
+    const auto source = variant(weekForOffset(offset), mSchedule.yearIndex(mSettings.yearLevel));
+    const auto days = mSchedule.days();
+    const QDate monday = mondayForOffset(offset);
+    const TimetableGridWidget::Style style = mGrid->gridStyle();
+
+    // Dating the columns, building the cells and shaping their QStaticText all run
+    // on the worker; the GUI thread only parks the finished model in the cache.
+    mScheduler->run<TimetableGridWidget::Model>(
+        TaskScheduler::Background, mPrefetchToken,
+        [source, days, monday, style](const CancellationToken &) {
+            return TimetableGridWidget::buildModel(datedColumns(source, days, monday), style);
+        },
+        this, [this, key](TimetableGridWidget::Model model) {
+            mPendingPrefetch.remove(key);
+            mGrid->cacheModel(key, std::move(model));
+        });
+}
+
+int TimetablePage::weekForOffset(int offset) const
+{
+    return mSchedule.rotationWeekFor(mondayForOffset(offset), mSettings.currentWeek);
+}
+
+QDate TimetablePage::mondayForOffset(int offset) const
+{
+    const QDate today = QDate::currentDate();
+    return today.addDays(1 - today.dayOfWeek() + 7 * offset);
+}
 
-    const TimetableTemplate &templ = mData.templates.value(templateName);
-    QMap<QString, TimetableSubjectSlot> slotLookup;
-    for (const auto &slot : day.slots)
+QString TimetablePage::modelKey(int offset) const
+{
+    return QStringLiteral("%1/%2/%3")
+        .arg(mondayForOffset(offset).toJulianDay())
+        .arg(weekForOffset(offset))
+        .arg(mSchedule.yearIndex(mSettings.yearLevel));
+}
+
+QVector<TimetableGridColumn> TimetablePage::variant(int week, int yearIndex) const
+{
+    const int index = week * mSchedule.yearLevels().size() + yearIndex;
+    if (week >= 0 && index >= 0 && index < mVariants.size())
     {
-        slotLookup.insert(slot.periodKey, slot);
+        return mVariants.at(index);
     }
 
-    const QDate referenceDate = QDate::currentDate();
-    for (const auto &periodTime : templ.periods)
+    QVector<TimetableGridColumn> empty;
+    for (const int dayOfWeek : mSchedule.days())
     {
-        TimetablePeriod period;
-        period.periodKey = periodTime.label;
-        period.startTime = QDateTime(referenceDate, periodTime.start);
-        period.endTime = QDateTime(referenceDate, periodTime.end);
+        empty.append({ScheduleIndex::dayName(dayOfWeek), {}});
+    }
+    return empty;
+}
 
-        if (slotLookup.contains(periodTime.label))
-        {
-            const auto slot = slotLookup.value(periodTime.label);
-            period.subjectName = slot.subjectName;
-            period.room = slot.room;
-            if (mData.subjects.contains(slot.subjectName))
-            {
-                const auto subject = mData.subjects.value(slot.subjectName);
-                period.teacher = subject.teacher;
-                period.color = subject.color;
-            }
-        }
-        else
+QVector<TimetableGridColumn> TimetablePage::datedColumns(const QVector<TimetableGridColumn> &variant, const QVector<int> &days, const QDate &monday)
+{
+    QVector<TimetableGridColumn> columns = variant;
+    for (int i = 0; i < columns.size() && i < days.size(); ++i)
+    {
+        const QDate date = monday.addDays(days.at(i) - 1);
+        auto &column = columns[i];
+        column.title = QStringLiteral("%1 %2").arg(ScheduleIndex::dayName(days.at(i)), date.toString(QStringLiteral("d/M")));
+        for (auto &period : column.periods)
         {
-            period.isSpecial = true;
-            period.subjectName = periodTime.label;
-            period.room = {};
-            period.teacher = {};
-            period.color = QColor("#EFEFEF");
+            period.startTime.setDate(date);
+            period.endTime.setDate(date);
         }
-
-        result.append(period);
     }
-
-    return result;
+    return columns;
 }
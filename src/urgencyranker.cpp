@@ -0,0 +1,222 @@
+#include "urgencyranker.h"
+
+#include "metrics.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <queue>
+
+namespace
+{
+// A task with all of its weighted work remaining is treated as due this much
+// earlier than its deadline.
+constexpr qint64 kFullWorkSecs = 3 * 24 * 3600;
+}
+
+void UrgencyRanker::sync(const AppSnapshot &snapshot)
+{
+    if (mVersion != 0 && snapshot.version <= mVersion)
+    {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    diffEntities(mTasks, snapshot.tasks, [this](const Task &task) {
+        update(task);
+    }, [this](const QString &taskId) {
+        remove(taskId);
+    });
+    mTasks = snapshot.tasks;
+    mVersion = snapshot.version;
+
+    Metrics::instance().recordDuration(QStringLiteral("urgency.sync"), timer.nsecsElapsed() / 1000);
+    Metrics::instance().setGauge(QStringLiteral("urgency.ranked"), size());
+}
+
+QVector<UrgencyRanker::Entry> UrgencyRanker::top(int count) const
+{
+    QVector<Entry> result;
+    if (mHeap.empty() || count <= 0)
+    {
+        return result;
+    }
+    result.reserve(count);
+
+    // Best-first walk: a node can only be among the top once its parent is.
+    const auto later = [this](int a, int b) {
+        return less(mHeap[b], mHeap[a]);
+    };
+    std::priority_queue<int, std::vector<int>, decltype(later)> frontier(later);
+    frontier.push(0);
+    const int heapSize = static_cast<int>(mHeap.size());
+    while (!frontier.empty() && result.size() < count)
+    {
+        const int position = frontier.top();
+        frontier.pop();
+        result.append(mEntries[mHeap[position]]);
+        for (const int child : {2 * position + 1, 2 * position + 2})
+        {
+            if (child < heapSize)
+            {
+                frontier.push(child);
+            }
+        }
+    }
+    return result;
+}
+
+int UrgencyRanker::size() const
+{
+    return static_cast<int>(mHeap.size());
+}
+
+void UrgencyRanker::update(const Task &task)
+{
+    double totalWeight = 0.0;
+    double doneWeight = 0.0;
+    qint64 deadline = kNoDeadline;
+    bool open = task.subtasks().isEmpty();
+    for (const Subtask &subtask : task.subtasks())
+    {
+        const double weight = std::max(0.0, subtask.weighting());
+        totalWeight += weight;
+        if (subtask.isCompleted())
+        {
+            doneWeight += weight;
+            continue;
+        }
+        open = true;
+        if (subtask.dueTime().isValid())
+        {
+            deadline = std::min(deadline, subtask.dueTime().toSecsSinceEpoch());
+        }
+    }
+
+    if (!open)
+    {
+        remove(task.id());
+        return;
+    }
+    if (task.endTime().isValid())
+    {
+        deadline = std::min(deadline, task.endTime().toSecsSinceEpoch());
+    }
+
+    Entry entry;
+    entry.taskId = task.id();
+    entry.title = task.title();
+    entry.deadlineSecs = deadline;
+    entry.progress = totalWeight > 0.0 ? doneWeight / totalWeight * 100.0 : 0.0;
+    const double remaining = 1.0 - entry.progress / 100.0;
+    entry.key = deadline == kNoDeadline ? kNoDeadline : deadline - static_cast<qint64>(remaining * kFullWorkSecs);
+
+    const auto existing = mSlots.constFind(task.id());
+    if (existing != mSlots.constEnd())
+    {
+        const int slot = *existing;
+        mEntries[slot] = entry;
+        siftUp(mPositions[slot]);
+        siftDown(mPositions[slot]);
+        return;
+    }
+
+    int slot;
+    if (!mFreeSlots.isEmpty())
+    {
+        slot = mFreeSlots.takeLast();
+        mEntries[slot] = entry;
+    }
+    else
+    {
+        slot = static_cast<int>(mEntries.size());
+        mEntries.push_back(entry);
+        mPositions.push_back(-1);
+    }
+    mSlots.insert(task.id(), slot);
+    mPositions[slot] = static_cast<int>(mHeap.size());
+    mHeap.push_back(slot);
+    siftUp(mPositions[slot]);
+}
+
+void UrgencyRanker::remove(const QString &taskId)
+{
+    const auto it = mSlots.constFind(taskId);
+    if (it == mSlots.constEnd())
+    {
+        return;
+    }
+    const int slot = *it;
+    mSlots.erase(it);
+
+    const int position = mPositions[slot];
+    const int last = static_cast<int>(mHeap.size()) - 1;
+    swapNodes(position, last);
+    mHeap.pop_back();
+    mPositions[slot] = -1;
+    mEntries[slot] = Entry();
+    mFreeSlots.append(slot);
+
+    if (position < last)
+    {
+        siftUp(position);
+        siftDown(position);
+    }
+}
+
+void UrgencyRanker::siftUp(int position)
+{
+    while (position > 0)
+    {
+        const int parent = (position - 1) / 2;
+        if (!less(mHeap[position], mHeap[parent]))
+        {
+            break;
+        }
+        swapNodes(position, parent);
+        position = parent;
+    }
+}
+
+void UrgencyRanker::siftDown(int position)
+{
+    const int heapSize = static_cast<int>(mHeap.size());
+    while (true)
+    {
+        int smallest = position;
+        for (const int child : {2 * position + 1, 2 * position + 2})
+        {
+            if (child < heapSize && less(mHeap[child], mHeap[smallest]))
+            {
+                smallest = child;
+            }
+        }
+        if (smallest == position)
+        {
+            return;
+        }
+        swapNodes(position, smallest);
+        position = smallest;
+    }
+}
+
+void UrgencyRanker::swapNodes(int a, int b)
+{
+    std::swap(mHeap[a], mHeap[b]);
+    mPositions[mHeap[a]] = a;
+    mPositions[mHeap[b]] = b;
+}
+
+bool UrgencyRanker::less(int a, int b) const
+{
+    // Equal keys put the task with less progress first.
+    const Entry &left = mEntries[a];
+    const Entry &right = mEntries[b];
+    if (left.key != right.key)
+    {
+        return left.key < right.key;
+    }
+    return left.progress < right.progress;
+}
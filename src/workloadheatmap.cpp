@@ -0,0 +1,183 @@
+#include "workloadheatmap.h"
+
+#include <QFontMetricsF>
+#include <QHelpEvent>
+#include <QLocale>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QStringList>
+#include <QToolTip>
+
+#include <algorithm>
+
+namespace
+{
+constexpr qreal kHeaderHeight = 18.0;
+constexpr qreal kDayLabelWidth = 32.0;
+constexpr qreal kGap = 2.0;
+constexpr qreal kMaxCellSize = 14.0;
+constexpr qreal kMinCellSize = 6.0;
+constexpr qreal kRadius = 2.0;
+
+const QColor kEmptyColor(0xEE, 0xEE, 0xEE);
+const QColor kLoadColor(0xE6, 0x51, 0x00);
+const QColor kTodayColor(0x1E, 0x88, 0xE5);
+const QColor kLabelColor(0x66, 0x66, 0x66);
+}
+
+WorkloadHeatmap::WorkloadHeatmap(QWidget *parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setCursor(Qt::PointingHandCursor);
+
+    mLabelFont = font();
+    mLabelFont.setPixelSize(11);
+
+    setCenter(QDate::currentDate());
+}
+
+void WorkloadHeatmap::setIndex(const WorkloadIndex *index)
+{
+    mIndex = index;
+    update();
+}
+
+void WorkloadHeatmap::setCenter(const QDate &day)
+{
+    const QDate monday = day.addDays(1 - day.dayOfWeek());
+    mFirstMonday = monday.addDays(-7 * (kWeeks / 2));
+    update();
+}
+
+QSize WorkloadHeatmap::sizeHint() const
+{
+    return QSize(static_cast<int>(kDayLabelWidth + kWeeks * (kMaxCellSize + kGap)),
+                 static_cast<int>(kHeaderHeight + 7 * (kMaxCellSize + kGap)));
+}
+
+bool WorkloadHeatmap::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        auto *helpEvent = static_cast<QHelpEvent *>(event);
+        const QDate day = dayAt(helpEvent->pos());
+        if (!day.isValid() || !mIndex)
+        {
+            QToolTip::hideText();
+            event->ignore();
+            return true;
+        }
+
+        const QDate monday = day.addDays(1 - day.dayOfWeek());
+        QStringList lines;
+        lines << day.toString(QStringLiteral("dddd d MMMM yyyy"));
+        lines << tr("Weighting due: %1").arg(mIndex->dueWeighting(day), 0, 'f', 1);
+        lines << tr("Activities: %1 h").arg(mIndex->activityMinutes(day) / 60.0, 0, 'f', 1);
+        lines << tr("Week: %1 due, %2 h").arg(mIndex->dueWeighting(monday, monday.addDays(6)), 0, 'f', 1)
+                                          .arg(mIndex->activityMinutes(monday, monday.addDays(6)) / 60.0, 0, 'f', 1);
+        QToolTip::showText(helpEvent->globalPos(), lines.join('\n'), this);
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void WorkloadHeatmap::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(mLabelFont);
+    const QFontMetricsF metrics(mLabelFont);
+
+    // Shades are relative to the busiest day in view.
+    double maxDue = 0.0;
+    int maxMinutes = 0;
+    const int dayCount = kWeeks * 7;
+    if (mIndex)
+    {
+        for (int i = 0; i < dayCount; ++i)
+        {
+            const QDate day = mFirstMonday.addDays(i);
+            maxDue = std::max(maxDue, mIndex->dueWeighting(day));
+            maxMinutes = std::max(maxMinutes, mIndex->activityMinutes(day));
+        }
+    }
+
+    painter.setPen(kLabelColor);
+    for (const int dayOfWeek : {1, 3, 5})
+    {
+        const QRectF rect = cellRect(0, dayOfWeek);
+        painter.drawText(QPointF(0.0, rect.center().y() + metrics.ascent() / 2.0 - 1.0), QLocale().dayName(dayOfWeek, QLocale::ShortFormat));
+    }
+
+    const QDate today = QDate::currentDate();
+    for (int week = 0; week < kWeeks; ++week)
+    {
+        const QDate monday = mFirstMonday.addDays(7 * week);
+        if (monday.day() <= 7)
+        {
+            painter.setPen(kLabelColor);
+            painter.drawText(QPointF(cellRect(week, 1).left(), metrics.ascent()), monday.toString(QStringLiteral("MMM")));
+        }
+
+        for (int dayOfWeek = 1; dayOfWeek <= 7; ++dayOfWeek)
+        {
+            const QDate day = monday.addDays(dayOfWeek - 1);
+            const QRectF rect = cellRect(week, dayOfWeek);
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(kEmptyColor);
+            painter.drawRoundedRect(rect, kRadius, kRadius);
+
+            const double due = mIndex && maxDue > 0.0 ? mIndex->dueWeighting(day) / maxDue : 0.0;
+            const double busy = mIndex && maxMinutes > 0 ? double(mIndex->activityMinutes(day)) / maxMinutes : 0.0;
+            const double load = (due + busy) / 2.0;
+            if (load > 0.0)
+            {
+                QColor shade = kLoadColor;
+                shade.setAlphaF(0.15 + 0.85 * load);
+                painter.setBrush(shade);
+                painter.drawRoundedRect(rect, kRadius, kRadius);
+            }
+            if (day == today)
+            {
+                painter.setPen(QPen(kTodayColor, 1.5));
+                painter.setBrush(Qt::NoBrush);
+                painter.drawRoundedRect(rect, kRadius, kRadius);
+            }
+        }
+    }
+}
+
+void WorkloadHeatmap::mousePressEvent(QMouseEvent *event)
+{
+    const QDate day = dayAt(event->position());
+    if (event->button() == Qt::LeftButton && day.isValid())
+    {
+        emit dayActivated(day);
+    }
+    QWidget::mousePressEvent(event);
+}
+
+QDate WorkloadHeatmap::dayAt(const QPointF &pos) const
+{
+    const qreal pitch = cellSize() + kGap;
+    const int week = static_cast<int>((pos.x() - kDayLabelWidth) / pitch);
+    const int row = static_cast<int>((pos.y() - kHeaderHeight) / pitch);
+    if (pos.x() < kDayLabelWidth || pos.y() < kHeaderHeight || week >= kWeeks || row >= 7)
+    {
+        return {};
+    }
+    return cellRect(week, row + 1).contains(pos) ? mFirstMonday.addDays(7 * week + row) : QDate();
+}
+
+QRectF WorkloadHeatmap::cellRect(int week, int dayOfWeek) const
+{
+    const qreal size = cellSize();
+    return QRectF(kDayLabelWidth + week * (size + kGap), kHeaderHeight + (dayOfWeek - 1) * (size + kGap), size, size);
+}
+
+qreal WorkloadHeatmap::cellSize() const
+{
+    return std::clamp((width() - kDayLabelWidth) / kWeeks - kGap, kMinCellSize, kMaxCellSize);
+}
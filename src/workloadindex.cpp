@@ -0,0 +1,205 @@
+#include "workloadindex.h"
+
+#include "metrics.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+namespace
+{
+// Day arrays grow by at least this much on either side, so extending the range
+// one day at a time stays amortised O(1).
+constexpr int kGrowDays = 64;
+// Caps the days a single runaway activity can spread over.
+constexpr int kMaxActivityDays = 366;
+constexpr int kMinutesPerDay = 24 * 60;
+}
+
+void WorkloadIndex::sync(const AppSnapshot &snapshot)
+{
+    if (mVersion != 0 && snapshot.version <= mVersion)
+    {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    diffEntities(mTasks, snapshot.tasks, [this](const Task &task) {
+        apply(mTaskContributions.take(task.id()), mDue, -1.0);
+        const QVector<Contribution> contributions = contributionsOf(task);
+        apply(contributions, mDue, 1.0);
+        mTaskContributions.insert(task.id(), contributions);
+    }, [this](const QString &taskId) {
+        apply(mTaskContributions.take(taskId), mDue, -1.0);
+    });
+    mTasks = snapshot.tasks;
+
+    diffEntities(mActivities, snapshot.activities, [this](const Activity &activity) {
+        apply(mActivityContributions.take(activity.id()), mMinutes, -1.0);
+        const QVector<Contribution> contributions = contributionsOf(activity);
+        apply(contributions, mMinutes, 1.0);
+        mActivityContributions.insert(activity.id(), contributions);
+    }, [this](const QString &activityId) {
+        apply(mActivityContributions.take(activityId), mMinutes, -1.0);
+    });
+    mActivities = snapshot.activities;
+
+    mVersion = snapshot.version;
+    Metrics::instance().recordDuration(QStringLiteral("workload.sync"), timer.nsecsElapsed() / 1000);
+}
+
+QDate WorkloadIndex::firstDay() const
+{
+    return mDue.isEmpty() ? QDate() : QDate::fromJulianDay(mFirstJulian);
+}
+
+QDate WorkloadIndex::lastDay() const
+{
+    return mDue.isEmpty() ? QDate() : QDate::fromJulianDay(mFirstJulian + mDue.size() - 1);
+}
+
+double WorkloadIndex::dueWeighting(const QDate &day) const
+{
+    const int index = dayIndex(day);
+    // Subtracting contributions can leave rounding residue behind.
+    return index >= 0 && mDue.at(index) > 1e-9 ? mDue.at(index) : 0.0;
+}
+
+int WorkloadIndex::activityMinutes(const QDate &day) const
+{
+    const int index = dayIndex(day);
+    return index >= 0 ? qRound(mMinutes.at(index)) : 0;
+}
+
+double WorkloadIndex::dueWeighting(const QDate &from, const QDate &to) const
+{
+    if (mDue.isEmpty() || !from.isValid() || !to.isValid())
+    {
+        return 0.0;
+    }
+    ensurePrefix();
+    const int first = std::clamp<qint64>(from.toJulianDay() - mFirstJulian, 0, mDue.size());
+    const int last = std::clamp<qint64>(to.toJulianDay() - mFirstJulian + 1, first, mDue.size());
+    const double total = mDuePrefix.at(last) - mDuePrefix.at(first);
+    return total > 1e-9 ? total : 0.0;
+}
+
+int WorkloadIndex::activityMinutes(const QDate &from, const QDate &to) const
+{
+    if (mMinutes.isEmpty() || !from.isValid() || !to.isValid())
+    {
+        return 0;
+    }
+    ensurePrefix();
+    const int first = std::clamp<qint64>(from.toJulianDay() - mFirstJulian, 0, mMinutes.size());
+    const int last = std::clamp<qint64>(to.toJulianDay() - mFirstJulian + 1, first, mMinutes.size());
+    return qRound(mMinutesPrefix.at(last) - mMinutesPrefix.at(first));
+}
+
+QVector<WorkloadIndex::Contribution> WorkloadIndex::contributionsOf(const Task &task)
+{
+    QVector<Contribution> contributions;
+    for (const Subtask &subtask : task.subtasks())
+    {
+        if (!subtask.isCompleted() && subtask.dueTime().isValid() && subtask.weighting() > 0.0)
+        {
+            contributions.append({subtask.dueTime().date().toJulianDay(), subtask.weighting()});
+        }
+    }
+    return contributions;
+}
+
+QVector<WorkloadIndex::Contribution> WorkloadIndex::contributionsOf(const Activity &activity)
+{
+    QVector<Contribution> contributions;
+    const QDateTime &start = activity.startTime();
+    const QDateTime &end = activity.endTime();
+    if (!start.isValid() || !end.isValid() || end <= start)
+    {
+        return contributions;
+    }
+
+    // Split at midnight so every day gets only the minutes that fall on it.
+    int days = 0;
+    for (QDate date = start.date(); date <= end.date() && days < kMaxActivityDays; date = date.addDays(1), ++days)
+    {
+        const int from = date == start.date() ? start.time().msecsSinceStartOfDay() / 60000 : 0;
+        const int to = date == end.date() ? end.time().msecsSinceStartOfDay() / 60000 : kMinutesPerDay;
+        if (to > from)
+        {
+            contributions.append({date.toJulianDay(), double(to - from)});
+        }
+    }
+    return contributions;
+}
+
+void WorkloadIndex::apply(const QVector<Contribution> &contributions, QVector<double> &days, double sign)
+{
+    for (const Contribution &contribution : contributions)
+    {
+        ensureDays(contribution.julianDay, contribution.julianDay);
+        days[contribution.julianDay - mFirstJulian] += sign * contribution.amount;
+    }
+    if (!contributions.isEmpty())
+    {
+        mPrefixDirty = true;
+    }
+}
+
+void WorkloadIndex::ensureDays(qint64 firstJulian, qint64 lastJulian)
+{
+    if (mDue.isEmpty())
+    {
+        mFirstJulian = firstJulian - kGrowDays;
+        const int count = static_cast<int>(lastJulian - firstJulian) + 1 + 2 * kGrowDays;
+        mDue = QVector<double>(count, 0.0);
+        mMinutes = QVector<double>(count, 0.0);
+        return;
+    }
+
+    if (firstJulian < mFirstJulian)
+    {
+        const int grow = static_cast<int>(mFirstJulian - firstJulian) + kGrowDays;
+        mDue.insert(0, grow, 0.0);
+        mMinutes.insert(0, grow, 0.0);
+        mFirstJulian -= grow;
+    }
+    const qint64 end = mFirstJulian + mDue.size();
+    if (lastJulian >= end)
+    {
+        const int grow = static_cast<int>(lastJulian - end) + 1 + kGrowDays;
+        mDue.resize(mDue.size() + grow);
+        mMinutes.resize(mMinutes.size() + grow);
+    }
+}
+
+void WorkloadIndex::ensurePrefix() const
+{
+    if (!mPrefixDirty && mDuePrefix.size() == mDue.size() + 1)
+    {
+        return;
+    }
+    mDuePrefix.resize(mDue.size() + 1);
+    mMinutesPrefix.resize(mMinutes.size() + 1);
+    mDuePrefix[0] = 0.0;
+    mMinutesPrefix[0] = 0.0;
+    for (int i = 0; i < mDue.size(); ++i)
+    {
+        mDuePrefix[i + 1] = mDuePrefix.at(i) + mDue.at(i);
+        mMinutesPrefix[i + 1] = mMinutesPrefix.at(i) + mMinutes.at(i);
+    }
+    mPrefixDirty = false;
+}
+
+int WorkloadIndex::dayIndex(const QDate &day) const
+{
+    if (!day.isValid())
+    {
+        return -1;
+    }
+    const qint64 index = day.toJulianDay() - mFirstJulian;
+    return index >= 0 && index < mDue.size() ? static_cast<int>(index) : -1;
+}